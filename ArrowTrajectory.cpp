@@ -0,0 +1,715 @@
+#include "ArrowTrajectory.h"
+#include "Simulation.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace {
+
+const char MAGIC[6] = {'A', 'R', 'R', 'O', 'W', '1'};
+const std::uint32_t CONTINUATION = 0xFFFFFFFFu;
+const std::size_t ALIGN = 8;
+
+// Values from Arrow's Schema.fbs and Message.fbs
+const std::int16_t METADATA_V5 = 4;
+const std::uint8_t TYPE_INT = 2;
+const std::uint8_t TYPE_FLOATING_POINT = 3;
+const std::int16_t PRECISION_DOUBLE = 2;
+const std::uint8_t HEADER_SCHEMA = 1;
+const std::uint8_t HEADER_DICTIONARY_BATCH = 2;
+const std::uint8_t HEADER_RECORD_BATCH = 3;
+
+const std::int64_t RUN_DICTIONARY = 0;
+const std::int64_t VEHICLE_DICTIONARY = 1;
+
+/**
+ * @brief One column of the trajectory schema.
+ */
+struct ColumnSpec {
+    const char* name;      /**< Field name. */
+    int bitWidth;          /**< Width of an integer column; 0 for float64. */
+    std::int64_t dictionary; /**< Dictionary ID of an encoded column, or -1. */
+};
+
+const std::size_t COLUMN_COUNT = 8;
+const ColumnSpec COLUMNS[COLUMN_COUNT] = {
+    {"run_id", 32, RUN_DICTIONARY}, {"step", 64, -1}, {"time", 0, -1}, {"vehicle_id", 32, VEHICLE_DICTIONARY},
+    {"x", 0, -1}, {"y", 0, -1}, {"speed", 0, -1}, {"heading", 0, -1}
+};
+
+std::size_t padTo(std::size_t v) {
+    return (v + ALIGN - 1) / ALIGN * ALIGN;
+}
+
+/**
+ * @brief Minimal FlatBuffers builder for Arrow's metadata.
+ *
+ * Builds back to front like the reference builder, so a table's children
+ * are finished before the table that refers to them and every offset points
+ * forward. Bytes are collected in reverse order and flipped by finish().
+ * Positions are distances from the end of the buffer. Tables cannot nest:
+ * each one is started and ended before the next.
+ */
+class FlatBuilder {
+private:
+    std::vector<std::uint8_t> rev;   /**< The buffer, last byte first. */
+    std::size_t maxAlign = 1;        /**< Largest alignment requested so far. */
+    std::uint32_t tableStart = 0;    /**< Position where the open table began. */
+    std::vector<std::pair<int, std::uint32_t>> fields; /**< Field ID and position of each field of the open table. */
+
+    void prepend(const void* data, std::size_t size) {
+        const std::uint8_t* bytes = static_cast<const std::uint8_t*>(data);
+        for (std::size_t k = size; k-- > 0;) rev.push_back(bytes[k]);
+    }
+
+public:
+    std::uint32_t size() const { return static_cast<std::uint32_t>(rev.size()); }
+
+    // Pads so that the next `bytes` bytes prepended end on a multiple of alignment
+    void align(std::size_t bytes, std::size_t alignment) {
+        maxAlign = std::max(maxAlign, alignment);
+        while ((rev.size() + bytes) % alignment != 0) rev.push_back(0);
+    }
+
+    template <typename T>
+    std::uint32_t scalar(T v) {
+        align(sizeof(T), sizeof(T));
+        prepend(&v, sizeof(T));
+        return size();
+    }
+
+    std::uint32_t offset(std::uint32_t target) {
+        align(4, 4);
+        return scalar<std::uint32_t>(size() + 4 - target);
+    }
+
+    std::uint32_t string(const std::string& s) {
+        align(s.size() + 1, 4);
+        rev.push_back(0);
+        prepend(s.data(), s.size());
+        return scalar<std::uint32_t>(static_cast<std::uint32_t>(s.size()));
+    }
+
+    // Vector of structs or scalars given as their bytes in memory order
+    std::uint32_t vector(const void* data, std::size_t count, std::size_t elementSize, std::size_t alignment) {
+        align(count * elementSize, std::max<std::size_t>(alignment, 4));
+        prepend(data, count * elementSize);
+        return scalar<std::uint32_t>(static_cast<std::uint32_t>(count));
+    }
+
+    std::uint32_t offsets(const std::vector<std::uint32_t>& targets) {
+        align(targets.size() * 4, 4);
+        for (std::size_t k = targets.size(); k-- > 0;) offset(targets[k]);
+        return scalar<std::uint32_t>(static_cast<std::uint32_t>(targets.size()));
+    }
+
+    void startTable() {
+        fields.clear();
+        tableStart = size();
+    }
+
+    template <typename T>
+    void add(int id, T v) { fields.emplace_back(id, scalar(v)); }
+
+    void addOffset(int id, std::uint32_t target) { fields.emplace_back(id, offset(target)); }
+
+    std::uint32_t endTable() {
+        const std::uint32_t table = scalar<std::int32_t>(0);
+        int maxId = -1;
+        for (const auto& f : fields) maxId = std::max(maxId, f.first);
+        std::vector<std::uint16_t> slots(static_cast<std::size_t>(maxId + 1), 0);
+        for (const auto& f : fields) slots[static_cast<std::size_t>(f.first)] = static_cast<std::uint16_t>(table - f.second);
+        for (std::size_t k = slots.size(); k-- > 0;) scalar<std::uint16_t>(slots[k]);
+        scalar<std::uint16_t>(static_cast<std::uint16_t>(table - tableStart));
+        const std::uint32_t vtable = scalar<std::uint16_t>(static_cast<std::uint16_t>(4 + 2 * slots.size()));
+        // The vtable sits just before the table; patch the table's offset to it
+        const std::int32_t back = static_cast<std::int32_t>(vtable - table);
+        std::uint8_t bytes[4];
+        std::memcpy(bytes, &back, 4);
+        for (std::size_t k = 0; k < 4; k++) rev[table - 1 - k] = bytes[k];
+        return table;
+    }
+
+    std::vector<std::uint8_t> finish(std::uint32_t root) {
+        align(4, maxAlign);
+        offset(root);
+        return std::vector<std::uint8_t>(rev.rbegin(), rev.rend());
+    }
+};
+
+/**
+ * @brief Adds the trajectory schema to a builder and returns its position.
+ */
+std::uint32_t buildSchema(FlatBuilder& fb) {
+    std::vector<std::uint32_t> fieldList;
+    for (const ColumnSpec& c : COLUMNS) {
+        const std::uint32_t name = fb.string(c.name);
+        const std::uint32_t children = fb.offsets({});
+        fb.startTable();
+        if (c.bitWidth > 0) {
+            fb.add<std::int32_t>(0, c.bitWidth);
+            fb.add<std::uint8_t>(1, 1);
+        } else {
+            fb.add<std::int16_t>(0, PRECISION_DOUBLE);
+        }
+        const std::uint32_t type = fb.endTable();
+        std::uint32_t encoding = 0;
+        if (c.dictionary >= 0) {
+            fb.startTable();
+            fb.add<std::int32_t>(0, 32);
+            fb.add<std::uint8_t>(1, 1);
+            const std::uint32_t indexType = fb.endTable();
+            fb.startTable();
+            fb.add<std::int64_t>(0, c.dictionary);
+            fb.addOffset(1, indexType);
+            fb.add<std::uint8_t>(2, 0);
+            encoding = fb.endTable();
+        }
+        fb.startTable();
+        fb.addOffset(0, name);
+        fb.add<std::uint8_t>(1, 0);
+        fb.add<std::uint8_t>(2, c.bitWidth > 0 ? TYPE_INT : TYPE_FLOATING_POINT);
+        fb.addOffset(3, type);
+        if (encoding) fb.addOffset(4, encoding);
+        fb.addOffset(5, children);
+        fieldList.push_back(fb.endTable());
+    }
+    const std::uint32_t fieldVector = fb.offsets(fieldList);
+    fb.startTable();
+    fb.add<std::int16_t>(0, 0);
+    fb.addOffset(1, fieldVector);
+    return fb.endTable();
+}
+
+/**
+ * @brief Adds a RecordBatch table and returns its position.
+ *
+ * @param rows Number of rows.
+ * @param columns Number of columns; each has a node and a validity and a data buffer.
+ * @param buffers Offset and length of each buffer in the body, in schema order.
+ */
+std::uint32_t buildRecordBatch(FlatBuilder& fb, std::int64_t rows, std::size_t columns,
+                               const std::vector<std::int64_t>& buffers) {
+    std::vector<std::int64_t> nodes;
+    for (std::size_t c = 0; c < columns; c++) {
+        nodes.push_back(rows);
+        nodes.push_back(0);
+    }
+    const std::uint32_t nodeVector = fb.vector(nodes.data(), columns, 16, 8);
+    const std::uint32_t bufferVector = fb.vector(buffers.data(), buffers.size() / 2, 16, 8);
+    fb.startTable();
+    fb.add<std::int64_t>(0, rows);
+    fb.addOffset(1, nodeVector);
+    fb.addOffset(2, bufferVector);
+    return fb.endTable();
+}
+
+/**
+ * @brief Finishes a Message table around a header and returns the metadata bytes.
+ */
+std::vector<std::uint8_t> finishMessage(FlatBuilder& fb, std::uint8_t headerType, std::uint32_t header,
+                                        std::int64_t bodySize) {
+    fb.startTable();
+    fb.add<std::int64_t>(3, bodySize);
+    fb.add<std::int16_t>(0, METADATA_V5);
+    fb.add<std::uint8_t>(1, headerType);
+    fb.addOffset(2, header);
+    return fb.finish(fb.endTable());
+}
+
+/**
+ * @brief Lays out body buffers: each starts on an 8-byte boundary, after an empty validity buffer.
+ *
+ * @param pieces Data and size of each column's values.
+ * @param buffers Receives offset and length pairs for the RecordBatch.
+ * @return std::size_t The body size.
+ */
+std::size_t layoutBody(const std::vector<std::pair<const void*, std::size_t>>& pieces, std::vector<std::int64_t>& buffers) {
+    std::size_t body = 0;
+    for (const auto& piece : pieces) {
+        buffers.push_back(static_cast<std::int64_t>(body));
+        buffers.push_back(0);
+        buffers.push_back(static_cast<std::int64_t>(body));
+        buffers.push_back(static_cast<std::int64_t>(piece.second));
+        body += padTo(piece.second);
+    }
+    return body;
+}
+
+/**
+ * @brief Bounds-checked FlatBuffers reader over a byte range; positions are offsets into it.
+ *
+ * Every read outside the range clears ok and returns zero, so a corrupt file
+ * makes open() fail instead of reading out of bounds.
+ */
+class FlatReader {
+private:
+    const std::uint8_t* base;
+    std::size_t length;
+
+public:
+    static const std::size_t NONE = ~static_cast<std::size_t>(0);
+    bool ok = true;
+
+    FlatReader(const std::uint8_t* data, std::size_t size) : base(data), length(size) {}
+
+    template <typename T>
+    T read(std::size_t pos) {
+        T v = T();
+        if (pos == NONE || pos > length || length - pos < sizeof(T)) {
+            ok = false;
+            return v;
+        }
+        std::memcpy(&v, base + pos, sizeof(T));
+        return v;
+    }
+
+    std::size_t deref(std::size_t pos) {
+        const std::uint32_t v = read<std::uint32_t>(pos);
+        return ok ? pos + v : NONE;
+    }
+
+    std::size_t root() { return deref(0); }
+
+    std::size_t field(std::size_t table, int id) {
+        if (table == NONE) return NONE;
+        const std::int64_t vtable = static_cast<std::int64_t>(table) - read<std::int32_t>(table);
+        if (!ok || vtable < 0) {
+            ok = false;
+            return NONE;
+        }
+        const std::uint16_t vsize = read<std::uint16_t>(static_cast<std::size_t>(vtable));
+        const std::size_t slot = 4 + 2 * static_cast<std::size_t>(id);
+        if (slot + 2 > vsize) return NONE;
+        const std::uint16_t off = read<std::uint16_t>(static_cast<std::size_t>(vtable) + slot);
+        return off ? table + off : NONE;
+    }
+
+    template <typename T>
+    T scalar(std::size_t table, int id, T fallback) {
+        const std::size_t pos = field(table, id);
+        return pos == NONE ? fallback : read<T>(pos);
+    }
+
+    std::size_t table(std::size_t parent, int id) {
+        const std::size_t pos = field(parent, id);
+        return pos == NONE ? NONE : deref(pos);
+    }
+
+    // Returns the position of the first element, or NONE if the field is absent
+    std::size_t vector(std::size_t parent, int id, std::size_t elementSize, std::size_t& count) {
+        count = 0;
+        const std::size_t pos = table(parent, id);
+        if (pos == NONE) return NONE;
+        count = read<std::uint32_t>(pos);
+        if (!ok || (length - pos - 4) / elementSize < count) {
+            ok = false;
+            count = 0;
+            return NONE;
+        }
+        return pos + 4;
+    }
+
+    std::string string(std::size_t parent, int id) {
+        std::size_t n = 0;
+        const std::size_t pos = vector(parent, id, 1, n);
+        return pos == NONE ? std::string() : std::string(reinterpret_cast<const char*>(base + pos), n);
+    }
+};
+
+/**
+ * @brief Checks that a schema is the trajectory schema.
+ */
+bool checkSchema(FlatReader& r, std::size_t schema) {
+    std::size_t count = 0;
+    const std::size_t fieldVector = r.vector(schema, 1, 4, count);
+    if (count != COLUMN_COUNT) return false;
+    for (std::size_t k = 0; k < COLUMN_COUNT; k++) {
+        const ColumnSpec& c = COLUMNS[k];
+        const std::size_t f = r.deref(fieldVector + 4 * k);
+        const std::size_t type = r.table(f, 3);
+        const std::uint8_t typeType = r.scalar<std::uint8_t>(f, 2, 0);
+        if (r.string(f, 0) != c.name) return false;
+        if (c.bitWidth > 0) {
+            if (typeType != TYPE_INT || r.scalar<std::int32_t>(type, 0, 0) != c.bitWidth ||
+                r.scalar<std::uint8_t>(type, 1, 0) != 1)
+                return false;
+        } else if (typeType != TYPE_FLOATING_POINT || r.scalar<std::int16_t>(type, 0, 0) != PRECISION_DOUBLE) {
+            return false;
+        }
+        const std::size_t encoding = r.table(f, 4);
+        if ((encoding != FlatReader::NONE) != (c.dictionary >= 0)) return false;
+        if (c.dictionary >= 0) {
+            const std::size_t index = r.table(encoding, 1);
+            if (r.scalar<std::int64_t>(encoding, 0, 0) != c.dictionary || r.scalar<std::int32_t>(index, 0, 0) != 32 ||
+                r.scalar<std::uint8_t>(index, 1, 0) != 1)
+                return false;
+        }
+    }
+    return r.ok;
+}
+
+} // namespace
+
+/**
+ * @brief Creates the file and writes the Arrow magic and schema.
+ *
+ * A failure is kept in error() and makes every later call return false.
+ *
+ * @param path Path of the file to create or overwrite.
+ * @param batchRows Rows after which a record batch is written (at least 1).
+ */
+ArrowTrajectoryWriter::ArrowTrajectoryWriter(const std::string& path, std::size_t batchRows)
+    : filePath(path), rowsPerBatch(std::max<std::size_t>(batchRows, 1)) {
+    if (!littleEndian()) {
+        failure = "Arrow trajectory files are only written on little-endian hosts";
+        return;
+    }
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        failure = "cannot create " + path;
+        return;
+    }
+    const char lead[8] = {'A', 'R', 'R', 'O', 'W', '1', 0, 0};
+    FlatBuilder fb;
+    const std::uint32_t schema = buildSchema(fb);
+    writeBytes(lead, sizeof(lead)) && writeMessage(finishMessage(fb, HEADER_SCHEMA, schema, 0), {}, nullptr);
+}
+
+/**
+ * @brief Closes the file if close() was not called.
+ */
+ArrowTrajectoryWriter::~ArrowTrajectoryWriter() {
+    close();
+}
+
+/**
+ * @brief Writes raw bytes, recording the first failure.
+ */
+bool ArrowTrajectoryWriter::writeBytes(const void* data, std::size_t size) {
+    if (!good()) return false;
+    if (size > 0 && std::fwrite(data, 1, size, file) != size) {
+        failure = "write failed for " + filePath;
+        return false;
+    }
+    written += size;
+    return true;
+}
+
+/**
+ * @brief Writes an encapsulated message: continuation marker, metadata size, metadata padded to 8 bytes, body.
+ *
+ * @param metadata The Message flatbuffer.
+ * @param body Data and size of each body buffer; each is padded to 8 bytes.
+ * @param block Receives the message's location for the footer; may be null.
+ * @return true on success, false if a write failed.
+ */
+bool ArrowTrajectoryWriter::writeMessage(const std::vector<std::uint8_t>& metadata,
+                                         const std::vector<std::pair<const void*, std::size_t>>& body, Block* block) {
+    static const std::uint8_t zeros[ALIGN] = {};
+    const std::uint64_t start = written;
+    const std::uint32_t metadataSize = static_cast<std::uint32_t>(padTo(metadata.size()));
+    bool ok = writeBytes(&CONTINUATION, 4) && writeBytes(&metadataSize, 4) &&
+              writeBytes(metadata.data(), metadata.size()) && writeBytes(zeros, metadataSize - metadata.size());
+    const std::uint64_t bodyStart = written;
+    for (const auto& piece : body) {
+        ok = ok && writeBytes(piece.first, piece.second) && writeBytes(zeros, padTo(piece.second) - piece.second);
+    }
+    if (ok && block) *block = Block{start, 8 + metadataSize, written - bodyStart};
+    return ok;
+}
+
+/**
+ * @brief Writes the dictionary values added since the last call as a dictionary batch.
+ *
+ * The first batch of a dictionary holds all values so far; later ones are
+ * deltas that append to it.
+ *
+ * @param id Dictionary ID.
+ * @param values All values of the dictionary.
+ * @param sent Number of values already written; updated.
+ * @return true on success or if there is nothing new, false if a write failed.
+ */
+bool ArrowTrajectoryWriter::writeDictionary(std::int64_t id, const std::vector<std::int32_t>& values, std::size_t& sent) {
+    if (sent == values.size()) return true;
+    const std::size_t count = values.size() - sent;
+    const std::vector<std::pair<const void*, std::size_t>> body = {{values.data() + sent, count * sizeof(std::int32_t)}};
+    std::vector<std::int64_t> buffers;
+    const std::size_t bodySize = layoutBody(body, buffers);
+
+    FlatBuilder fb;
+    const std::uint32_t data = buildRecordBatch(fb, static_cast<std::int64_t>(count), 1, buffers);
+    fb.startTable();
+    fb.add<std::int64_t>(0, id);
+    fb.addOffset(1, data);
+    fb.add<std::uint8_t>(2, sent > 0 ? 1 : 0);
+    const std::uint32_t header = fb.endTable();
+
+    Block block{};
+    if (!writeMessage(finishMessage(fb, HEADER_DICTIONARY_BATCH, header, static_cast<std::int64_t>(bodySize)), body, &block))
+        return false;
+    dictionaryBlocks.push_back(block);
+    sent = values.size();
+    return true;
+}
+
+/**
+ * @brief Writes the pending rows as a record batch, preceded by any new dictionary values.
+ *
+ * @return true on success or if no row is pending, false if a write failed.
+ */
+bool ArrowTrajectoryWriter::flush() {
+    if (!good()) return false;
+    const std::size_t n = stepCol.size();
+    if (n == 0) return true;
+    if (!writeDictionary(RUN_DICTIONARY, runDict, runSent) || !writeDictionary(VEHICLE_DICTIONARY, vehicleDict, vehicleSent))
+        return false;
+
+    const std::vector<std::pair<const void*, std::size_t>> body = {
+        {runCol.data(), n * sizeof(std::int32_t)}, {stepCol.data(), n * sizeof(std::int64_t)},
+        {timeCol.data(), n * sizeof(double)},      {vehicleCol.data(), n * sizeof(std::int32_t)},
+        {xCol.data(), n * sizeof(double)},         {yCol.data(), n * sizeof(double)},
+        {speedCol.data(), n * sizeof(double)},     {headingCol.data(), n * sizeof(double)}
+    };
+    std::vector<std::int64_t> buffers;
+    const std::size_t bodySize = layoutBody(body, buffers);
+    FlatBuilder fb;
+    const std::uint32_t header = buildRecordBatch(fb, static_cast<std::int64_t>(n), COLUMN_COUNT, buffers);
+    Block block{};
+    if (!writeMessage(finishMessage(fb, HEADER_RECORD_BATCH, header, static_cast<std::int64_t>(bodySize)), body, &block))
+        return false;
+    batchBlocks.push_back(block);
+    rowCount += n;
+
+    runCol.clear();
+    stepCol.clear();
+    timeCol.clear();
+    vehicleCol.clear();
+    xCol.clear();
+    yCol.clear();
+    speedCol.clear();
+    headingCol.clear();
+    return true;
+}
+
+/**
+ * @brief Appends every logged step of a run.
+ *
+ * Steps are decoded one at a time, so memory stays bounded by one batch
+ * however long the run. A run whose ID was written before gets the same
+ * dictionary code.
+ *
+ * @param run The run; its log may be in memory or streamed to a file.
+ * @return true on success, false if a write failed.
+ */
+bool ArrowTrajectoryWriter::write(const RunRecord& run) {
+    if (!good() || !file) return false;
+    auto known = std::find(runDict.begin(), runDict.end(), run.runId);
+    const std::int32_t runCode = static_cast<std::int32_t>(known - runDict.begin());
+    if (known == runDict.end()) runDict.push_back(run.runId);
+
+    std::int64_t step = 0;
+    for (const LogEntry& entry : run.logs) {
+        const std::size_t n = entry.positions.size();
+        if (!stepCol.empty() && stepCol.size() + n > rowsPerBatch && !flush()) return false;
+        lastIds.resize(n, 0);
+        lastCodes.resize(n, -1);
+        for (std::size_t i = 0; i < n; i++) {
+            const Vehicle& v = entry.positions[i];
+            if (lastCodes[i] < 0 || lastIds[i] != v.id) {
+                auto it = vehicleCode.find(v.id);
+                if (it == vehicleCode.end()) {
+                    it = vehicleCode.emplace(v.id, static_cast<std::int32_t>(vehicleDict.size())).first;
+                    vehicleDict.push_back(v.id);
+                }
+                lastIds[i] = v.id;
+                lastCodes[i] = it->second;
+            }
+            runCol.push_back(runCode);
+            stepCol.push_back(step);
+            timeCol.push_back(entry.time);
+            vehicleCol.push_back(lastCodes[i]);
+            xCol.push_back(v.x);
+            yCol.push_back(v.y);
+            speedCol.push_back(v.speed);
+            headingCol.push_back(v.direction);
+        }
+        step++;
+    }
+    return true;
+}
+
+/**
+ * @brief Writes the pending rows and the footer, and closes the file.
+ *
+ * The footer repeats the schema and lists every dictionary and record
+ * batch, followed by its size and the closing magic. Closing twice is a no-op.
+ *
+ * @return true on success, false if a write failed.
+ */
+bool ArrowTrajectoryWriter::close() {
+    if (!file) return good();
+    const std::uint32_t endOfStream[2] = {CONTINUATION, 0};
+    if (flush() && writeBytes(endOfStream, sizeof(endOfStream))) {
+        auto blockBytes = [](const std::vector<Block>& blocks) {
+            std::vector<std::uint8_t> bytes(blocks.size() * 24, 0);
+            for (std::size_t k = 0; k < blocks.size(); k++) {
+                const std::int64_t offset = static_cast<std::int64_t>(blocks[k].offset);
+                const std::int32_t metadataSize = static_cast<std::int32_t>(blocks[k].metadataSize);
+                const std::int64_t bodySize = static_cast<std::int64_t>(blocks[k].bodySize);
+                std::memcpy(&bytes[k * 24], &offset, 8);
+                std::memcpy(&bytes[k * 24 + 8], &metadataSize, 4);
+                std::memcpy(&bytes[k * 24 + 16], &bodySize, 8);
+            }
+            return bytes;
+        };
+        const std::vector<std::uint8_t> dictionaries = blockBytes(dictionaryBlocks);
+        const std::vector<std::uint8_t> batches = blockBytes(batchBlocks);
+        FlatBuilder fb;
+        const std::uint32_t schema = buildSchema(fb);
+        const std::uint32_t dictionaryVector = fb.vector(dictionaries.data(), dictionaryBlocks.size(), 24, 8);
+        const std::uint32_t batchVector = fb.vector(batches.data(), batchBlocks.size(), 24, 8);
+        fb.startTable();
+        fb.add<std::int16_t>(0, METADATA_V5);
+        fb.addOffset(1, schema);
+        fb.addOffset(2, dictionaryVector);
+        fb.addOffset(3, batchVector);
+        const std::vector<std::uint8_t> footer = fb.finish(fb.endTable());
+        const std::int32_t footerSize = static_cast<std::int32_t>(footer.size());
+        writeBytes(footer.data(), footer.size()) && writeBytes(&footerSize, 4) && writeBytes(MAGIC, sizeof(MAGIC));
+    }
+    if (std::fclose(file) != 0 && good()) failure = "write failed for " + filePath;
+    file = nullptr;
+    return good();
+}
+
+/**
+ * @brief Maps a trajectory file and validates its structure.
+ *
+ * Checks the magic at both ends, the footer's schema, and that every
+ * message lies inside the file and every column buffer inside its body,
+ * holds its rows and is aligned for its type.
+ *
+ * @param path Path of the file to open.
+ * @param error Receives a description of the failure, if any.
+ * @return true on success, false otherwise.
+ */
+bool ArrowTrajectoryFile::open(const std::string& path, std::string& error) {
+    close();
+    if (!littleEndian()) {
+        error = "Arrow trajectory files are only read on little-endian hosts";
+        return false;
+    }
+    if (!file.open(path, error)) return false;
+    const std::uint8_t* data = file.data();
+    const std::size_t size = file.size();
+    auto fail = [&](const std::string& why) {
+        error = path + ": " + why;
+        close();
+        return false;
+    };
+    if (size < 8 + 10 || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0 ||
+        std::memcmp(data + size - sizeof(MAGIC), MAGIC, sizeof(MAGIC)) != 0)
+        return fail("not an Arrow file");
+    std::int32_t footerSize;
+    std::memcpy(&footerSize, data + size - 10, 4);
+    if (footerSize <= 0 || static_cast<std::size_t>(footerSize) > size - 18) return fail("bad footer size");
+
+    FlatReader footer(data + size - 10 - footerSize, static_cast<std::size_t>(footerSize));
+    const std::size_t root = footer.root();
+    if (!checkSchema(footer, footer.table(root, 1))) return fail("not a trajectory file");
+
+    // Reads the batch of the message at a footer block; columns are checked against their widths in bits.
+    // Dictionary batches also give their dictionary ID and delta flag.
+    auto readBatch = [&](std::size_t at, bool dictionary, std::size_t columns, const int* widths, std::size_t& rows,
+                         std::vector<const std::uint8_t*>& out, std::int64_t& id, bool& delta) {
+        FlatReader& blocks = footer;
+        const std::int64_t offset = blocks.read<std::int64_t>(at);
+        const std::int32_t metadataSize = blocks.read<std::int32_t>(at + 8);
+        const std::int64_t bodySize = blocks.read<std::int64_t>(at + 16);
+        if (!blocks.ok || offset < 0 || metadataSize < 8 || bodySize < 0 ||
+            static_cast<std::uint64_t>(offset) + static_cast<std::uint64_t>(metadataSize) + static_cast<std::uint64_t>(bodySize) > size)
+            return false;
+        const std::uint8_t* message = data + offset;
+        const std::uint8_t* body = message + metadataSize;
+        FlatReader r(message + 8, static_cast<std::size_t>(metadataSize - 8));
+        const std::size_t msg = r.root();
+        const std::uint8_t headerType = r.scalar<std::uint8_t>(msg, 1, 0);
+        const std::size_t header = r.table(msg, 2);
+        std::size_t batchTable = header;
+        if (headerType != (dictionary ? HEADER_DICTIONARY_BATCH : HEADER_RECORD_BATCH)) return false;
+        if (dictionary) {
+            id = r.scalar<std::int64_t>(header, 0, -1);
+            delta = r.scalar<std::uint8_t>(header, 2, 0) != 0;
+            batchTable = r.table(header, 1);
+        }
+        const std::int64_t length = r.scalar<std::int64_t>(batchTable, 0, -1);
+        std::size_t nodeCount = 0, bufferCount = 0;
+        r.vector(batchTable, 1, 16, nodeCount);
+        const std::size_t buffers = r.vector(batchTable, 2, 16, bufferCount);
+        if (!r.ok || length < 0 || nodeCount != columns || bufferCount != 2 * columns) return false;
+        rows = static_cast<std::size_t>(length);
+        out.clear();
+        for (std::size_t c = 0; c < columns; c++) {
+            const std::int64_t bufferOffset = r.read<std::int64_t>(buffers + (2 * c + 1) * 16);
+            const std::int64_t bufferLength = r.read<std::int64_t>(buffers + (2 * c + 1) * 16 + 8);
+            const std::size_t width = static_cast<std::size_t>(widths[c]) / 8;
+            const std::uint8_t* start = body + bufferOffset;
+            if (!r.ok || bufferOffset < 0 || bufferLength < 0 || bufferOffset + bufferLength > bodySize ||
+                static_cast<std::size_t>(bufferLength) / width < rows || reinterpret_cast<std::uintptr_t>(start) % width != 0)
+                return false;
+            out.push_back(start);
+        }
+        return true;
+    };
+
+    std::size_t count = 0;
+    std::size_t rows = 0;
+    std::vector<const std::uint8_t*> columns;
+    std::int64_t id = -1;
+    bool delta = false;
+    const std::size_t dictionaries = footer.vector(root, 2, 24, count);
+    const int dictionaryWidth[1] = {32};
+    for (std::size_t k = 0; k < count; k++) {
+        if (!readBatch(dictionaries + 24 * k, true, 1, dictionaryWidth, rows, columns, id, delta))
+            return fail("bad dictionary batch");
+        std::vector<std::int32_t>* dict = id == RUN_DICTIONARY ? &runDict : id == VEHICLE_DICTIONARY ? &vehicleDict : nullptr;
+        if (!dict) return fail("unknown dictionary");
+        if (!delta) dict->clear();
+        const std::int32_t* values = reinterpret_cast<const std::int32_t*>(columns[0]);
+        dict->insert(dict->end(), values, values + rows);
+    }
+
+    int widths[COLUMN_COUNT];
+    for (std::size_t c = 0; c < COLUMN_COUNT; c++) widths[c] = COLUMNS[c].bitWidth > 0 ? COLUMNS[c].bitWidth : 64;
+    const std::size_t batches = footer.vector(root, 3, 24, count);
+    for (std::size_t k = 0; k < count; k++) {
+        if (!readBatch(batches + 24 * k, false, COLUMN_COUNT, widths, rows, columns, id, delta))
+            return fail("bad record batch");
+        ArrowTrajectoryBatch b;
+        b.rows = rows;
+        b.runCode = reinterpret_cast<const std::int32_t*>(columns[0]);
+        b.step = reinterpret_cast<const std::int64_t*>(columns[1]);
+        b.time = reinterpret_cast<const double*>(columns[2]);
+        b.vehicleCode = reinterpret_cast<const std::int32_t*>(columns[3]);
+        b.x = reinterpret_cast<const double*>(columns[4]);
+        b.y = reinterpret_cast<const double*>(columns[5]);
+        b.speed = reinterpret_cast<const double*>(columns[6]);
+        b.heading = reinterpret_cast<const double*>(columns[7]);
+        batchList.push_back(b);
+        rowCount += rows;
+    }
+    if (!footer.ok) return fail("bad footer");
+    return true;
+}
+
+/**
+ * @brief Unmaps the file; it holds no batches afterwards.
+ */
+void ArrowTrajectoryFile::close() {
+    file.close();
+    batchList.clear();
+    runDict.clear();
+    vehicleDict.clear();
+    rowCount = 0;
+}
@@ -0,0 +1,204 @@
+#ifndef ARROWTRAJECTORY_H
+#define ARROWTRAJECTORY_H
+
+#include "MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct RunRecord;
+
+/**
+ * @brief Writes run logs as an Arrow IPC file with one row per vehicle and logged step.
+ *
+ * The file follows the Arrow IPC file format (metadata version 5,
+ * little-endian, uncompressed), so pyarrow, Polars, DuckDB and other Arrow
+ * readers can memory-map it and use its columns without copying. Columns:
+ * - run_id (int32, dictionary-encoded),
+ * - step (int64, index of the logged step in its run's log),
+ * - time (float64, simulation time in seconds),
+ * - vehicle_id (int32, dictionary-encoded),
+ * - x, y, speed, heading (float64; heading in degrees).
+ *
+ * Rows are buffered and written in record batches of about rowsPerBatch
+ * rows; a logged step is never split across batches. The dictionaries grow
+ * as new runs and vehicles appear: each batch that introduces values is
+ * preceded by a delta dictionary batch holding only the new ones, so the
+ * writer never needs a first pass over the logs.
+ */
+class ArrowTrajectoryWriter {
+public:
+    /** Default number of rows per record batch. */
+    static const std::size_t DEFAULT_ROWS_PER_BATCH = 65536;
+
+private:
+    /**
+     * @brief Location of one message in the file, as listed in the footer.
+     */
+    struct Block {
+        std::uint64_t offset;        /**< File offset of the message. */
+        std::uint32_t metadataSize;  /**< Size of the message's prefix and metadata, padding included. */
+        std::uint64_t bodySize;      /**< Size of the message body. */
+    };
+
+    std::string filePath;            /**< Path of the file. */
+    std::FILE* file = nullptr;       /**< Open file, or null after close() or a failure. */
+    std::string failure;             /**< Description of the first failure; empty while good. */
+    std::size_t rowsPerBatch;        /**< Rows after which a record batch is written. */
+    std::uint64_t written = 0;       /**< Bytes written so far. */
+    std::uint64_t rowCount = 0;      /**< Rows written in finished batches. */
+
+    std::vector<std::int32_t> runCol;     /**< Pending run_id dictionary codes. */
+    std::vector<std::int64_t> stepCol;    /**< Pending step values. */
+    std::vector<double> timeCol;          /**< Pending time values. */
+    std::vector<std::int32_t> vehicleCol; /**< Pending vehicle_id dictionary codes. */
+    std::vector<double> xCol;             /**< Pending x values. */
+    std::vector<double> yCol;             /**< Pending y values. */
+    std::vector<double> speedCol;         /**< Pending speed values. */
+    std::vector<double> headingCol;       /**< Pending heading values. */
+
+    std::vector<std::int32_t> runDict;     /**< run_id dictionary values, by code. */
+    std::vector<std::int32_t> vehicleDict; /**< vehicle_id dictionary values, by code. */
+    std::size_t runSent = 0;               /**< Run dictionary values already written. */
+    std::size_t vehicleSent = 0;           /**< Vehicle dictionary values already written. */
+    std::unordered_map<int, std::int32_t> vehicleCode; /**< Dictionary code of each vehicle ID. */
+    std::vector<int> lastIds;              /**< Vehicle IDs of the last step, to skip lookups while the fleet is unchanged. */
+    std::vector<std::int32_t> lastCodes;   /**< Codes of lastIds. */
+
+    std::vector<Block> dictionaryBlocks;   /**< Dictionary batches written, in file order. */
+    std::vector<Block> batchBlocks;        /**< Record batches written, in file order. */
+
+    bool writeBytes(const void* data, std::size_t size);
+    bool writeMessage(const std::vector<std::uint8_t>& metadata, const std::vector<std::pair<const void*, std::size_t>>& body,
+                      Block* block);
+    bool writeDictionary(std::int64_t id, const std::vector<std::int32_t>& values, std::size_t& sent);
+    bool flush();
+
+public:
+    /**
+     * @brief Creates the file and writes the Arrow magic and schema.
+     *
+     * @param path Path of the file to create or overwrite.
+     * @param batchRows Rows after which a record batch is written (at least 1).
+     */
+    explicit ArrowTrajectoryWriter(const std::string& path, std::size_t batchRows = DEFAULT_ROWS_PER_BATCH);
+
+    /**
+     * @brief Closes the file if close() was not called.
+     */
+    ~ArrowTrajectoryWriter();
+
+    ArrowTrajectoryWriter(const ArrowTrajectoryWriter&) = delete;
+    ArrowTrajectoryWriter& operator=(const ArrowTrajectoryWriter&) = delete;
+
+    /**
+     * @brief Returns true while no write has failed.
+     */
+    bool good() const { return failure.empty(); }
+
+    /**
+     * @brief Returns a description of the first failure, or an empty string.
+     */
+    const std::string& error() const { return failure; }
+
+    /**
+     * @brief Appends every logged step of a run.
+     *
+     * @param run The run; its log may be in memory or streamed to a file.
+     * @return true on success, false if a write failed.
+     */
+    bool write(const RunRecord& run);
+
+    /**
+     * @brief Writes the pending rows and the footer, and closes the file.
+     *
+     * @return true on success, false if a write failed.
+     */
+    bool close();
+
+    /**
+     * @brief Returns the number of rows in finished record batches.
+     */
+    std::uint64_t rows() const { return rowCount; }
+
+    /**
+     * @brief Returns the number of record batches written.
+     */
+    std::size_t batches() const { return batchBlocks.size(); }
+};
+
+/**
+ * @brief One record batch of a mapped trajectory file; the columns point into the mapping.
+ */
+struct ArrowTrajectoryBatch {
+    std::size_t rows = 0;                       /**< Number of rows. */
+    const std::int32_t* runCode = nullptr;      /**< run_id dictionary codes. */
+    const std::int64_t* step = nullptr;         /**< Index of the logged step in its run. */
+    const double* time = nullptr;               /**< Simulation time in seconds. */
+    const std::int32_t* vehicleCode = nullptr;  /**< vehicle_id dictionary codes. */
+    const double* x = nullptr;                  /**< X-coordinate. */
+    const double* y = nullptr;                  /**< Y-coordinate. */
+    const double* speed = nullptr;              /**< Speed. */
+    const double* heading = nullptr;            /**< Heading in degrees. */
+};
+
+/**
+ * @brief Maps a trajectory file written by ArrowTrajectoryWriter and reads its columns in place.
+ *
+ * open() walks the footer, checks the schema, decodes the dictionaries and
+ * validates every buffer against the mapping; the batches then expose the
+ * column buffers directly, with no copy.
+ */
+class ArrowTrajectoryFile {
+private:
+    MappedFile file;                          /**< The mapped file. */
+    std::vector<ArrowTrajectoryBatch> batchList; /**< The record batches, in file order. */
+    std::vector<std::int32_t> runDict;        /**< run_id dictionary values, by code. */
+    std::vector<std::int32_t> vehicleDict;    /**< vehicle_id dictionary values, by code. */
+    std::uint64_t rowCount = 0;               /**< Rows over all batches. */
+
+public:
+    /**
+     * @brief Maps a trajectory file and validates its structure.
+     *
+     * @param path Path of the file to open.
+     * @param error Receives a description of the failure, if any.
+     * @return true on success, false otherwise.
+     */
+    bool open(const std::string& path, std::string& error);
+
+    /**
+     * @brief Unmaps the file; it holds no batches afterwards.
+     */
+    void close();
+
+    /**
+     * @brief Returns the number of record batches.
+     */
+    std::size_t batchCount() const { return batchList.size(); }
+
+    /**
+     * @brief Returns a record batch; valid until close().
+     */
+    const ArrowTrajectoryBatch& batch(std::size_t i) const { return batchList[i]; }
+
+    /**
+     * @brief Returns the run IDs by dictionary code.
+     */
+    const std::vector<std::int32_t>& runIds() const { return runDict; }
+
+    /**
+     * @brief Returns the vehicle IDs by dictionary code.
+     */
+    const std::vector<std::int32_t>& vehicleIds() const { return vehicleDict; }
+
+    /**
+     * @brief Returns the number of rows over all batches.
+     */
+    std::uint64_t rows() const { return rowCount; }
+};
+
+#endif // ARROWTRAJECTORY_H
@@ -0,0 +1,138 @@
+#include "AsyncOutput.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+namespace {
+
+/** How long a writer waiting for the drain thread sleeps between checks. */
+const std::chrono::microseconds IDLE_WAIT(200);
+
+} // namespace
+
+/**
+ * @brief Starts the drain thread.
+ *
+ * @param target The sink to write to.
+ * @param capacity Ring size in bytes, rounded up to a power of two.
+ */
+AsyncOutput::AsyncOutput(std::shared_ptr<OutputSink> target, std::size_t capacity)
+    : sink(std::move(target)) {
+    std::size_t size = 64;
+    while (size < capacity) size *= 2;
+    ring.resize(size);
+    mask = size - 1;
+    drainer = std::thread(&AsyncOutput::drainLoop, this);
+}
+
+/**
+ * @brief Writes all queued text and stops the drain thread.
+ */
+AsyncOutput::~AsyncOutput() {
+    stopping.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        idle.notify_one();
+    }
+    drainer.join();
+}
+
+/**
+ * @brief Drain thread: writes every published byte to the sink.
+ *
+ * Each pass writes all text published so far, in at most two pieces where
+ * it wraps around the ring, then flushes the sink and releases the space.
+ * With nothing left to write it waits on the condition variable. Releasing
+ * the space and the producer's publishing are sequentially consistent, so
+ * either the producer sees the ring empty and wakes the thread, or the
+ * thread sees the new head before it waits.
+ */
+void AsyncOutput::drainLoop() {
+    std::uint64_t done = tail.load(std::memory_order_relaxed);
+    while (true) {
+        const std::uint64_t published = head.load(std::memory_order_acquire);
+        if (published == done) {
+            if (stopping.load(std::memory_order_acquire) && head.load(std::memory_order_acquire) == done) return;
+            std::unique_lock<std::mutex> lock(idleMutex);
+            idle.wait(lock, [this, done] {
+                return head.load(std::memory_order_seq_cst) != done || stopping.load(std::memory_order_acquire);
+            });
+            continue;
+        }
+        const std::size_t from = static_cast<std::size_t>(done & mask);
+        const std::size_t size = static_cast<std::size_t>(published - done);
+        const std::size_t first = std::min(size, ring.size() - from);
+        sink->write(ring.data() + from, first);
+        if (first < size) sink->write(ring.data(), size - first);
+        sink->flush();
+        done = published;
+        tail.store(done, std::memory_order_seq_cst);
+    }
+}
+
+/**
+ * @brief Copies a message that fits in the free space into the ring and publishes it.
+ *
+ * Wakes the drain thread if the ring was empty; otherwise it is still busy
+ * with earlier text and will pick the message up on its next pass.
+ */
+void AsyncOutput::push(const char* data, std::size_t size) {
+    const std::uint64_t at = head.load(std::memory_order_relaxed);
+    const std::size_t from = static_cast<std::size_t>(at & mask);
+    const std::size_t first = std::min(size, ring.size() - from);
+    std::memcpy(ring.data() + from, data, first);
+    std::memcpy(ring.data(), data + first, size - first);
+    head.store(at + size, std::memory_order_seq_cst);
+    if (tail.load(std::memory_order_seq_cst) == at) {
+        std::lock_guard<std::mutex> lock(idleMutex);
+        idle.notify_one();
+    }
+}
+
+/**
+ * @brief Queues a message if the ring has room for all of it, without blocking.
+ *
+ * @param data Start of the message.
+ * @param size Number of bytes.
+ * @return true if queued, false if the message was dropped.
+ */
+bool AsyncOutput::tryWrite(const char* data, std::size_t size) {
+    const std::uint64_t used = head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire);
+    if (size > ring.size() - used) {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    push(data, size);
+    return true;
+}
+
+/**
+ * @brief Queues a message, waiting for the drain thread to make room if needed.
+ *
+ * @param data Start of the message.
+ * @param size Number of bytes; larger messages than the ring are queued in pieces.
+ */
+void AsyncOutput::write(const char* data, std::size_t size) {
+    while (size > 0) {
+        const std::uint64_t used = head.load(std::memory_order_relaxed) - tail.load(std::memory_order_acquire);
+        const std::size_t room = ring.size() - static_cast<std::size_t>(used);
+        if (room == 0) {
+            std::this_thread::sleep_for(IDLE_WAIT);
+            continue;
+        }
+        const std::size_t piece = std::min(size, room);
+        push(data, piece);
+        data += piece;
+        size -= piece;
+    }
+}
+
+/**
+ * @brief Blocks until all text queued so far has been written to the sink and flushed.
+ */
+void AsyncOutput::flush() {
+    const std::uint64_t target = head.load(std::memory_order_relaxed);
+    while (tail.load(std::memory_order_acquire) < target) {
+        std::this_thread::sleep_for(IDLE_WAIT);
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef ASYNCOUTPUT_H
+#define ASYNCOUTPUT_H
+
+#include "OutputSink.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Hands text from one producer thread to an OutputSink written by a drain thread.
+ *
+ * The text goes through a lock-free single-producer/single-consumer byte
+ * ring: the producer copies a message in and publishes it by advancing the
+ * head, the drain thread writes everything between tail and head to the
+ * sink, flushes it and advances the tail. tryWrite() never blocks: if the
+ * ring has no room for a message, the message is dropped and counted, so a
+ * slow terminal can never stall the simulation. write() waits for room
+ * instead, for callers such as a replay that must not lose text.
+ *
+ * An idle drain thread blocks on a condition variable; the producer only
+ * takes the mutex to wake it when a message lands in an empty ring, so a
+ * Simulation that printed once costs nothing while it stays quiet.
+ *
+ * Only one thread may write to an AsyncOutput at a time.
+ */
+class AsyncOutput {
+private:
+    std::shared_ptr<OutputSink> sink;       /**< Destination of the text. */
+    std::vector<char> ring;                 /**< Ring storage; its size is a power of two. */
+    std::size_t mask;                       /**< ring.size() - 1. */
+    alignas(64) std::atomic<std::uint64_t> head{0}; /**< Bytes published by the producer. */
+    alignas(64) std::atomic<std::uint64_t> tail{0}; /**< Bytes written to the sink by the drain thread. */
+    std::atomic<std::uint64_t> dropped{0};  /**< Messages dropped by tryWrite(). */
+    std::atomic<bool> stopping{false};      /**< Set when the drain thread should exit once the ring is empty. */
+    std::mutex idleMutex;                   /**< Guards the idle drain thread's check for new text. */
+    std::condition_variable idle;           /**< Wakes the drain thread when text arrives or it should stop. */
+    std::thread drainer;                    /**< The drain thread. */
+
+    void drainLoop();
+    void push(const char* data, std::size_t size);
+
+public:
+    /**
+     * @brief Starts the drain thread.
+     *
+     * @param target The sink to write to.
+     * @param capacity Ring size in bytes, rounded up to a power of two.
+     */
+    explicit AsyncOutput(std::shared_ptr<OutputSink> target, std::size_t capacity = 1 << 20);
+
+    /**
+     * @brief Writes all queued text and stops the drain thread.
+     */
+    ~AsyncOutput();
+
+    AsyncOutput(const AsyncOutput&) = delete;
+    AsyncOutput& operator=(const AsyncOutput&) = delete;
+
+    /**
+     * @brief Queues a message if the ring has room for all of it, without blocking.
+     *
+     * @param data Start of the message.
+     * @param size Number of bytes.
+     * @return true if queued, false if the message was dropped.
+     */
+    bool tryWrite(const char* data, std::size_t size);
+
+    bool tryWrite(const std::string& text) { return tryWrite(text.data(), text.size()); } /**< @brief Same as tryWrite(text.data(), text.size()). */
+
+    /**
+     * @brief Queues a message, waiting for the drain thread to make room if needed.
+     *
+     * @param data Start of the message.
+     * @param size Number of bytes; larger messages than the ring are queued in pieces.
+     */
+    void write(const char* data, std::size_t size);
+
+    void write(const std::string& text) { write(text.data(), text.size()); } /**< @brief Same as write(text.data(), text.size()). */
+
+    /**
+     * @brief Blocks until all text queued so far has been written to the sink and flushed.
+     */
+    void flush();
+
+    /**
+     * @brief Returns the number of messages dropped by tryWrite() so far.
+     */
+    std::uint64_t droppedMessages() const { return dropped.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Returns the sink the text is written to.
+     */
+    const std::shared_ptr<OutputSink>& target() const { return sink; }
+};
+
+#endif // ASYNCOUTPUT_H
@@ -0,0 +1,141 @@
+#include "AsyncRun.h"
+#include <algorithm>
+
+/**
+ * @brief Creates a control for one run.
+ *
+ * @param publishEvery Publish a frame every this many steps (at least 1).
+ * @param startPaused True to start paused.
+ */
+RunControl::RunControl(long long publishEvery, bool startPaused)
+    : pausedFlag(startPaused), every(std::max(publishEvery, 1LL)) {}
+
+/**
+ * @brief Asks the run to end before its next step.
+ */
+void RunControl::stop() {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping.store(true, std::memory_order_release);
+    wake.notify_all();
+}
+
+/**
+ * @brief Holds the run before its next step.
+ */
+void RunControl::pause() {
+    std::lock_guard<std::mutex> lock(mutex);
+    granted.store(0, std::memory_order_relaxed);
+    pausedFlag.store(true, std::memory_order_release);
+}
+
+/**
+ * @brief Lets a paused run continue.
+ */
+void RunControl::resume() {
+    std::lock_guard<std::mutex> lock(mutex);
+    pausedFlag.store(false, std::memory_order_release);
+    wake.notify_all();
+}
+
+/**
+ * @brief Lets a paused run execute n more steps, then hold again.
+ *
+ * Has no effect on a run that is not paused.
+ *
+ * @param n Number of steps.
+ */
+void RunControl::step(long long n) {
+    std::lock_guard<std::mutex> lock(mutex);
+    granted.fetch_add(n, std::memory_order_relaxed);
+    wake.notify_all();
+}
+
+/**
+ * @brief Run thread: waits while paused and returns whether the next step may execute.
+ *
+ * Returns without locking unless the run is paused.
+ *
+ * @return false if a stop was requested.
+ */
+bool RunControl::proceed() {
+    if (stopping.load(std::memory_order_acquire)) return false;
+    if (!pausedFlag.load(std::memory_order_acquire)) return true;
+
+    std::unique_lock<std::mutex> lock(mutex);
+    wake.wait(lock, [this] {
+        return stopping.load(std::memory_order_relaxed) || !pausedFlag.load(std::memory_order_relaxed) ||
+               granted.load(std::memory_order_relaxed) > 0;
+    });
+    if (stopping.load(std::memory_order_relaxed)) return false;
+    if (pausedFlag.load(std::memory_order_relaxed)) granted.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+/**
+ * @brief Run thread: publishes the state at the end of a step.
+ *
+ * Fills the back slot, then makes it the middle slot marked fresh; the
+ * previous middle slot becomes the new back slot.
+ *
+ * @param step Number of steps executed.
+ * @param time Simulation time reached.
+ * @param status Run status.
+ * @param vehicles Vehicle states; the frame shares their columns.
+ */
+void RunControl::publish(long long step, double time, const std::string& status, const VehicleStore& vehicles) {
+    SimulationFrame& frame = slots[back];
+    frame.step = step;
+    frame.time = time;
+    frame.status = status;
+    frame.vehicles = vehicles;
+    back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & (FRESH - 1);
+}
+
+/**
+ * @brief Copies the latest published frame without blocking the run.
+ *
+ * @param out Receives the frame; shares the vehicle columns.
+ * @return true if a frame was published, false otherwise.
+ */
+bool RunControl::poll(SimulationFrame& out) {
+    std::lock_guard<std::mutex> lock(readerMutex);
+    if (middle.load(std::memory_order_relaxed) & FRESH) {
+        front = middle.exchange(front, std::memory_order_acq_rel) & (FRESH - 1);
+        seen = true;
+    }
+    if (!seen) return false;
+    out = slots[front];
+    return true;
+}
+
+/**
+ * @brief Starts the run on a new thread.
+ *
+ * @param sim The simulation to run.
+ * @param options Limits of the run.
+ * @param publishEvery Publish a frame every this many steps.
+ * @param startPaused True to start paused.
+ */
+AsyncRun::AsyncRun(Simulation& sim, const RunOptions& options, long long publishEvery, bool startPaused)
+    : ctrl(publishEvery, startPaused) {
+    worker = std::thread([this, &sim, options] {
+        result = sim.run(options, ctrl);
+        done.store(true, std::memory_order_release);
+    });
+}
+
+/**
+ * @brief Stops the run and joins its thread.
+ */
+AsyncRun::~AsyncRun() {
+    ctrl.stop();
+    if (worker.joinable()) worker.join();
+}
+
+/**
+ * @brief Waits for the run to end and returns its result.
+ */
+const RunResult& AsyncRun::wait() {
+    if (worker.joinable()) worker.join();
+    return result;
+}
@@ -0,0 +1,182 @@
+#ifndef ASYNCRUN_H
+#define ASYNCRUN_H
+
+#include "Simulation.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * @brief The state of a run as published after a step.
+ *
+ * The store shares its columns copy-on-write with the simulation, so a
+ * frame costs no vehicle copy when it is published; the simulation copies
+ * the positions when it next moves the vehicles.
+ */
+struct SimulationFrame {
+    long long step = 0;     /**< Number of steps executed. */
+    double time = 0.0;      /**< Simulation time at the end of the step, in seconds. */
+    std::string status;     /**< "Running" during the run, then the final status. */
+    VehicleStore vehicles;  /**< Vehicle states at the end of the step. */
+};
+
+/**
+ * @brief Controls and observes a run from other threads.
+ *
+ * Simulation::run(options, control) checks the control before every step:
+ * it ends the run when a stop was requested and, while paused, blocks until
+ * the run is resumed or given steps with step(). Checking costs two atomic
+ * loads while the run is not paused.
+ *
+ * Frames are handed to readers through a triple buffer: the simulation
+ * fills its back slot and swaps it with the middle slot in one atomic
+ * exchange, and poll() swaps the middle slot with the front slot if a newer
+ * frame arrived. Neither side ever waits for the other. Readers on several
+ * threads serialize on a mutex of their own, which the simulation never
+ * takes.
+ */
+class RunControl {
+private:
+    static constexpr unsigned FRESH = 4; /**< Set in middle when it holds a frame the reader has not seen. */
+
+    std::atomic<bool> stopping{false};   /**< Set by stop(); the run ends before its next step. */
+    std::atomic<bool> pausedFlag{false}; /**< While set, the run only executes steps granted by step(). */
+    std::atomic<long long> granted{0};   /**< Steps a paused run may still execute. */
+    std::mutex mutex;                    /**< Guards waiting on wake. */
+    std::condition_variable wake;        /**< Signalled by stop(), resume() and step(). */
+    long long every;                     /**< Publish a frame every this many steps. */
+
+    SimulationFrame slots[3];            /**< Back, middle and front frames, in rotating roles. */
+    std::atomic<unsigned> middle{1};     /**< Index of the middle slot, plus FRESH. */
+    unsigned back = 0;                   /**< Slot the simulation fills; owned by the run thread. */
+    unsigned front = 2;                  /**< Slot readers copy from; guarded by readerMutex. */
+    bool seen = false;                   /**< True once a frame reached the front slot; guarded by readerMutex. */
+    std::mutex readerMutex;              /**< Serializes readers. */
+
+public:
+    /**
+     * @brief Creates a control for one run.
+     *
+     * @param publishEvery Publish a frame every this many steps (at least 1); the final state is always published.
+     * @param startPaused True to start paused, so the run executes no step before resume() or step().
+     */
+    explicit RunControl(long long publishEvery = 1, bool startPaused = false);
+
+    RunControl(const RunControl&) = delete;
+    RunControl& operator=(const RunControl&) = delete;
+
+    /**
+     * @brief Asks the run to end before its next step; it ends with status "Stopped".
+     */
+    void stop();
+
+    /**
+     * @brief Holds the run before its next step.
+     */
+    void pause();
+
+    /**
+     * @brief Lets a paused run continue.
+     */
+    void resume();
+
+    /**
+     * @brief Lets a paused run execute n more steps, then hold again.
+     *
+     * @param n Number of steps.
+     */
+    void step(long long n);
+
+    /**
+     * @brief Returns true if a stop was requested.
+     */
+    bool stopRequested() const { return stopping.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Returns true while the run is paused.
+     */
+    bool paused() const { return pausedFlag.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Copies the latest published frame without blocking the run.
+     *
+     * @param out Receives the frame; shares the vehicle columns.
+     * @return true if a frame was published, false if the run has not published any yet.
+     */
+    bool poll(SimulationFrame& out);
+
+    /**
+     * @brief Run thread: waits while paused and returns whether the next step may execute.
+     *
+     * @return false if a stop was requested.
+     */
+    bool proceed();
+
+    /**
+     * @brief Run thread: returns true if the frame after this step is due for publishing.
+     */
+    bool due(long long step) const { return step % every == 0; }
+
+    /**
+     * @brief Run thread: publishes the state at the end of a step.
+     *
+     * @param step Number of steps executed.
+     * @param time Simulation time reached.
+     * @param status Run status.
+     * @param vehicles Vehicle states; the frame shares their columns.
+     */
+    void publish(long long step, double time, const std::string& status, const VehicleStore& vehicles);
+};
+
+/**
+ * @brief A run executing on a background thread, with its control.
+ *
+ * The simulation must stay alive and must not be used by other threads
+ * until wait() returned or the AsyncRun is destroyed. Destroying an
+ * AsyncRun stops the run and joins its thread.
+ */
+class AsyncRun {
+private:
+    RunControl ctrl;             /**< Control shared with the run thread. */
+    RunResult result;            /**< The run's result, written by the run thread before it exits. */
+    std::atomic<bool> done{false}; /**< Set by the run thread when result is ready. */
+    std::thread worker;          /**< The run thread. */
+
+public:
+    /**
+     * @brief Starts the run on a new thread.
+     *
+     * @param sim The simulation to run.
+     * @param options Limits of the run; pacing and printing work as in run().
+     * @param publishEvery Publish a frame every this many steps.
+     * @param startPaused True to start paused.
+     */
+    AsyncRun(Simulation& sim, const RunOptions& options, long long publishEvery = 1, bool startPaused = false);
+
+    /**
+     * @brief Stops the run and joins its thread.
+     */
+    ~AsyncRun();
+
+    AsyncRun(const AsyncRun&) = delete;
+    AsyncRun& operator=(const AsyncRun&) = delete;
+
+    /**
+     * @brief Returns the control of the run.
+     */
+    RunControl& control() { return ctrl; }
+
+    /**
+     * @brief Returns true once the run has ended.
+     */
+    bool finished() const { return done.load(std::memory_order_acquire); }
+
+    /**
+     * @brief Waits for the run to end and returns its result.
+     */
+    const RunResult& wait();
+};
+
+#endif // ASYNCRUN_H
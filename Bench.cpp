@@ -0,0 +1,505 @@
+// VehicleSimBench: times the hot paths of the simulation across fleet sizes
+// and layouts, and reports the results as a table and as JSON.
+//
+// Usage: VehicleSimBench [--max-vehicles N] [--min-vehicles N] [--layout NAME]
+//                        [--threads N] [--fixed-runs N] [--json FILE]
+
+#include "Simulation.h"
+#include "SpatialGrid.h"
+#include "RunLog.h"
+#include "FixedSimulation.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// ---------------------------------------------------------------------------
+// Allocation counting: the bench target is built with VEHICLESIM_COUNT_ALLOCATIONS,
+// so the library's counting operator new is in place. A phase's allocations
+// are the difference of the counters around it.
+
+#if !VEHICLESIM_COUNT_ALLOCATIONS
+#error "VehicleSimBench needs VEHICLESIM_COUNT_ALLOCATIONS (set by its CMake target)"
+#endif
+
+namespace {
+
+/**
+ * @brief Returns the bytes allocated so far by the calling thread.
+ */
+std::uint64_t bytesSoFar() {
+    return RunTelemetry::threadAllocatedBytes();
+}
+
+/**
+ * @brief Returns the number of allocations made so far by the calling thread.
+ */
+std::uint64_t allocationsSoFar() {
+    return RunTelemetry::threadAllocations();
+}
+
+} // namespace
+
+namespace {
+
+/** Simulated steps per measurement aim for at least this many vehicle-steps. */
+const double TARGET_VEHICLE_STEPS = 2e7;
+
+/** Every measurement runs at least this many steps (and collision checks). */
+const int MIN_STEPS = 3;
+
+/** And at most this many, so small fleets finish quickly. */
+const int MAX_STEPS = 2000;
+
+/** Receives replay checksums so the decoding loop cannot be optimized away. */
+volatile double replaySink = 0;
+
+/** Bench settings: 0.1 s steps, 5 m safety distance. */
+const double TIME_STEP = 0.1;
+const double SAFETY = 5.0;
+
+/**
+ * @brief Timing and allocation figures of one measured phase.
+ */
+struct Phase {
+    double seconds = 0;            /**< Wall time spent in the phase. */
+    long long vehicleSteps = 0;    /**< Vehicles times steps processed. */
+    std::uint64_t bytes = 0;       /**< Bytes allocated by the bench thread during the phase. */
+    std::uint64_t allocations = 0; /**< Number of allocations during the phase. */
+    double pairs = 0;              /**< Candidate pairs tested (collision check only). */
+
+    double nsPerVehicleStep() const { return vehicleSteps > 0 ? seconds * 1e9 / vehicleSteps : 0; }
+};
+
+/**
+ * @brief Results of all phases for one layout and fleet size.
+ */
+struct Case {
+    std::string layout;
+    std::size_t vehicles = 0;
+    int steps = 0;
+    Phase step;
+    Phase check;
+    Phase record;
+    Phase replay;
+    std::size_t conflicts = 0;      /**< Conflicts reported by the last collision check. */
+    std::size_t logBytes = 0;       /**< Size of the recorded log. */
+    std::uint64_t peakRss = 0;      /**< Peak resident set size of the process after the case. */
+};
+
+/**
+ * @brief Whole-run throughput of Simulation and FixedSimulation<N> for one small fleet size.
+ */
+struct FixedCase {
+    std::size_t vehicles = 0;
+    long long runs = 0;      /**< Runs timed per kernel. */
+    long long steps = 0;     /**< Steps over all runs of one kernel. */
+    Phase simulation;        /**< Simulation: construct, add the fleet, run. */
+    Phase fixed;             /**< FixedSimulation<N>: construct, run. */
+    bool match = true;       /**< Every scenario ended with the same status, steps, time and conflicts. */
+
+    double runsPerSecond(const Phase& p) const { return p.seconds > 0 ? runs / p.seconds : 0; }
+};
+
+/**
+ * @brief Measures a phase: wall time and allocations around fn().
+ */
+template <typename Fn>
+void measure(Phase& phase, Fn fn) {
+    const std::uint64_t bytes0 = bytesSoFar();
+    const std::uint64_t count0 = allocationsSoFar();
+    auto t0 = std::chrono::steady_clock::now();
+    fn();
+    auto t1 = std::chrono::steady_clock::now();
+    phase.seconds += std::chrono::duration<double>(t1 - t0).count();
+    phase.bytes += bytesSoFar() - bytes0;
+    phase.allocations += allocationsSoFar() - count0;
+}
+
+/**
+ * @brief Returns the peak resident set size of the process in bytes.
+ */
+std::uint64_t peakRss() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) return pmc.PeakWorkingSetSize;
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#ifdef __APPLE__
+    return static_cast<std::uint64_t>(usage.ru_maxrss);
+#else
+    return static_cast<std::uint64_t>(usage.ru_maxrss) * 1024;
+#endif
+#endif
+}
+
+/**
+ * @brief Generates a fleet of n vehicles in the named layout.
+ *
+ * - uniform: random positions and headings over a square with about 50 m
+ *   between neighbours;
+ * - clustered: Gaussian blobs of 200 vehicles spread over a large square,
+ *   so grid cells are unevenly loaded;
+ * - highway: straight lanes 3.5 m apart along x, 30 m headway, alternating
+ *   direction per lane.
+ *
+ * The "lanes" layout uses the highway fleet; runCase() binds it to lanes.
+ */
+std::vector<Vehicle> makeFleet(const std::string& layout, std::size_t n, std::uint64_t seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<Vehicle> fleet;
+    fleet.reserve(n);
+
+    if (layout == "highway" || layout == "lanes") {
+        const std::size_t lanes = std::max<std::size_t>(2, static_cast<std::size_t>(std::sqrt(static_cast<double>(n)) / 8));
+        for (std::size_t i = 0; i < n; i++) {
+            const std::size_t lane = i % lanes;
+            const double x = static_cast<double>(i / lanes) * 30.0 + unit(rng) * 5.0;
+            const double dir = lane % 2 == 0 ? 0.0 : 180.0;
+            fleet.emplace_back(static_cast<int>(i), x, lane * 3.5, 25.0 + unit(rng) * 10.0, dir, 4.0 + unit(rng) * 2.0);
+        }
+    } else if (layout == "clustered") {
+        const std::size_t perCluster = 200;
+        const std::size_t clusters = (n + perCluster - 1) / perCluster;
+        const double side = std::sqrt(static_cast<double>(clusters)) * 2000.0;
+        std::normal_distribution<double> spread(0.0, 150.0);
+        double cx = 0;
+        double cy = 0;
+        for (std::size_t i = 0; i < n; i++) {
+            if (i % perCluster == 0) {
+                cx = unit(rng) * side;
+                cy = unit(rng) * side;
+            }
+            fleet.emplace_back(static_cast<int>(i), cx + spread(rng), cy + spread(rng),
+                               5.0 + unit(rng) * 15.0, unit(rng) * 360.0, 4.0 + unit(rng) * 2.0);
+        }
+    } else {
+        const double side = std::sqrt(static_cast<double>(n)) * 50.0;
+        for (std::size_t i = 0; i < n; i++) {
+            fleet.emplace_back(static_cast<int>(i), unit(rng) * side, unit(rng) * side,
+                               10.0 + unit(rng) * 20.0, unit(rng) * 360.0, 4.0 + unit(rng) * 2.0);
+        }
+    }
+    return fleet;
+}
+
+/**
+ * @brief Counts the candidate pairs the collision check tests for a fleet.
+ *
+ * Uses the same cell size as Simulation::checkCollision(); below its grid
+ * threshold the check tests all pairs. A fleet bound to lanes is only tested
+ * against its lane neighbours.
+ */
+double candidatePairs(const VehicleStore& vehs, const LaneIndex& lanes) {
+    const std::size_t n = vehs.size();
+    if (lanes.boundCount() == n) {
+        double pairs = 0;
+        lanes.forEachNeighborPair([&](std::uint32_t, std::uint32_t) { pairs += 1; });
+        return pairs;
+    }
+    if (n < 64) return n * (n - 1) / 2.0;
+    SpatialGrid grid;
+    const double cell = (vehs.maxLength() + SAFETY + 2 * vehs.maxSpeed() * TIME_STEP) * 1.000001;
+    grid.build(vehs.x().data(), vehs.y().data(), n, cell);
+    double pairs = 0;
+    grid.forEachCandidatePair([&](std::uint32_t, std::uint32_t) {
+        pairs += 1;
+        return false;
+    });
+    return pairs;
+}
+
+/**
+ * @brief Runs all phases for one layout and fleet size.
+ */
+Case runCase(const std::string& layout, std::size_t n, unsigned threads) {
+    Case c;
+    c.layout = layout;
+    c.vehicles = n;
+    c.steps = static_cast<int>(std::min<double>(MAX_STEPS, std::max<double>(MIN_STEPS, TARGET_VEHICLE_STEPS / n)));
+
+    Settings s{TIME_STEP, SAFETY, "m/s", false};
+    s.threadCount = threads;
+    Simulation sim(s);
+    {
+        std::vector<Vehicle> fleet = makeFleet(layout, n, 42);
+        if (layout == "lanes") {
+            // One eastbound lane per highway row, each adjacent to the next
+            RoadNetwork roads;
+            std::string error;
+            int lanes = 0;
+            for (const Vehicle& v : fleet) lanes = std::max(lanes, static_cast<int>(std::lround(v.y / 3.5)) + 1);
+            for (int l = 0; l < lanes; l++) {
+                roads.addLane(l, {-1e3, 1e9}, {l * 3.5, l * 3.5}, error);
+                if (l > 0) roads.setAdjacent(l, l - 1, error);
+            }
+            sim.setRoadNetwork(roads);
+            for (const Vehicle& v : fleet) {
+                sim.addLaneVehicle(v.id, static_cast<int>(std::lround(v.y / 3.5)), v.x + 1e3, v.speed, v.length, error);
+            }
+        } else {
+            sim.addVehicles(fleet);
+        }
+    }
+
+    // step(): integration only, logging disabled
+    RunRecord run;
+    double elapsed = 0;
+    measure(c.step, [&] {
+        for (int k = 0; k < c.steps; k++) sim.publicStep(elapsed, run);
+    });
+    c.step.vehicleSteps = static_cast<long long>(n) * c.steps;
+
+    // checkCollision(): the grid broad phase plus narrow phase on the live store
+    const double pairs = candidatePairs(sim.getVehicleStore(), sim.getLaneIndex());
+    const int checks = std::max(MIN_STEPS, c.steps / 10);
+    std::vector<ConflictEvent> conflicts;
+    measure(c.check, [&] {
+        for (int k = 0; k < checks; k++) conflicts = sim.publicCheckCollision();
+    });
+    c.check.vehicleSteps = static_cast<long long>(n) * checks;
+    c.check.pairs = pairs * checks;
+    c.conflicts = conflicts.size();
+
+    // Log recording: integrate a copy of the store and record every step
+    VehicleStore store = sim.getVehicleStore();
+    RunLog log;
+    double t = 0;
+    for (int k = 0; k < c.steps; k++) {
+        store.integrate(TIME_STEP);
+        t += TIME_STEP;
+        measure(c.record, [&] { log.record(t, store); });
+    }
+    c.record.vehicleSteps = static_cast<long long>(n) * c.steps;
+    c.logBytes = log.byteSize();
+
+    // Replay: decode every logged step in order
+    double checksum = 0;
+    measure(c.replay, [&] {
+        for (const LogEntry& e : log) checksum += e.positions.empty() ? 0 : e.positions.back().x;
+    });
+    c.replay.vehicleSteps = static_cast<long long>(n) * c.steps;
+    replaySink = checksum;
+
+    c.peakRss = peakRss();
+    return c;
+}
+
+/**
+ * @brief Times many short runs of N-vehicle uniform scenarios in Simulation and in FixedSimulation<N>.
+ *
+ * Each run starts from fresh state, as ScenarioBatch does: a new Simulation
+ * gets the fleet and runs for 5 s or until a collision, without history.
+ * The scenarios cycle through a set of seeded fleets; every one of them is
+ * also compared outside the timed loops.
+ */
+template <std::size_t N>
+FixedCase runFixedCase(long long runs) {
+    FixedCase c;
+    c.vehicles = N;
+    c.runs = runs;
+    const Settings s{TIME_STEP, SAFETY, "m/s", false};
+    RunOptions options;
+    options.recordHistory = false;
+
+    std::vector<std::vector<Vehicle>> fleets;
+    for (std::uint64_t seed = 0; seed < 64; seed++) fleets.push_back(makeFleet("uniform", N, 1000 + seed));
+
+    long long steps = 0;
+    measure(c.simulation, [&] {
+        for (long long r = 0; r < runs; r++) {
+            Simulation sim(s);
+            sim.addVehicles(fleets[r % fleets.size()]);
+            steps += sim.run(options).stats.steps;
+        }
+    });
+    c.simulation.vehicleSteps = steps * static_cast<long long>(N);
+    c.steps = steps;
+
+    steps = 0;
+    measure(c.fixed, [&] {
+        for (long long r = 0; r < runs; r++) {
+            FixedSimulation<N> sim(s, fleets[r % fleets.size()].data());
+            steps += sim.run(options.maxSimTime, options.maxSteps).steps;
+        }
+    });
+    c.fixed.vehicleSteps = steps * static_cast<long long>(N);
+    c.match = steps == c.steps;
+
+    for (const std::vector<Vehicle>& fleet : fleets) {
+        Simulation sim(s);
+        sim.addVehicles(fleet);
+        const RunResult expected = sim.run(options);
+        const typename FixedSimulation<N>::Result r = FixedSimulation<N>(s, fleet.data()).run(options.maxSimTime);
+        c.match = c.match && expected.record.status == statusName(r.status) && expected.stats.steps == r.steps &&
+                  expected.stats.simTime == r.simTime && expected.record.conflicts.size() == r.conflictCount;
+    }
+    return c;
+}
+
+/**
+ * @brief Writes one phase as a JSON object.
+ */
+void writePhase(std::ostream& out, const char* name, const Phase& p, bool pairs) {
+    out << "\"" << name << "\": {\"seconds\": " << p.seconds
+        << ", \"nsPerVehicleStep\": " << p.nsPerVehicleStep()
+        << ", \"bytesAllocated\": " << p.bytes
+        << ", \"allocations\": " << p.allocations;
+    if (pairs) {
+        out << ", \"pairsTested\": " << p.pairs
+            << ", \"pairsPerSecond\": " << (p.seconds > 0 ? p.pairs / p.seconds : 0.0);
+    }
+    out << "}";
+}
+
+/**
+ * @brief Writes all cases as a JSON document.
+ */
+void writeJson(std::ostream& out, const std::vector<Case>& cases, const std::vector<FixedCase>& fixedCases,
+               unsigned threads) {
+    out << std::setprecision(6);
+    out << "{\n  \"benchmark\": \"VehicleSimBench\",\n  \"threads\": " << threads << ",\n  \"cases\": [\n";
+    for (std::size_t i = 0; i < cases.size(); i++) {
+        const Case& c = cases[i];
+        out << "    {\"layout\": \"" << c.layout << "\", \"vehicles\": " << c.vehicles
+            << ", \"steps\": " << c.steps << ", \"conflicts\": " << c.conflicts
+            << ", \"logBytes\": " << c.logBytes << ", \"peakRssBytes\": " << c.peakRss << ",\n     ";
+        writePhase(out, "step", c.step, false);
+        out << ",\n     ";
+        writePhase(out, "checkCollision", c.check, true);
+        out << ",\n     ";
+        writePhase(out, "logRecord", c.record, false);
+        out << ",\n     ";
+        writePhase(out, "logReplay", c.replay, false);
+        out << "}" << (i + 1 < cases.size() ? "," : "") << "\n";
+    }
+    out << "  ],\n  \"fixedFleets\": [\n";
+    for (std::size_t i = 0; i < fixedCases.size(); i++) {
+        const FixedCase& c = fixedCases[i];
+        out << "    {\"vehicles\": " << c.vehicles << ", \"runs\": " << c.runs << ", \"steps\": " << c.steps
+            << ", \"match\": " << (c.match ? "true" : "false") << ",\n     \"simulation\": {\"runsPerSecond\": "
+            << c.runsPerSecond(c.simulation) << ", \"nsPerVehicleStep\": " << c.simulation.nsPerVehicleStep()
+            << ", \"allocations\": " << c.simulation.allocations << "},\n     \"fixed\": {\"runsPerSecond\": "
+            << c.runsPerSecond(c.fixed) << ", \"nsPerVehicleStep\": " << c.fixed.nsPerVehicleStep()
+            << ", \"allocations\": " << c.fixed.allocations << "}}" << (i + 1 < fixedCases.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+void usage() {
+    std::cout << "Usage: VehicleSimBench [--max-vehicles N] [--min-vehicles N] [--layout uniform|clustered|highway|lanes]\n"
+              << "                       [--threads N] [--fixed-runs N] [--json FILE]\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::size_t minVehicles = 10;
+    std::size_t maxVehicles = 10000000;
+    std::vector<std::string> layouts = {"uniform", "clustered", "highway", "lanes"};
+    unsigned threads = 1;
+    long long fixedRuns = 20000;
+    std::string jsonPath;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--max-vehicles" && hasValue) {
+            maxVehicles = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--min-vehicles" && hasValue) {
+            minVehicles = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--layout" && hasValue) {
+            layouts = {argv[++i]};
+        } else if (arg == "--threads" && hasValue) {
+            threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (arg == "--fixed-runs" && hasValue) {
+            fixedRuns = std::strtoll(argv[++i], nullptr, 10);
+        } else if (arg == "--json" && hasValue) {
+            jsonPath = argv[++i];
+        } else {
+            usage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+    minVehicles = std::max<std::size_t>(2, minVehicles);
+    for (const auto& l : layouts) {
+        if (l != "uniform" && l != "clustered" && l != "highway" && l != "lanes") {
+            usage();
+            return 1;
+        }
+    }
+
+    std::vector<Case> cases;
+    std::cout << std::left << std::setw(10) << "layout" << std::right << std::setw(10) << "vehicles"
+              << std::setw(8) << "steps" << std::setw(12) << "step ns/v" << std::setw(12) << "check ns/v"
+              << std::setw(12) << "Mpairs/s" << std::setw(12) << "record ns/v" << std::setw(12) << "replay ns/v"
+              << std::setw(12) << "log MB" << std::setw(12) << "peak MB" << "\n";
+    for (std::size_t n = minVehicles; n <= maxVehicles; n *= 10) {
+        for (const auto& layout : layouts) {
+            Case c = runCase(layout, n, threads);
+            std::cout << std::left << std::setw(10) << c.layout << std::right << std::setw(10) << c.vehicles
+                      << std::setw(8) << c.steps << std::fixed << std::setprecision(2)
+                      << std::setw(12) << c.step.nsPerVehicleStep()
+                      << std::setw(12) << c.check.nsPerVehicleStep()
+                      << std::setw(12) << (c.check.seconds > 0 ? c.check.pairs / c.check.seconds / 1e6 : 0.0)
+                      << std::setw(12) << c.record.nsPerVehicleStep()
+                      << std::setw(12) << c.replay.nsPerVehicleStep()
+                      << std::setw(12) << c.logBytes / 1048576.0
+                      << std::setw(12) << c.peakRss / 1048576.0 << "\n" << std::defaultfloat << std::flush;
+            cases.push_back(c);
+        }
+        if (n > maxVehicles / 10) break;
+    }
+
+    // Small fleets run whole: Simulation against the fixed-size kernel
+    std::vector<FixedCase> fixedCases;
+    if (fixedRuns > 0) {
+        fixedCases = {runFixedCase<2>(fixedRuns), runFixedCase<4>(fixedRuns), runFixedCase<8>(fixedRuns),
+                      runFixedCase<16>(fixedRuns)};
+        std::cout << "\n" << std::right << std::setw(10) << "vehicles" << std::setw(10) << "runs"
+                  << std::setw(14) << "sim runs/s" << std::setw(14) << "fixed runs/s" << std::setw(10) << "speedup"
+                  << std::setw(12) << "sim allocs" << std::setw(14) << "fixed allocs" << std::setw(8) << "match" << "\n";
+        for (const FixedCase& c : fixedCases) {
+            const double sim = c.runsPerSecond(c.simulation);
+            const double fixed = c.runsPerSecond(c.fixed);
+            std::cout << std::setw(10) << c.vehicles << std::setw(10) << c.runs << std::fixed << std::setprecision(0)
+                      << std::setw(14) << sim << std::setw(14) << fixed << std::setprecision(2)
+                      << std::setw(10) << (sim > 0 ? fixed / sim : 0.0) << std::defaultfloat
+                      << std::setw(12) << c.simulation.allocations << std::setw(14) << c.fixed.allocations
+                      << std::setw(8) << (c.match ? "yes" : "NO") << "\n";
+        }
+    }
+
+    if (!jsonPath.empty()) {
+        if (jsonPath == "-") {
+            writeJson(std::cout, cases, fixedCases, threads);
+        } else {
+            std::ofstream out(jsonPath);
+            if (!out) {
+                std::cout << "Cannot write " << jsonPath << "\n";
+                return 1;
+            }
+            writeJson(out, cases, fixedCases, threads);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,52 @@
+#ifndef CLOSESTAPPROACH_H
+#define CLOSESTAPPROACH_H
+
+#include <algorithm>
+#include <cstddef>
+
+/**
+ * @brief Closest approach of a vehicle pair within the step that just ended.
+ */
+struct Approach {
+    double tau;    /**< Offset of the closest approach from the end of the step (in [-dt, 0]). */
+    double endSq;  /**< Squared distance at the end of the step. */
+    double minSq;  /**< Squared distance at the closest approach. */
+};
+
+/**
+ * @brief Computes the closest approach of vehicles i and j over the last dt seconds.
+ *
+ * Both vehicles are moved back along their velocities: their separation at
+ * offset tau is d + w * tau with d the current separation and w the relative
+ * velocity, which is minimised at tau = -(d.w) / (w.w), clamped to the step.
+ */
+inline Approach closestApproach(const double* xs, const double* ys,
+                                const double* vxs, const double* vys,
+                                std::size_t i, std::size_t j, double dt) {
+    double dx = xs[i] - xs[j];
+    double dy = ys[i] - ys[j];
+    double wx = vxs[i] - vxs[j];
+    double wy = vys[i] - vys[j];
+    double ww = wx * wx + wy * wy;
+    double tau = 0.0;
+    if (ww > 0) {
+        tau = -(dx * wx + dy * wy) / ww;
+        tau = std::min(0.0, std::max(-dt, tau));
+    }
+    double cx = dx + wx * tau;
+    double cy = dy + wy * tau;
+    return Approach{tau, dx * dx + dy * dy, cx * cx + cy * cy};
+}
+
+/**
+ * @brief Narrow-phase test shared by every collision check.
+ *
+ * Compares squared distances so no square root is needed per pair.
+ */
+inline bool inDanger(const double* xs, const double* ys, const double* vxs, const double* vys,
+                     const double* lens, std::size_t i, std::size_t j, double safetyDistance, double dt) {
+    double minDist = std::max(lens[i], lens[j]) + safetyDistance;
+    return minDist >= 0 && closestApproach(xs, ys, vxs, vys, i, j, dt).minSq <= minDist * minDist;
+}
+
+#endif // CLOSESTAPPROACH_H
@@ -0,0 +1,124 @@
+#include "ContactSchedule.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+/**
+ * @brief Orders events so the heap's front is the earliest step, then the smallest pair.
+ */
+struct Later {
+    bool operator()(const ContactEvent& a, const ContactEvent& b) const {
+        if (a.step != b.step) return a.step > b.step;
+        if (a.i != b.i) return a.i > b.i;
+        return a.j > b.j;
+    }
+};
+
+} // namespace
+
+/**
+ * @brief Replaces the queue with the contacts due within a window of steps.
+ *
+ * Candidate pairs are those whose swept boxes overlap: the boxes are sorted by
+ * left edge and each one is compared with the following boxes that start
+ * before it ends. For a candidate with separation d and relative velocity w,
+ * |d + w s| <= R is a quadratic inequality in the offset s; its smaller root
+ * is the contact time and its larger root the time the pair separates. A
+ * contact at time t can first be seen by the check of step floor(t / dt) + 1,
+ * or of step floor(t / dt) when t falls on a step boundary, so the event is
+ * queued at the earlier of the two and the simulation re-queues it for the
+ * following step while the pair is still in contact.
+ *
+ * @param vehs The vehicles, at the positions of step `step`.
+ * @param safetyDistance Safety distance added to the larger vehicle length.
+ * @param dt Length of one step in seconds.
+ * @param step Index of the current step; the window starts at its time.
+ * @param lastStep Last step of the window.
+ */
+void ContactSchedule::build(const VehicleStore& vehs, double safetyDistance, double dt, long long step,
+                            long long lastStep) {
+    heap.clear();
+    sweeps.clear();
+    candidates = 0;
+    const std::size_t n = vehs.size();
+    const double pad = (vehs.maxLength() + safetyDistance) / 2;
+    if (n < 2 || pad < 0 || !(dt > 0) || lastStep <= step) return;
+
+    const double window = static_cast<double>(lastStep - step) * dt;
+    const double* xs = vehs.x().data();
+    const double* ys = vehs.y().data();
+    const double* vxs = vehs.vx().data();
+    const double* vys = vehs.vy().data();
+    const double* lens = vehs.length().data();
+
+    sweeps.reserve(n);
+    for (std::size_t i = 0; i < n; i++) {
+        const double x1 = xs[i] + vxs[i] * window;
+        const double y1 = ys[i] + vys[i] * window;
+        sweeps.push_back(Sweep{std::min(xs[i], x1) - pad, std::max(xs[i], x1) + pad,
+                               std::min(ys[i], y1) - pad, std::max(ys[i], y1) + pad,
+                               static_cast<std::uint32_t>(i)});
+    }
+    std::sort(sweeps.begin(), sweeps.end(), [](const Sweep& a, const Sweep& b) {
+        return a.minX < b.minX || (a.minX == b.minX && a.index < b.index);
+    });
+
+    const double start = static_cast<double>(step) * dt;
+    for (std::size_t a = 0; a < n; a++) {
+        const Sweep& sa = sweeps[a];
+        for (std::size_t b = a + 1; b < n && sweeps[b].minX <= sa.maxX; b++) {
+            const Sweep& sb = sweeps[b];
+            if (sb.minY > sa.maxY || sb.maxY < sa.minY) continue;
+            candidates++;
+
+            const std::uint32_t i = std::min(sa.index, sb.index);
+            const std::uint32_t j = std::max(sa.index, sb.index);
+            const double reach = std::max(lens[i], lens[j]) + safetyDistance;
+            if (reach < 0) continue;
+            const double dx = xs[i] - xs[j];
+            const double dy = ys[i] - ys[j];
+            const double wx = vxs[i] - vxs[j];
+            const double wy = vys[i] - vys[j];
+            const double ww = wx * wx + wy * wy;
+            const double dw = dx * wx + dy * wy;
+            const double c = dx * dx + dy * dy - reach * reach;
+            const double disc = dw * dw - ww * c;
+
+            double enter;
+            double exit = std::numeric_limits<double>::infinity();
+            if (c <= 0) {
+                enter = 0;
+                if (ww > 0) exit = (-dw + std::sqrt(std::max(0.0, disc))) / ww;
+            } else {
+                if (!(ww > 0) || disc < 0) continue;
+                enter = (-dw - std::sqrt(disc)) / ww;
+                exit = (-dw + std::sqrt(disc)) / ww;
+                if (enter < 0 || enter > window) continue;
+            }
+            const long long due = std::max(step + 1, step + static_cast<long long>(std::floor(enter / dt)));
+            if (due > lastStep) continue;
+            heap.push_back(ContactEvent{due, i, j, start + exit});
+        }
+    }
+    std::make_heap(heap.begin(), heap.end(), Later());
+}
+
+/**
+ * @brief Removes and returns the earliest queued contact. The queue must not be empty.
+ */
+ContactEvent ContactSchedule::pop() {
+    std::pop_heap(heap.begin(), heap.end(), Later());
+    ContactEvent e = heap.back();
+    heap.pop_back();
+    return e;
+}
+
+/**
+ * @brief Queues a contact.
+ */
+void ContactSchedule::push(const ContactEvent& e) {
+    heap.push_back(e);
+    std::push_heap(heap.begin(), heap.end(), Later());
+}
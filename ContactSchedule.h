@@ -0,0 +1,88 @@
+#ifndef CONTACTSCHEDULE_H
+#define CONTACTSCHEDULE_H
+
+#include "VehicleStore.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief A predicted contact of one vehicle pair, due at a given step.
+ */
+struct ContactEvent {
+    long long step;     /**< Step whose collision check may first see the contact. */
+    std::uint32_t i;    /**< Store index of the first vehicle (the smaller index). */
+    std::uint32_t j;    /**< Store index of the second vehicle. */
+    double exitTime;    /**< Simulation time at which the pair separates again. */
+};
+
+/**
+ * @brief Priority queue of predicted pair contacts for event-driven runs.
+ *
+ * Vehicles move at constant velocity, so the earliest time two of them come
+ * within their danger distance (the larger length plus the safety distance)
+ * can be solved for directly. build() finds the candidate pairs for a time
+ * window with a sweep-and-prune over the boxes each vehicle sweeps during the
+ * window, solves the contact time of each candidate and queues the pairs that
+ * touch within the window, ordered by step. A simulation can then jump from
+ * one queued step to the next instead of checking every step in between.
+ *
+ * Events are ordered by step and then by store indices, so the schedule is
+ * deterministic. Its buffers are reused between builds.
+ */
+class ContactSchedule {
+private:
+    /**
+     * @brief The box one vehicle sweeps during the window.
+     */
+    struct Sweep {
+        double minX;           /**< Left edge, padded by half the largest danger distance. */
+        double maxX;           /**< Right edge, padded likewise. */
+        double minY;           /**< Bottom edge, padded likewise. */
+        double maxY;           /**< Top edge, padded likewise. */
+        std::uint32_t index;   /**< Store index of the vehicle. */
+    };
+
+    std::vector<Sweep> sweeps;         /**< Swept boxes sorted by left edge. */
+    std::vector<ContactEvent> heap;    /**< Queued events, a min-heap by (step, i, j). */
+    std::size_t candidates = 0;        /**< Candidate pairs tested by the last build(). */
+
+public:
+    /**
+     * @brief Replaces the queue with the contacts due within a window of steps.
+     *
+     * @param vehs The vehicles, at the positions of step `step`.
+     * @param safetyDistance Safety distance added to the larger vehicle length.
+     * @param dt Length of one step in seconds.
+     * @param step Index of the current step; the window starts at its time.
+     * @param lastStep Last step of the window.
+     */
+    void build(const VehicleStore& vehs, double safetyDistance, double dt, long long step, long long lastStep);
+
+    /**
+     * @brief Returns true if no contact is queued.
+     */
+    bool empty() const { return heap.empty(); }
+
+    /**
+     * @brief Returns the step of the earliest queued contact. The queue must not be empty.
+     */
+    long long nextStep() const { return heap.front().step; }
+
+    /**
+     * @brief Removes and returns the earliest queued contact. The queue must not be empty.
+     */
+    ContactEvent pop();
+
+    /**
+     * @brief Queues a contact.
+     */
+    void push(const ContactEvent& e);
+
+    /**
+     * @brief Returns the number of candidate pairs tested by the last build().
+     */
+    std::size_t candidatePairs() const { return candidates; }
+};
+
+#endif // CONTACTSCHEDULE_H
@@ -0,0 +1,153 @@
+#include "CsvImporter.h"
+#include "Simulation.h"
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <climits>
+#include <cstdlib>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+/** Column names in the order used when the file has no header. */
+const char* const COLUMN_NAMES[6] = {"id", "x", "y", "speed", "direction", "length"};
+
+/**
+ * @brief Splits a line on commas into trimmed fields, reusing the output vector.
+ */
+void splitFields(const std::string& line, std::vector<std::string>& fields) {
+    fields.clear();
+    std::size_t start = 0;
+    while (true) {
+        std::size_t comma = line.find(',', start);
+        std::size_t end = comma == std::string::npos ? line.size() : comma;
+        std::size_t b = start;
+        std::size_t e = end;
+        while (b < e && std::isspace(static_cast<unsigned char>(line[b]))) b++;
+        while (e > b && std::isspace(static_cast<unsigned char>(line[e - 1]))) e--;
+        fields.emplace_back(line, b, e - b);
+        if (comma == std::string::npos) break;
+        start = comma + 1;
+    }
+}
+
+/**
+ * @brief Parses a whole field as a double.
+ */
+bool parseNumber(const std::string& field, double& value) {
+    if (field.empty()) return false;
+    char* end = nullptr;
+    errno = 0;
+    value = std::strtod(field.c_str(), &end);
+    return errno == 0 && end == field.c_str() + field.size();
+}
+
+/**
+ * @brief Parses a whole field as a decimal integer that fits an int.
+ */
+bool parseId(const std::string& field, int& value) {
+    if (field.empty()) return false;
+    char* end = nullptr;
+    errno = 0;
+    const long v = std::strtol(field.c_str(), &end, 10);
+    if (errno != 0 || end != field.c_str() + field.size() || v < INT_MIN || v > INT_MAX) return false;
+    value = static_cast<int>(v);
+    return true;
+}
+
+std::string lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return s;
+}
+
+} // namespace
+
+/**
+ * @brief Imports all vehicles of a CSV file into a simulation.
+ *
+ * @param path Path of the CSV file.
+ * @param sim The simulation to add the vehicles to.
+ * @param error Receives a description of the failure (with line number), if any.
+ * @param imported Receives the number of vehicles added, if not null.
+ * @return true on success, false otherwise.
+ */
+bool CsvImporter::importVehicles(const std::string& path, Simulation& sim, std::string& error,
+                                 std::size_t* imported) {
+    std::ifstream in(path);
+    if (imported) *imported = 0;
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    std::size_t columnOf[6] = {0, 1, 2, 3, 4, 5};
+    std::size_t requiredFields = 6;
+    bool sawFirstRow = false;
+    std::size_t total = 0;
+    std::size_t lineNo = 0;
+    std::string line;
+    std::vector<std::string> fields;
+    std::vector<Vehicle> batch;
+    batch.reserve(BATCH_SIZE);
+
+    while (std::getline(in, line)) {
+        lineNo++;
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        std::size_t first = line.find_first_not_of(" \t");
+        if (first == std::string::npos || line[first] == '#') continue;
+
+        splitFields(line, fields);
+        double values[6];
+        if (!sawFirstRow) {
+            sawFirstRow = true;
+            double probe;
+            if (!parseNumber(fields[0], probe)) {
+                // Header row: map each expected column to its position
+                for (std::size_t c = 0; c < 6; c++) {
+                    auto it = std::find_if(fields.begin(), fields.end(), [c](const std::string& f) {
+                        return lower(f) == COLUMN_NAMES[c];
+                    });
+                    if (it == fields.end()) {
+                        error = path + ":" + std::to_string(lineNo) + ": missing column '" + COLUMN_NAMES[c] + "'";
+                        sim.addVehicles(batch);
+                        return false;
+                    }
+                    columnOf[c] = static_cast<std::size_t>(it - fields.begin());
+                }
+                requiredFields = *std::max_element(columnOf, columnOf + 6) + 1;
+                continue;
+            }
+        }
+
+        if (fields.size() < requiredFields) {
+            error = path + ":" + std::to_string(lineNo) + ": expected " + std::to_string(requiredFields) + " fields";
+            sim.addVehicles(batch);
+            if (imported) *imported = total + batch.size();
+            return false;
+        }
+        int id = 0;
+        for (std::size_t c = 0; c < 6; c++) {
+            const bool ok = c == 0 ? parseId(fields[columnOf[c]], id) : parseNumber(fields[columnOf[c]], values[c]);
+            if (!ok) {
+                error = path + ":" + std::to_string(lineNo) + ": invalid " + COLUMN_NAMES[c] +
+                        " '" + fields[columnOf[c]] + "'";
+                sim.addVehicles(batch);
+                if (imported) *imported = total + batch.size();
+                return false;
+            }
+        }
+
+        batch.emplace_back(id, values[1], values[2], values[3], values[4], values[5]);
+        if (batch.size() == BATCH_SIZE) {
+            sim.addVehicles(batch);
+            total += batch.size();
+            batch.clear();
+        }
+    }
+
+    sim.addVehicles(batch);
+    total += batch.size();
+    if (imported) *imported = total;
+    return true;
+}
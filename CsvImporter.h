@@ -0,0 +1,41 @@
+#ifndef CSVIMPORTER_H
+#define CSVIMPORTER_H
+
+#include <string>
+#include <cstddef>
+
+class Simulation;
+
+/**
+ * @brief Streaming CSV importer for vehicle tables.
+ *
+ * Expected columns are id, x, y, speed, direction and length. If the first
+ * non-comment line is a header naming those columns (in any order, any case),
+ * columns are matched by name and extra columns are ignored; otherwise the
+ * six columns are read in that order. Blank lines and lines starting with '#'
+ * are skipped. IDs must be decimal integers in the range of int.
+ *
+ * The file is read line by line and vehicles are handed to the simulation in
+ * fixed-size batches, so memory use does not depend on the file size.
+ */
+class CsvImporter {
+public:
+    /** Number of rows parsed before they are added to the simulation in one batch. */
+    static const std::size_t BATCH_SIZE = 65536;
+
+    /**
+     * @brief Imports all vehicles of a CSV file into a simulation.
+     *
+     * Rows parsed before an error are kept in the simulation.
+     *
+     * @param path Path of the CSV file.
+     * @param sim The simulation to add the vehicles to.
+     * @param error Receives a description of the failure (with line number), if any.
+     * @param imported Receives the number of vehicles added, if not null.
+     * @return true on success, false otherwise.
+     */
+    static bool importVehicles(const std::string& path, Simulation& sim, std::string& error,
+                               std::size_t* imported = nullptr);
+};
+
+#endif // CSVIMPORTER_H
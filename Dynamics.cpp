@@ -0,0 +1,62 @@
+#include "Dynamics.h"
+
+const bool ConstantVelocity::TURNS;
+const bool ConstantAcceleration::TURNS;
+const bool IntelligentDriver::TURNS;
+constexpr double IntelligentDriver::TINY_GAP;
+
+/**
+ * @brief Checks that the parameters describe a valid model.
+ *
+ * @param p The parameters to check.
+ * @param error Receives a description of the problem, if any.
+ * @return true if v0, a and b are positive and T and s0 are not negative.
+ */
+bool IntelligentDriver::validate(const Params& p, std::string& error) {
+    if (!(p.desiredSpeed > 0) || !(p.maxAcceleration > 0) || !(p.comfortableDeceleration > 0)) {
+        error = "IDM desired speed, acceleration and deceleration must be positive";
+        return false;
+    }
+    if (!(p.timeHeadway >= 0) || !(p.minGap >= 0)) {
+        error = "IDM time headway and minimum gap must not be negative";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Removes all vehicles from every batch.
+ */
+void VehicleDynamics::clear() {
+    accelerating.clear();
+    following.clear();
+}
+
+/**
+ * @brief Drops a vehicle the store removes by swap-and-pop, and renumbers the store's last vehicle.
+ *
+ * @param vehicle Store index of the removed vehicle.
+ * @param last Store index of the last vehicle, which moves to vehicle.
+ */
+void VehicleDynamics::remove(std::uint32_t vehicle, std::uint32_t last) {
+    accelerating.remove(vehicle, last);
+    following.remove(vehicle, last);
+}
+
+/**
+ * @brief Updates the speed and heading of all modelled vehicles for a step of dt seconds.
+ *
+ * Each batch runs its own specialized loops. Every batch computes its
+ * accelerations before any batch changes a speed, so a follower reacts to its
+ * leader's speed at the start of the step whatever model the leader uses.
+ *
+ * @param vehs The store holding the vehicles.
+ * @param lanes The lane order of the store's vehicles.
+ * @param dt The length of the step in seconds.
+ */
+void VehicleDynamics::step(VehicleStore& vehs, const LaneIndex& lanes, double dt) {
+    accelerating.accelerate(vehs, lanes);
+    following.accelerate(vehs, lanes);
+    accelerating.apply(vehs, dt);
+    following.apply(vehs, dt);
+}
@@ -0,0 +1,277 @@
+#ifndef DYNAMICS_H
+#define DYNAMICS_H
+
+#include "VehicleStore.h"
+#include "LaneIndex.h"
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+
+/**
+ * @brief What a dynamics model may read when computing an acceleration.
+ */
+struct DynamicsContext {
+    const double* speeds;   /**< Speed column of the store. */
+    const double* lengths;  /**< Length column of the store. */
+    const LaneIndex& lanes; /**< Lane order, for car-following models. */
+};
+
+/**
+ * @brief Dynamics policy: constant speed and heading (the default for vehicles without a model).
+ */
+struct ConstantVelocity {
+    /** No parameters. */
+    struct Params {};
+
+    /** The model never changes the heading. */
+    static const bool TURNS = false;
+
+    static double acceleration(const Params&, const DynamicsContext&, std::uint32_t) { return 0.0; }
+    static double yawRate(const Params&) { return 0.0; }
+};
+
+/**
+ * @brief Dynamics policy: constant longitudinal acceleration and yaw rate.
+ */
+struct ConstantAcceleration {
+    /**
+     * @brief Per-vehicle parameters.
+     */
+    struct Params {
+        double acceleration = 0.0; /**< Longitudinal acceleration in m/s^2 (negative to brake). */
+        double yawRate = 0.0;      /**< Turn rate in degrees per second (positive turns left). */
+    };
+
+    /** The model may change the heading. */
+    static const bool TURNS = true;
+
+    static double acceleration(const Params& p, const DynamicsContext&, std::uint32_t) { return p.acceleration; }
+    static double yawRate(const Params& p) { return p.yawRate; }
+};
+
+/**
+ * @brief Dynamics policy: Intelligent Driver Model car-following.
+ *
+ * The acceleration is a * (1 - (v / v0)^4 - (s* / s)^2), with the desired
+ * gap s* = s0 + max(0, v T + v dv / (2 sqrt(a b))), where s is the gap to the
+ * leader and dv the speed difference to it. The leader is the next vehicle in
+ * the lane index; a vehicle without one (the front of a lane, or a
+ * free-space vehicle) accelerates towards its desired speed.
+ */
+struct IntelligentDriver {
+    /**
+     * @brief Per-vehicle parameters.
+     */
+    struct Params {
+        double desiredSpeed = 30.0;          /**< v0: speed on a free road in m/s. */
+        double timeHeadway = 1.5;            /**< T: desired time gap to the leader in seconds. */
+        double maxAcceleration = 1.0;        /**< a: maximum acceleration in m/s^2. */
+        double comfortableDeceleration = 2.0; /**< b: comfortable deceleration in m/s^2. */
+        double minGap = 2.0;                 /**< s0: bumper-to-bumper gap kept when standing, in meters. */
+    };
+
+    /** The model never changes the heading. */
+    static const bool TURNS = false;
+
+    /** Gaps are clamped to this many meters so overlapping vehicles brake hard instead of dividing by zero. */
+    static constexpr double TINY_GAP = 0.01;
+
+    /**
+     * @brief Checks that the parameters describe a valid model.
+     *
+     * @param p The parameters to check.
+     * @param error Receives a description of the problem, if any.
+     * @return true if v0, a and b are positive and T and s0 are not negative.
+     */
+    static bool validate(const Params& p, std::string& error);
+
+    static double acceleration(const Params& p, const DynamicsContext& c, std::uint32_t v) {
+        const double speed = c.speeds[v];
+        const double ratio = speed / p.desiredSpeed;
+        const double free = 1.0 - ratio * ratio * ratio * ratio;
+        const std::uint32_t leader = c.lanes.leaderOf(v);
+        if (leader == LaneIndex::NO_VEHICLE) return p.maxAcceleration * free;
+
+        const double gap = std::max(TINY_GAP, c.lanes.arcOf(leader) - c.lanes.arcOf(v) -
+                                              (c.lengths[leader] + c.lengths[v]) / 2);
+        const double dv = speed - c.speeds[leader];
+        const double desired = p.minGap + std::max(0.0, speed * p.timeHeadway +
+            speed * dv / (2 * std::sqrt(p.maxAcceleration * p.comfortableDeceleration)));
+        const double q = desired / gap;
+        return p.maxAcceleration * (free - q * q);
+    }
+
+    static double yawRate(const Params&) { return 0.0; }
+};
+
+/**
+ * @brief The vehicles driven by one dynamics model, with their parameters.
+ *
+ * The model is a policy type providing Params, TURNS, acceleration() and
+ * yawRate(); accelerate() and apply() are instantiated per model, so their
+ * inner loops call the model directly and the compiler inlines it, with no
+ * per-vehicle dispatch. A step is split in two so that every batch computes
+ * its accelerations from the state at the start of the step before any speed
+ * changes; car-following then depends neither on the order of the vehicles
+ * in a batch nor on the order of the batches.
+ */
+template <typename Model>
+class DynamicsBatch {
+private:
+    static constexpr std::uint32_t NONE = 0xFFFFFFFFu; /**< Marks a store index that is not in the batch. */
+
+    std::vector<std::uint32_t> vehicles;          /**< Store indices of the batch's vehicles. */
+    std::vector<typename Model::Params> params;   /**< Parameters of each vehicle. */
+    std::vector<std::uint32_t> positionOf;        /**< Position in the batch of each store index, or NONE. */
+    std::vector<double> accelerations;            /**< Scratch: acceleration of each vehicle in the current step. */
+
+public:
+    /**
+     * @brief Adds a vehicle to the batch.
+     *
+     * @param vehicle Store index of the vehicle.
+     * @param p The vehicle's parameters.
+     */
+    void add(std::uint32_t vehicle, const typename Model::Params& p) {
+        if (vehicle >= positionOf.size()) positionOf.resize(vehicle + 1, NONE);
+        positionOf[vehicle] = static_cast<std::uint32_t>(vehicles.size());
+        vehicles.push_back(vehicle);
+        params.push_back(p);
+    }
+
+    /**
+     * @brief Drops a vehicle the store removes by swap-and-pop, and renumbers the store's last vehicle.
+     *
+     * O(1): the batch's own last entry fills the gap. Accelerations are
+     * computed from the state at the start of a step, so the order of the
+     * batch does not matter.
+     *
+     * @param vehicle Store index of the removed vehicle.
+     * @param last Store index of the last vehicle, which moves to vehicle.
+     */
+    void remove(std::uint32_t vehicle, std::uint32_t last) {
+        if (vehicle < positionOf.size() && positionOf[vehicle] != NONE) {
+            const std::uint32_t k = positionOf[vehicle];
+            const std::uint32_t moved = vehicles.back();
+            vehicles[k] = moved;
+            params[k] = params.back();
+            vehicles.pop_back();
+            params.pop_back();
+            if (moved != vehicle) positionOf[moved] = k;
+            positionOf[vehicle] = NONE;
+        }
+        if (last != vehicle && last < positionOf.size() && positionOf[last] != NONE) {
+            const std::uint32_t k = positionOf[last];
+            vehicles[k] = vehicle;
+            positionOf[vehicle] = k;
+            positionOf[last] = NONE;
+        }
+        if (positionOf.size() > last) positionOf.resize(last);
+    }
+
+    /**
+     * @brief Returns the number of vehicles in the batch.
+     */
+    std::size_t size() const { return vehicles.size(); }
+
+    /**
+     * @brief Removes all vehicles.
+     */
+    void clear() {
+        vehicles.clear();
+        params.clear();
+        positionOf.clear();
+    }
+
+    /**
+     * @brief Computes the acceleration of each of the batch's vehicles from the store's current state.
+     *
+     * Nothing in the store changes; apply() then uses the results.
+     *
+     * @param vehs The store holding the vehicles.
+     * @param lanes The lane order of the store's vehicles.
+     */
+    void accelerate(const VehicleStore& vehs, const LaneIndex& lanes) {
+        const std::size_t n = vehicles.size();
+        accelerations.resize(n);
+        if (n == 0) return;
+        const DynamicsContext context{vehs.speed().data(), vehs.length().data(), lanes};
+        for (std::size_t k = 0; k < n; k++) {
+            accelerations[k] = Model::acceleration(params[k], context, vehicles[k]);
+        }
+    }
+
+    /**
+     * @brief Updates the speed and heading of the batch's vehicles for a step of dt seconds.
+     *
+     * Uses the accelerations of the last accelerate() call. Braking never
+     * reverses a vehicle: a speed that would cross zero stops at zero.
+     *
+     * @param vehs The store holding the vehicles.
+     * @param dt The length of the step in seconds.
+     */
+    void apply(VehicleStore& vehs, double dt) {
+        const std::size_t n = vehicles.size();
+        const double* speeds = vehs.speed().data();
+        const double* directions = vehs.direction().data();
+        for (std::size_t k = 0; k < n; k++) {
+            const std::uint32_t v = vehicles[k];
+            const double a = accelerations[k];
+            double speed = speeds[v] + a * dt;
+            if (a < 0 && speeds[v] >= 0 && speed < 0) speed = 0;
+            const double yaw = Model::yawRate(params[k]);
+            if (Model::TURNS && yaw != 0) {
+                vehs.setVelocity(v, speed, directions[v] + yaw * dt);
+            } else if (speed != speeds[v]) {
+                vehs.setSpeed(v, speed);
+            }
+        }
+    }
+};
+
+/**
+ * @brief The dynamics of a simulation's vehicles, batched by model.
+ *
+ * Vehicles without a model keep a constant velocity and cost nothing per step.
+ */
+class VehicleDynamics {
+private:
+    DynamicsBatch<ConstantAcceleration> accelerating; /**< Vehicles with constant acceleration and yaw rate. */
+    DynamicsBatch<IntelligentDriver> following;       /**< Car-following vehicles. */
+
+public:
+    void add(std::uint32_t vehicle, const ConstantAcceleration::Params& p) { accelerating.add(vehicle, p); } /**< @brief Adds a constant-acceleration vehicle. */
+    void add(std::uint32_t vehicle, const IntelligentDriver::Params& p) { following.add(vehicle, p); }      /**< @brief Adds a car-following vehicle. */
+
+    /**
+     * @brief Drops a vehicle the store removes by swap-and-pop, and renumbers the store's last vehicle.
+     *
+     * @param vehicle Store index of the removed vehicle.
+     * @param last Store index of the last vehicle, which moves to vehicle.
+     */
+    void remove(std::uint32_t vehicle, std::uint32_t last);
+
+    /**
+     * @brief Returns true if every vehicle has constant velocity.
+     */
+    bool empty() const { return accelerating.size() == 0 && following.size() == 0; }
+
+    /**
+     * @brief Removes all vehicles from every batch.
+     */
+    void clear();
+
+    /**
+     * @brief Updates the speed and heading of all modelled vehicles for a step of dt seconds.
+     *
+     * @param vehs The store holding the vehicles.
+     * @param lanes The lane order of the store's vehicles.
+     * @param dt The length of the step in seconds.
+     */
+    void step(VehicleStore& vehs, const LaneIndex& lanes, double dt);
+};
+
+#endif // DYNAMICS_H
@@ -0,0 +1,202 @@
+#ifndef FIXEDSIMULATION_H
+#define FIXEDSIMULATION_H
+
+#include "Simulation.h"
+#include "ClosestApproach.h"
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+
+/**
+ * @brief Outcome of a run, as an enum instead of Simulation's status strings.
+ */
+enum class RunStatus {
+    Running,   /**< The run has not ended. */
+    Collision, /**< A pair came within its danger distance. */
+    Stopped,   /**< The time or step limit was reached. */
+    Unbounded  /**< Neither a time nor a step limit was set, so the run was not executed. */
+};
+
+/**
+ * @brief Returns the status string Simulation uses for a status.
+ */
+inline const char* statusName(RunStatus s) {
+    switch (s) {
+    case RunStatus::Collision: return "Collision";
+    case RunStatus::Stopped: return "Stopped";
+    case RunStatus::Unbounded: return "Unbounded";
+    default: return "Running";
+    }
+}
+
+/**
+ * @brief A free-space, constant-velocity simulation of exactly N vehicles, sized at compile time.
+ *
+ * For tiny scenarios evaluated many times, Simulation's dynamic storage and
+ * general loops cost more than the physics. Here the vehicles live in
+ * std::array columns, the N(N-1)/2 pair tests are unrolled at compile time,
+ * and a run allocates nothing: the result, its conflicts included, is a
+ * fixed-size value.
+ *
+ * A run gives the same status, step count, time, conflicts and final
+ * positions as Simulation::run() with the same settings, vehicles and limits,
+ * bit for bit: it uses the same velocity caching, integration and narrow
+ * phase, in the same order (with the project's -ffp-contract=off, so no
+ * multiply-add is fused). It covers only what those runs need: no lanes,
+ * dynamics models, logging, history or event-driven stepping. The unrolled
+ * pair tests grow as N^2, so it is meant for fleets of a few dozen at most.
+ *
+ * @tparam N Number of vehicles, at least 2.
+ */
+template <std::size_t N>
+class FixedSimulation {
+    static_assert(N >= 2, "a run needs at least two vehicles");
+
+public:
+    /** Number of vehicle pairs, and so the most conflicts one step can report. */
+    static constexpr std::size_t PAIRS = N * (N - 1) / 2;
+
+    /**
+     * @brief The outcome of run().
+     */
+    struct Result {
+        RunStatus status = RunStatus::Running;       /**< Final status. */
+        long long steps = 0;                         /**< Number of steps executed. */
+        double simTime = 0.0;                        /**< Simulated time reached, in seconds. */
+        std::size_t conflictCount = 0;               /**< Number of valid entries in conflicts. */
+        std::array<ConflictEvent, PAIRS> conflicts{}; /**< Colliding pairs of the last step, by vehicle order. */
+    };
+
+private:
+    /**
+     * @brief First and second vehicle of every pair, in ascending order.
+     */
+    struct PairTable {
+        std::array<std::size_t, PAIRS> first{};
+        std::array<std::size_t, PAIRS> second{};
+
+        constexpr PairTable() {
+            std::size_t k = 0;
+            for (std::size_t i = 0; i < N; i++) {
+                for (std::size_t j = i + 1; j < N; j++) {
+                    first[k] = i;
+                    second[k] = j;
+                    k++;
+                }
+            }
+        }
+    };
+
+    static constexpr PairTable PAIR_TABLE{};
+
+    double timeStep;                 /**< Step length in seconds. */
+    double safetyDistance;           /**< Added to the longer vehicle's length to get a pair's danger distance. */
+    std::array<int, N> ids{};        /**< Vehicle identifiers. */
+    std::array<double, N> xs{};      /**< X-coordinates. */
+    std::array<double, N> ys{};      /**< Y-coordinates. */
+    std::array<double, N> vxs{};     /**< Cached x velocity components. */
+    std::array<double, N> vys{};     /**< Cached y velocity components. */
+    std::array<double, N> lengths{}; /**< Vehicle lengths. */
+    std::array<double, N> speeds{};  /**< Speeds, kept for vehicle(). */
+    std::array<double, N> headings{}; /**< Directions in degrees, kept for vehicle(). */
+
+    /**
+     * @brief Tests every pair of the step that just ended and appends the colliding ones.
+     */
+    template <std::size_t... K>
+    void checkPairs(long long step, double time, Result& r, std::index_sequence<K...>) const {
+        (checkPair(PAIR_TABLE.first[K], PAIR_TABLE.second[K], step, time, r), ...);
+    }
+
+    /**
+     * @brief Tests one pair with the shared narrow phase and appends its conflict if it is in danger.
+     */
+    void checkPair(std::size_t i, std::size_t j, long long step, double time, Result& r) const {
+        if (!inDanger(xs.data(), ys.data(), vxs.data(), vys.data(), lengths.data(), i, j, safetyDistance, timeStep)) return;
+        const Approach a = closestApproach(xs.data(), ys.data(), vxs.data(), vys.data(), i, j, timeStep);
+        r.conflicts[r.conflictCount++] =
+            ConflictEvent{ids[i], ids[j], step, time, std::sqrt(a.endSq), time + a.tau, std::sqrt(a.minSq)};
+    }
+
+public:
+    /**
+     * @brief Creates a simulation of N vehicles.
+     *
+     * @param s Settings; only timeStep and safetyDistance are used.
+     * @param vehicles The N vehicles, in the order Simulation would store them.
+     */
+    FixedSimulation(const Settings& s, const Vehicle* vehicles)
+        : timeStep(s.timeStep), safetyDistance(s.safetyDistance) {
+        load(vehicles);
+    }
+
+    /**
+     * @brief Replaces the vehicles, so one object can run many scenarios.
+     *
+     * Velocity components are cached as VehicleStore::add() computes them.
+     *
+     * @param vehicles The N vehicles.
+     */
+    void load(const Vehicle* vehicles) {
+        for (std::size_t i = 0; i < N; i++) {
+            const Vehicle& v = vehicles[i];
+            const double rad = v.direction * 3.14159265358979323846 / 180.0;
+            ids[i] = v.id;
+            xs[i] = v.x;
+            ys[i] = v.y;
+            vxs[i] = std::cos(rad) * v.speed;
+            vys[i] = std::sin(rad) * v.speed;
+            lengths[i] = v.length;
+            speeds[i] = v.speed;
+            headings[i] = v.direction;
+        }
+    }
+
+    /**
+     * @brief Runs until a collision, maxSimTime or maxSteps, like Simulation::run().
+     *
+     * @param maxSimTime Simulated seconds after which the run stops (<= 0 disables the limit).
+     * @param maxSteps Maximum number of steps (0 disables the limit).
+     * @return Result The run's outcome; the vehicles are left at their final positions.
+     */
+    Result run(double maxSimTime = 5.0, long long maxSteps = 0) {
+        Result r;
+        if (!(maxSimTime > 0) && maxSteps <= 0) {
+            r.status = RunStatus::Unbounded;
+            return r;
+        }
+        double elapsed = 0.0;
+        long long steps = 0;
+        while (r.status == RunStatus::Running) {
+            elapsed += timeStep;
+            for (std::size_t i = 0; i < N; i++) {
+                xs[i] += vxs[i] * timeStep;
+                ys[i] += vys[i] * timeStep;
+            }
+            steps++;
+
+            checkPairs(steps, elapsed, r, std::make_index_sequence<PAIRS>{});
+            if (r.conflictCount > 0) {
+                r.status = RunStatus::Collision;
+            } else if ((maxSimTime > 0 && elapsed >= maxSimTime) || (maxSteps > 0 && steps >= maxSteps)) {
+                r.status = RunStatus::Stopped;
+            }
+        }
+        r.steps = steps;
+        r.simTime = elapsed;
+        return r;
+    }
+
+    /**
+     * @brief Returns the current state of vehicle i.
+     */
+    Vehicle vehicle(std::size_t i) const { return Vehicle(ids[i], xs[i], ys[i], speeds[i], headings[i], lengths[i]); }
+
+    /**
+     * @brief Returns the number of vehicles.
+     */
+    static constexpr std::size_t size() { return N; }
+};
+
+#endif // FIXEDSIMULATION_H
@@ -0,0 +1,188 @@
+#include "IncrementalCollider.h"
+#include "ClosestApproach.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+/** Longest a candidate list is kept, in steps. */
+const double MAX_LIST_STEPS = 64;
+
+} // namespace
+
+/**
+ * @brief Forgets all state; the next check rebuilds the list.
+ */
+void IncrementalCollider::reset() {
+    order.clear();
+    pairs.clear();
+    previous.clear();
+    valid = false;
+    skipped = 0;
+    rebuilds = 0;
+}
+
+/**
+ * @brief Restores the x order and rebuilds the candidate list with sweep-and-prune.
+ *
+ * The list is kept for K steps, K chosen so vehicles at the fleet's maximum
+ * speed move about half a danger distance in that time (1 to 64 steps). The
+ * boxes are padded by half the largest danger distance plus the distance any
+ * vehicle can cover in K + 2 steps: one more for the backwards
+ * extrapolation of the narrow phase, and one for rounding of the clock.
+ * When the list is rebuilt under unchanged conditions, the safe-until times
+ * of the pairs still in it are carried over by merging the sorted lists.
+ *
+ * @param vehs The vehicles at the end of the step.
+ * @param reach Largest danger distance of any pair.
+ * @param dt Length of the step in seconds.
+ * @param time Simulation time at the end of the step.
+ * @param keepSafeTimes True to carry safe-until times over from the old list.
+ * @param lanes Lane membership of the vehicles.
+ */
+void IncrementalCollider::rebuild(const VehicleStore& vehs, double reach, double dt, double time,
+                                  bool keepSafeTimes, const LaneIndex& lanes) {
+    const std::size_t n = vehs.size();
+    const double* xs = vehs.x().data();
+    const double* ys = vehs.y().data();
+    const double maxSpeed = vehs.maxSpeed();
+
+    if (order.size() != n) {
+        order.resize(n);
+        std::iota(order.begin(), order.end(), 0u);
+    }
+    // Insertion sort: O(n) plus one shift per vehicle that passed another since the last rebuild
+    for (std::size_t k = 1; k < n; k++) {
+        const std::uint32_t v = order[k];
+        std::size_t m = k;
+        while (m > 0 && xs[order[m - 1]] > xs[v]) {
+            order[m] = order[m - 1];
+            m--;
+        }
+        order[m] = v;
+    }
+
+    double steps = MAX_LIST_STEPS;
+    if (maxSpeed > 0) steps = std::min(MAX_LIST_STEPS, std::max(1.0, std::floor(reach / (2 * maxSpeed * dt))));
+    const double reachBox = (reach + 2 * maxSpeed * (steps + 2) * dt) * 1.000001;
+
+    previous.swap(pairs);
+    pairs.clear();
+    const bool anyBound = lanes.boundCount() > 0;
+    for (std::size_t a = 0; a < n; a++) {
+        const std::uint32_t i = order[a];
+        for (std::size_t b = a + 1; b < n && xs[order[b]] - xs[i] <= reachBox; b++) {
+            const std::uint32_t j = order[b];
+            if (std::fabs(ys[j] - ys[i]) > reachBox) continue;
+            if (anyBound && lanes.isBound(i) && lanes.isBound(j)) continue;
+            pairs.push_back(Candidate{std::min(i, j), std::max(i, j), -std::numeric_limits<double>::infinity()});
+        }
+    }
+    std::sort(pairs.begin(), pairs.end(), [](const Candidate& p, const Candidate& q) {
+        return p.i < q.i || (p.i == q.i && p.j < q.j);
+    });
+
+    if (keepSafeTimes) {
+        auto old = previous.begin();
+        for (Candidate& c : pairs) {
+            while (old != previous.end() && (old->i < c.i || (old->i == c.i && old->j < c.j))) ++old;
+            if (old != previous.end() && old->i == c.i && old->j == c.j) c.safeUntil = old->safeUntil;
+        }
+    }
+
+    listUntil = time + steps * dt;
+    builtDt = dt;
+    builtMaxSpeed = maxSpeed;
+    builtReach = reach;
+    builtSize = n;
+    valid = true;
+    rebuilds++;
+}
+
+/**
+ * @brief Finds the pairs in danger during the step that just ended.
+ *
+ * The list is rebuilt when it expires, and from scratch (dropping all
+ * safe-until times) when the fleet, step length, speed bound or motion
+ * changed or the clock went back. Every listed pair whose safe-until time
+ * has passed goes through the narrow phase; if it is not in danger, its
+ * next safe-until time is computed from its end-of-step separation d and
+ * danger distance R as the time its closing speed v needs to close d - R,
+ * less a small margin for rounding. For motion other than Linear, one step
+ * is subtracted as well, since the narrow phase extrapolates the vehicles
+ * backwards along their current velocities rather than their actual paths.
+ *
+ * @param vehs The vehicles at the end of the step.
+ * @param safetyDistance Safety distance added to the larger vehicle length.
+ * @param dt Length of the step in seconds.
+ * @param time Simulation time at the end of the step.
+ * @param motion How the vehicles may have moved since the previous check.
+ * @param lanes Lane membership of the vehicles.
+ * @param out The list the colliding index pairs are appended to.
+ * @return std::uint64_t The number of pairs given to the narrow phase.
+ */
+std::uint64_t IncrementalCollider::check(const VehicleStore& vehs, double safetyDistance, double dt, double time,
+                                         Motion motion, const LaneIndex& lanes,
+                                         std::vector<std::pair<std::uint32_t, std::uint32_t>>& out) {
+    const double reach = vehs.maxLength() + safetyDistance;
+    const bool unchanged = valid && vehs.size() == builtSize && dt == builtDt && motion == builtMotion &&
+                           vehs.maxSpeed() <= builtMaxSpeed && reach <= builtReach && time >= builtTime;
+    if (!unchanged || time > listUntil) {
+        rebuild(vehs, reach, dt, time, unchanged, lanes);
+    }
+    builtMotion = motion;
+    builtTime = time;
+
+    const double* xs = vehs.x().data();
+    const double* ys = vehs.y().data();
+    const double* vxs = vehs.vx().data();
+    const double* vys = vehs.vy().data();
+    const double* lens = vehs.length().data();
+    const double* speeds = vehs.speed().data();
+    const double fleetClosing = 2 * vehs.maxSpeed();
+    const double lag = motion == Motion::Linear ? 0.0 : dt;
+    std::uint64_t tested = 0;
+    skipped = 0;
+    for (Candidate& c : pairs) {
+        if (time < c.safeUntil) {
+            skipped++;
+            continue;
+        }
+        tested++;
+        const double r = std::max(lens[c.i], lens[c.j]) + safetyDistance;
+        if (inDanger(xs, ys, vxs, vys, lens, c.i, c.j, safetyDistance, dt)) {
+            out.emplace_back(c.i, c.j);
+            c.safeUntil = -std::numeric_limits<double>::infinity();
+            continue;
+        }
+
+        const double dx = xs[c.i] - xs[c.j];
+        const double dy = ys[c.i] - ys[c.j];
+        const double d = std::sqrt(dx * dx + dy * dy);
+        const double margin = 1e-6 * (d + std::fabs(r)) +
+            1e-9 * (std::fabs(xs[c.i]) + std::fabs(ys[c.i]) + std::fabs(xs[c.j]) + std::fabs(ys[c.j]));
+        const double gap = d - r - margin;
+        double closing;
+        if (motion == Motion::Linear) {
+            const double wx = vxs[c.i] - vxs[c.j];
+            const double wy = vys[c.i] - vys[c.j];
+            closing = std::sqrt(wx * wx + wy * wy);
+        } else if (motion == Motion::ConstantSpeed) {
+            closing = std::fabs(speeds[c.i]) + std::fabs(speeds[c.j]);
+        } else {
+            closing = fleetClosing;
+        }
+        if (r < 0) {
+            c.safeUntil = std::numeric_limits<double>::infinity();
+        } else if (!(gap > 0)) {
+            c.safeUntil = -std::numeric_limits<double>::infinity();
+        } else if (closing > 0) {
+            c.safeUntil = time + gap / closing - lag;
+        } else {
+            c.safeUntil = std::numeric_limits<double>::infinity();
+        }
+    }
+    return tested;
+}
@@ -0,0 +1,109 @@
+#ifndef INCREMENTALCOLLIDER_H
+#define INCREMENTALCOLLIDER_H
+
+#include "VehicleStore.h"
+#include "LaneIndex.h"
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Collision check that carries its broad phase and pair bounds from one step to the next.
+ *
+ * Two pieces of state survive between steps:
+ * - A candidate pair list built by sweep-and-prune over the vehicles sorted
+ *   by x. The vehicle order is kept between rebuilds and restored with
+ *   insertion sort, which is O(n) when vehicles rarely pass each other. The
+ *   boxes are padded by how far any vehicle can move before the list
+ *   expires, so a pair missing from the list cannot come into danger before
+ *   the next rebuild.
+ * - A safe-until time per candidate pair: after a pair passes the narrow
+ *   phase at separation d, it cannot come within its danger distance R
+ *   before (d - R) / v, with v a bound on its closing speed. The pair is
+ *   skipped until then. In steady traffic most pairs move together, so only
+ *   a small fraction of the list is re-examined per step.
+ *
+ * The closing-speed bound depends on how the vehicles may move (see Motion).
+ * Pairs found in danger are exactly those the grid and all-pairs checks
+ * find, since every pair that is not skipped goes through the same
+ * narrow phase.
+ */
+class IncrementalCollider {
+public:
+    /**
+     * @brief How vehicles may change their velocity between steps.
+     */
+    enum class Motion {
+        Linear,        /**< Constant velocity: the closing speed of a pair is its relative speed. */
+        ConstantSpeed, /**< Headings may change (lanes): the closing speed is at most the sum of the speeds. */
+        Bounded        /**< Speeds may change (dynamics): the closing speed is at most twice the fleet's maximum speed. */
+    };
+
+private:
+    /**
+     * @brief One pair of the candidate list.
+     */
+    struct Candidate {
+        std::uint32_t i;   /**< Store index of the first vehicle (the smaller index). */
+        std::uint32_t j;   /**< Store index of the second vehicle. */
+        double safeUntil;  /**< Checks of steps ending before this time cannot find the pair in danger. */
+    };
+
+    std::vector<std::uint32_t> order;   /**< Store indices sorted by x, kept between rebuilds. */
+    std::vector<Candidate> pairs;       /**< Candidate pairs, sorted by (i, j). */
+    std::vector<Candidate> previous;    /**< Pair list before the last rebuild, to carry safe-until times over. */
+    double listUntil = 0.0;             /**< Checks of steps ending after this time need a new list. */
+    double builtTime = 0.0;             /**< Time of the last check, to detect a restarted clock. */
+    double builtDt = 0.0;               /**< Step length the list was built for. */
+    double builtMaxSpeed = 0.0;         /**< Fleet speed bound the list was built for. */
+    double builtReach = 0.0;            /**< Largest danger distance the list was built for. */
+    std::size_t builtSize = 0;          /**< Number of vehicles the list was built for. */
+    Motion builtMotion = Motion::Linear; /**< Motion the safe-until times were computed for. */
+    bool valid = false;                 /**< False until the first build and after reset(). */
+    std::uint64_t skipped = 0;          /**< Pairs skipped by their safe-until time in the last check. */
+    std::uint64_t rebuilds = 0;         /**< Number of list rebuilds since reset(). */
+
+    void rebuild(const VehicleStore& vehs, double reach, double dt, double time, bool keepSafeTimes,
+                 const LaneIndex& lanes);
+
+public:
+    /**
+     * @brief Forgets all state; the next check rebuilds the list.
+     */
+    void reset();
+
+    /**
+     * @brief Finds the pairs in danger during the step that just ended.
+     *
+     * Pairs of two lane-bound vehicles are left out, as in the other checks.
+     *
+     * @param vehs The vehicles at the end of the step.
+     * @param safetyDistance Safety distance added to the larger vehicle length.
+     * @param dt Length of the step in seconds.
+     * @param time Simulation time at the end of the step; must not decrease between checks without reset().
+     * @param motion How the vehicles may have moved since the previous check.
+     * @param lanes Lane membership of the vehicles.
+     * @param out The list the colliding index pairs are appended to.
+     * @return std::uint64_t The number of pairs given to the narrow phase.
+     */
+    std::uint64_t check(const VehicleStore& vehs, double safetyDistance, double dt, double time, Motion motion,
+                        const LaneIndex& lanes, std::vector<std::pair<std::uint32_t, std::uint32_t>>& out);
+
+    /**
+     * @brief Returns the number of pairs in the current candidate list.
+     */
+    std::size_t candidatePairs() const { return pairs.size(); }
+
+    /**
+     * @brief Returns the number of candidate pairs the last check skipped.
+     */
+    std::uint64_t skippedPairs() const { return skipped; }
+
+    /**
+     * @brief Returns the number of list rebuilds since the last reset().
+     */
+    std::uint64_t rebuildCount() const { return rebuilds; }
+};
+
+#endif // INCREMENTALCOLLIDER_H
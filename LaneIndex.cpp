@@ -0,0 +1,146 @@
+#include "LaneIndex.h"
+#include <algorithm>
+
+const std::uint32_t LaneIndex::NO_VEHICLE;
+
+/**
+ * @brief Sorts a lane's slots by arc length, then store index.
+ *
+ * Insertion sort: linear on an already sorted array, and cheap when only a
+ * few vehicles changed places since the last step.
+ */
+void LaneIndex::insertionSort(std::vector<Slot>& slots) {
+    for (std::size_t k = 1; k < slots.size(); k++) {
+        const Slot s = slots[k];
+        std::size_t m = k;
+        while (m > 0 && (slots[m - 1].arc > s.arc || (slots[m - 1].arc == s.arc && slots[m - 1].vehicle > s.vehicle))) {
+            slots[m] = slots[m - 1];
+            m--;
+        }
+        slots[m] = s;
+    }
+}
+
+/**
+ * @brief Removes all vehicles and adopts the lanes of a network.
+ */
+void LaneIndex::reset(const RoadNetwork& roads) {
+    laneOf.clear();
+    arc.clear();
+    segment.clear();
+    slotOf.clear();
+    members.assign(roads.size(), std::vector<Slot>());
+    rightOf.resize(roads.size());
+    for (std::size_t lane = 0; lane < roads.size(); lane++) {
+        rightOf[lane] = roads.right(lane);
+    }
+    bound = 0;
+}
+
+/**
+ * @brief Binds a vehicle of the store to a lane.
+ *
+ * @param vehicle Store index of the vehicle.
+ * @param lane Index of the lane in the network.
+ * @param s Arc length of the vehicle on the lane.
+ */
+void LaneIndex::add(std::uint32_t vehicle, std::size_t lane, double s) {
+    if (vehicle >= laneOf.size()) {
+        laneOf.resize(vehicle + 1, -1);
+        arc.resize(vehicle + 1, 0.0);
+        segment.resize(vehicle + 1, 0);
+        slotOf.resize(vehicle + 1, 0);
+    }
+    if (laneOf[vehicle] < 0) bound++;
+    laneOf[vehicle] = static_cast<std::int32_t>(lane);
+    arc[vehicle] = s;
+    // Binary-search the insertion point; appending in arc order moves nothing
+    std::vector<Slot>& slots = members[lane];
+    const Slot slot{s, vehicle};
+    auto at = std::upper_bound(slots.begin(), slots.end(), slot, [](const Slot& a, const Slot& b) {
+        return a.arc < b.arc || (a.arc == b.arc && a.vehicle < b.vehicle);
+    });
+    const std::size_t first = static_cast<std::size_t>(at - slots.begin());
+    slots.insert(at, slot);
+    for (std::size_t k = first; k < slots.size(); k++) {
+        slotOf[slots[k].vehicle] = static_cast<std::uint32_t>(k);
+    }
+}
+
+/**
+ * @brief Unbinds a vehicle the store removes by swap-and-pop, and renumbers the store's last vehicle.
+ *
+ * Erasing from the lane's sorted array shifts the vehicles ahead of it, so
+ * the cost is linear in the lane's size; renumbering is O(1). Ties in arc
+ * length may be left out of index order until the next advance() sorts them.
+ *
+ * @param vehicle Store index of the removed vehicle.
+ * @param last Store index of the last vehicle, which moves to vehicle.
+ */
+void LaneIndex::remove(std::uint32_t vehicle, std::uint32_t last) {
+    if (isBound(vehicle)) {
+        std::vector<Slot>& slots = members[static_cast<std::size_t>(laneOf[vehicle])];
+        const std::size_t at = slotOf[vehicle];
+        slots.erase(slots.begin() + static_cast<std::ptrdiff_t>(at));
+        for (std::size_t k = at; k < slots.size(); k++) {
+            slotOf[slots[k].vehicle] = static_cast<std::uint32_t>(k);
+        }
+        laneOf[vehicle] = -1;
+        bound--;
+    }
+    if (last != vehicle && isBound(last)) {
+        laneOf[vehicle] = laneOf[last];
+        arc[vehicle] = arc[last];
+        segment[vehicle] = segment[last];
+        slotOf[vehicle] = slotOf[last];
+        members[static_cast<std::size_t>(laneOf[last])][slotOf[last]].vehicle = vehicle;
+        laneOf[last] = -1;
+    }
+    if (laneOf.size() > last) {
+        laneOf.resize(last);
+        arc.resize(last);
+        segment.resize(last);
+        slotOf.resize(last);
+    }
+}
+
+/**
+ * @brief Returns the store index of a vehicle's leader in its lane, or NO_VEHICLE.
+ *
+ * Free vehicles and the first vehicle of a lane have no leader.
+ */
+std::uint32_t LaneIndex::leaderOf(std::size_t vehicle) const {
+    if (!isBound(vehicle)) return NO_VEHICLE;
+    const std::vector<Slot>& slots = members[static_cast<std::size_t>(laneOf[vehicle])];
+    const std::size_t next = slotOf[vehicle] + 1;
+    return next < slots.size() ? slots[next].vehicle : NO_VEHICLE;
+}
+
+/**
+ * @brief Moves every lane-bound vehicle dt seconds along its lane.
+ *
+ * The poses are updated in store order, so the store's columns are written
+ * sequentially; the lanes are then re-sorted one by one.
+ *
+ * @param vehs The store holding the vehicles.
+ * @param roads The network the vehicles' lanes belong to.
+ * @param dt The time to advance by, in seconds.
+ */
+void LaneIndex::advance(VehicleStore& vehs, const RoadNetwork& roads, double dt) {
+    const double* speeds = vehs.speed().data();
+    for (std::size_t i = 0; i < laneOf.size(); i++) {
+        if (laneOf[i] < 0) continue;
+        arc[i] += speeds[i] * dt;
+        const LanePose p = roads.locate(static_cast<std::size_t>(laneOf[i]), arc[i], segment[i]);
+        vehs.setPose(i, p.x, p.y, p.direction, p.ux, p.uy);
+    }
+    for (std::vector<Slot>& slots : members) {
+        for (Slot& s : slots) {
+            s.arc = arc[s.vehicle];
+        }
+        insertionSort(slots);
+        for (std::size_t k = 0; k < slots.size(); k++) {
+            slotOf[slots[k].vehicle] = static_cast<std::uint32_t>(k);
+        }
+    }
+}
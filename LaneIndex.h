@@ -0,0 +1,136 @@
+#ifndef LANEINDEX_H
+#define LANEINDEX_H
+
+#include "RoadNetwork.h"
+#include "VehicleStore.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Lane membership and arc-length order of the lane-bound vehicles of a store.
+ *
+ * Each lane keeps its vehicles in an array sorted by arc length. Vehicles
+ * move little in one step, so after every step the arrays are re-sorted with
+ * insertion sort, which costs O(n) when the order is unchanged and one shift
+ * per overtake otherwise. A vehicle's leader and follower are then its
+ * neighbours in the array, and its neighbours in the lane to the right are
+ * found by walking both sorted arrays together, so all neighbour pairs are
+ * enumerated in O(n).
+ *
+ * Vehicles not added through add() are free-space vehicles: the index ignores
+ * them and the simulation checks them against every vehicle as before.
+ */
+class LaneIndex {
+public:
+    /** Returned by leaderOf() when a vehicle has no leader. */
+    static const std::uint32_t NO_VEHICLE = 0xFFFFFFFFu;
+
+private:
+    /**
+     * @brief One vehicle in a lane's sorted array.
+     */
+    struct Slot {
+        double arc;             /**< Arc length of the vehicle, copied for the sort. */
+        std::uint32_t vehicle;  /**< Store index of the vehicle. */
+    };
+
+    std::vector<std::int32_t> laneOf;      /**< Lane index of each store index, or -1 for a free vehicle. */
+    std::vector<double> arc;               /**< Arc length of each lane-bound vehicle. */
+    std::vector<std::uint32_t> segment;    /**< Segment hint of each lane-bound vehicle, for RoadNetwork::locate(). */
+    std::vector<std::uint32_t> slotOf;     /**< Position of each lane-bound vehicle in its lane's sorted array. */
+    std::vector<std::vector<Slot>> members; /**< Vehicles of each lane, sorted by arc length. */
+    std::vector<int> rightOf;              /**< Index of the lane to the right of each lane, or -1. */
+    std::size_t bound = 0;                 /**< Number of lane-bound vehicles. */
+
+    static void insertionSort(std::vector<Slot>& slots);
+
+public:
+    /**
+     * @brief Removes all vehicles and adopts the lanes of a network.
+     */
+    void reset(const RoadNetwork& roads);
+
+    /**
+     * @brief Binds a vehicle of the store to a lane.
+     *
+     * @param vehicle Store index of the vehicle.
+     * @param lane Index of the lane in the network.
+     * @param s Arc length of the vehicle on the lane.
+     */
+    void add(std::uint32_t vehicle, std::size_t lane, double s);
+
+    /**
+     * @brief Unbinds a vehicle the store removes by swap-and-pop, and renumbers the store's last vehicle.
+     *
+     * The vehicle leaves its lane's array; the last vehicle, if lane-bound,
+     * keeps its lane and place under its new store index.
+     *
+     * @param vehicle Store index of the removed vehicle.
+     * @param last Store index of the last vehicle, which moves to vehicle.
+     */
+    void remove(std::uint32_t vehicle, std::uint32_t last);
+
+    /**
+     * @brief Returns the number of lane-bound vehicles.
+     */
+    std::size_t boundCount() const { return bound; }
+
+    /**
+     * @brief Returns true if the vehicle at a store index is bound to a lane.
+     */
+    bool isBound(std::size_t vehicle) const { return vehicle < laneOf.size() && laneOf[vehicle] >= 0; }
+
+    /**
+     * @brief Returns the arc length of a lane-bound vehicle.
+     */
+    double arcOf(std::size_t vehicle) const { return arc[vehicle]; }
+
+    /**
+     * @brief Returns the store index of a vehicle's leader in its lane, or NO_VEHICLE.
+     *
+     * Free vehicles and the first vehicle of a lane have no leader.
+     */
+    std::uint32_t leaderOf(std::size_t vehicle) const;
+
+    /**
+     * @brief Moves every lane-bound vehicle dt seconds along its lane.
+     *
+     * Advances the arc lengths by speed * dt, places the vehicles at their new
+     * poses in the store and restores the sorted order of every lane.
+     *
+     * @param vehs The store holding the vehicles.
+     * @param roads The network the vehicles' lanes belong to.
+     * @param dt The time to advance by, in seconds.
+     */
+    void advance(VehicleStore& vehs, const RoadNetwork& roads, double dt);
+
+    /**
+     * @brief Invokes f(i, j) for every leader/follower and adjacent-lane neighbour pair.
+     *
+     * For each vehicle, reports its leader in its own lane and the vehicles
+     * just behind and just ahead of it in the lane to its right. Each pair is
+     * reported once.
+     *
+     * @param f Callable taking two store indices.
+     */
+    template <typename F>
+    void forEachNeighborPair(F&& f) const {
+        for (std::size_t lane = 0; lane < members.size(); lane++) {
+            const std::vector<Slot>& own = members[lane];
+            for (std::size_t k = 1; k < own.size(); k++) {
+                f(own[k - 1].vehicle, own[k].vehicle);
+            }
+            if (rightOf[lane] < 0) continue;
+            const std::vector<Slot>& other = members[rightOf[lane]];
+            std::size_t p = 0;
+            for (const Slot& a : own) {
+                while (p < other.size() && other[p].arc < a.arc) p++;
+                if (p > 0) f(a.vehicle, other[p - 1].vehicle);
+                if (p < other.size()) f(a.vehicle, other[p].vehicle);
+            }
+        }
+    }
+};
+
+#endif // LANEINDEX_H
@@ -0,0 +1,94 @@
+#include "LogArena.h"
+#include <algorithm>
+#include <cstring>
+
+const std::size_t LogArena::FIRST_BLOCK;
+const std::size_t LogArena::MAX_BLOCK;
+
+/**
+ * @brief Allocates a block of at least minSize bytes and makes it the current block.
+ */
+void LogArena::newBlock(std::size_t minSize) {
+    std::size_t size = blocks.empty() ? FIRST_BLOCK : std::min(MAX_BLOCK, blocks.back().size * 2);
+    size = std::max(size, minSize);
+    blocks.push_back(Block{std::unique_ptr<unsigned char[]>(new unsigned char[size]), size, 0});
+    reserved += size;
+}
+
+/**
+ * @brief Closes the open run and starts an empty one at the top of the arena.
+ */
+void LogArena::beginRun() {
+    if (!blocks.empty()) runStart = blocks.back().used;
+}
+
+/**
+ * @brief Appends bytes to the open run.
+ *
+ * @param bytes The bytes to append.
+ * @param size Number of bytes.
+ */
+void LogArena::append(const void* bytes, std::size_t size) {
+    if (size == 0) return;
+    if (blocks.empty()) {
+        newBlock(size);
+        runStart = 0;
+    } else if (blocks.back().size - blocks.back().used < size) {
+        // Move the open run to a block with room for it and the new bytes
+        const std::size_t runBytes = blocks.back().used - runStart;
+        const unsigned char* old = blocks.back().data.get() + runStart;
+        if (runStart == 0) {
+            // The run fills its block alone: grow that block instead of leaving it unused
+            std::size_t grown = std::max(blocks.back().size * 2, runBytes + size);
+            std::unique_ptr<unsigned char[]> data(new unsigned char[grown]);
+            if (runBytes > 0) std::memcpy(data.get(), old, runBytes);
+            reserved += grown - blocks.back().size;
+            blocks.back().data = std::move(data);
+            blocks.back().size = grown;
+        } else {
+            newBlock(2 * (runBytes + size));
+            if (runBytes > 0) std::memcpy(blocks.back().data.get(), old, runBytes);
+            blocks[blocks.size() - 2].used = runStart;
+            blocks.back().used = runBytes;
+            runStart = 0;
+        }
+    }
+    Block& b = blocks.back();
+    std::memcpy(b.data.get() + b.used, bytes, size);
+    b.used += size;
+}
+
+/**
+ * @brief Returns the start of the open run (null before the first append).
+ */
+const unsigned char* LogArena::runData() const {
+    return blocks.empty() ? nullptr : blocks.back().data.get() + runStart;
+}
+
+/**
+ * @brief Returns the size of the open run in bytes.
+ */
+std::size_t LogArena::runSize() const {
+    return blocks.empty() ? 0 : blocks.back().used - runStart;
+}
+
+/**
+ * @brief Frees all blocks except the first, which is kept empty for reuse.
+ */
+void LogArena::reset() {
+    if (blocks.empty()) return;
+    blocks.resize(1);
+    blocks.front().used = 0;
+    reserved = blocks.front().size;
+    runStart = 0;
+}
+
+/**
+ * @brief Frees all blocks.
+ */
+void LogArena::release() {
+    blocks.clear();
+    blocks.shrink_to_fit();
+    reserved = 0;
+    runStart = 0;
+}
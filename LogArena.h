@@ -0,0 +1,92 @@
+#ifndef LOGARENA_H
+#define LOGARENA_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Monotonic block arena holding the encoded byte runs of a RunLog.
+ *
+ * Memory is taken from the heap in large blocks (growing geometrically up to
+ * a cap) and never freed piecemeal: a run log carves its keyframe segments
+ * out of the blocks and releases everything at once when it is destroyed or
+ * cleared. A step therefore costs no heap allocation, and the bytes of a run
+ * are never copied to grow a buffer, unlike a std::vector that doubles.
+ *
+ * The arena has one open run at a time: append() extends it, keeping its
+ * bytes contiguous. If the open run outgrows the current block, it is moved
+ * to a fresh block; only that run is copied, so the cost is bounded by one
+ * keyframe segment.
+ */
+class LogArena {
+private:
+    /**
+     * @brief One heap block.
+     */
+    struct Block {
+        std::unique_ptr<unsigned char[]> data; /**< The block's bytes. */
+        std::size_t size;                      /**< Capacity in bytes. */
+        std::size_t used;                      /**< Bytes handed out, including the open run. */
+    };
+
+    /** Size of the first block; small, so the many short runs kept in a run history stay cheap. */
+    static const std::size_t FIRST_BLOCK = 4 * 1024;
+
+    /** Blocks double in size up to this cap (larger runs get a block of their own size). */
+    static const std::size_t MAX_BLOCK = 4 * 1024 * 1024;
+
+    std::vector<Block> blocks;   /**< Blocks in allocation order; the last one holds the open run. */
+    std::size_t runStart = 0;    /**< Offset of the open run in the last block. */
+    std::size_t reserved = 0;    /**< Total capacity of all blocks. */
+
+    void newBlock(std::size_t minSize);
+
+public:
+    LogArena() = default;
+    LogArena(const LogArena&) = delete;
+    LogArena& operator=(const LogArena&) = delete;
+
+    /**
+     * @brief Closes the open run and starts an empty one at the top of the arena.
+     */
+    void beginRun();
+
+    /**
+     * @brief Appends bytes to the open run.
+     *
+     * May move the open run, so pointers from runData() are only valid until
+     * the next append().
+     *
+     * @param bytes The bytes to append.
+     * @param size Number of bytes.
+     */
+    void append(const void* bytes, std::size_t size);
+
+    /**
+     * @brief Returns the start of the open run (null before the first append).
+     */
+    const unsigned char* runData() const;
+
+    /**
+     * @brief Returns the size of the open run in bytes.
+     */
+    std::size_t runSize() const;
+
+    /**
+     * @brief Frees all blocks except the first, which is kept empty for reuse.
+     */
+    void reset();
+
+    /**
+     * @brief Frees all blocks.
+     */
+    void release();
+
+    /**
+     * @brief Returns the total capacity of the arena's blocks in bytes.
+     */
+    std::size_t bytesReserved() const { return reserved; }
+};
+
+#endif // LOGARENA_H
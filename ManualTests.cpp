@@ -1,7 +1,29 @@
 
 #include <iostream>
+#include <fstream>
+#include <cstdio>
 #include <cmath>
+#include <vector>
+#include <algorithm>
+#include <iterator>
+#include <string>
 #include "Simulation.h"
+#include "ScenarioBatch.h"
+#include "MonteCarlo.h"
+#include "Philox.h"
+#include "ScenarioFile.h"
+#include "MappedFile.h"
+#include "RunLogWriter.h"
+#include "CsvImporter.h"
+#include "AsyncOutput.h"
+#include "AsyncRun.h"
+#include "ArrowTrajectory.h"
+#include "FixedSimulation.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <functional>
+#include <random>
 
 /**
  * @brief Compares two double values for approximate equality.
@@ -169,6 +191,1955 @@ void testReplayRun() {
     std::cout << "Test ReplayRun complete.\n\n";
 }
 
+/**
+ * @brief Tests the headless run API.
+ * 
+ * This test runs a simulation without logging through run(), checks that the
+ * collision is still detected, and verifies that the step budget is honoured.
+ */
+void testHeadlessRun() {
+    std::cout << "[TEST] HeadlessRun\n";
+    Settings s{1.0, 5.0, "m/s", false}; // logging OFF
+    Simulation sim(s);
+    sim.addVehicle(Vehicle{1, 0, 0, 5, 0, 2});
+    sim.addVehicle(Vehicle{2, 40, 0, 5, 180, 2});
+
+    RunResult result = sim.run();
+    if (result.record.status == "Collision" && result.record.logs.empty())
+        std::cout << "PASS: Collision detected without logging after "
+                  << result.stats.steps << " steps.\n";
+    else
+        std::cout << "FAIL: Status was " << result.record.status << "\n";
+
+    Simulation budget(s);
+    budget.addVehicle(Vehicle{1, 0, 0, 1, 0, 2});
+    budget.addVehicle(Vehicle{2, 0, 100, 1, 0, 2});
+    RunOptions options;
+    options.maxSimTime = 0;
+    options.maxSteps = 1000;
+    RunResult limited = budget.run(options);
+    if (limited.record.status == "Stopped" && limited.stats.steps == 1000 &&
+        almostEqual(limited.stats.simTime, 1000.0))
+        std::cout << "PASS: Step budget stopped the run at " << limited.stats.steps << " steps.\n";
+    else
+        std::cout << "FAIL: Run stopped after " << limited.stats.steps << " steps.\n";
+
+    // Without a time or step limit a collision-free run would never end
+    options.maxSteps = 0;
+    RunResult unbounded = budget.run(options);
+    if (unbounded.record.status == "Unbounded" && unbounded.record.runId == 0 && unbounded.stats.steps == 0)
+        std::cout << "PASS: Run without limits was rejected.\n";
+    else
+        std::cout << "FAIL: Run without limits ended with status " << unbounded.record.status << ".\n";
+
+    std::cout << "Test HeadlessRun complete.\n\n";
+}
+
+/**
+ * @brief Tests the vectorized integrator against the per-vehicle trig formula.
+ * 
+ * This test steps a fleet whose size is not a multiple of the SIMD width and
+ * verifies every position matches x += cos(rad) * speed * dt exactly.
+ */
+void testVectorizedIntegration() {
+    std::cout << "[TEST] VectorizedIntegration\n";
+    Settings s{0.25, 5.0, "m/s", false};
+    Simulation sim(s);
+    std::vector<Vehicle> expected;
+    for (int i = 0; i < 37; i++) {
+        Vehicle v{i, i * 3.0, -i * 1.5, 5.0 + i, i * 17.0, 4};
+        sim.addVehicle(v);
+        expected.push_back(v);
+    }
+
+    double elapsed = 0.0;
+    RunRecord run{1, "Running", {}};
+    for (int stepCount = 0; stepCount < 10; stepCount++) {
+        sim.publicStep(elapsed, run);
+        for (auto& v : expected) {
+            double rad = v.direction * 3.14159265358979323846 / 180.0;
+            v.x += std::cos(rad) * v.speed * s.timeStep;
+            v.y += std::sin(rad) * v.speed * s.timeStep;
+        }
+    }
+
+    std::vector<Vehicle> actual = sim.getVehicles();
+    bool same = actual.size() == expected.size();
+    for (size_t i = 0; same && i < actual.size(); i++) {
+        same = actual[i].id == expected[i].id && actual[i].x == expected[i].x && actual[i].y == expected[i].y;
+    }
+
+    if (same)
+        std::cout << "PASS: SIMD integration matches scalar kinematics for " << actual.size() << " vehicles.\n";
+    else
+        std::cout << "FAIL: SIMD integration diverged from scalar kinematics.\n";
+
+    std::cout << "Test VectorizedIntegration complete.\n\n";
+}
+
+/**
+ * @brief Tests the grid broad phase against the all-pairs reference.
+ * 
+ * This test builds pseudo-random fleets of varying density, including fleets
+ * with exactly one close pair, and verifies that the grid-accelerated check
+ * agrees with the all-pairs reference on every one of them.
+ */
+void testGridBroadPhase() {
+    std::cout << "[TEST] GridBroadPhase\n";
+    Settings s{1.0, 5.0, "m/s", false};
+    unsigned int seed = 12345;
+    auto next = [&seed]() {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 8) / double(1u << 24);
+    };
+
+    int mismatches = 0;
+    int collisions = 0;
+    for (int trial = 0; trial < 40; trial++) {
+        Simulation sim(s);
+        double extent = 2000.0 + trial * 500.0;
+        for (int i = 0; i < 300; i++) {
+            sim.addVehicle(Vehicle{i, next() * extent - extent / 2, next() * extent - extent / 2,
+                                   next() * 30, next() * 360, 2 + next() * 10});
+        }
+        if (trial % 4 == 0) {
+            // Plant a pair exactly at the danger distance of the longest vehicle
+            sim.addVehicle(Vehicle{1000, 5e6, 5e6, 0, 0, 12});
+            sim.addVehicle(Vehicle{1001, 5e6 + 17, 5e6, 0, 0, 2});
+        }
+        std::vector<ConflictEvent> grid = sim.publicCheckCollision();
+        std::vector<ConflictEvent> reference = sim.publicCheckCollisionAllPairs();
+        bool same = grid.size() == reference.size();
+        for (size_t k = 0; same && k < grid.size(); k++) {
+            same = grid[k].vehicleA == reference[k].vehicleA && grid[k].vehicleB == reference[k].vehicleB;
+        }
+        if (!same) mismatches++;
+        if (!reference.empty()) collisions++;
+    }
+
+    if (mismatches == 0 && collisions > 0 && collisions < 40)
+        std::cout << "PASS: Grid matched all-pairs on 40 fleets (" << collisions << " with collisions).\n";
+    else
+        std::cout << "FAIL: " << mismatches << " mismatches, " << collisions << " fleets with collisions.\n";
+
+    std::cout << "Test GridBroadPhase complete.\n\n";
+}
+
+/**
+ * @brief Tests that conflicts are reported per pair with their closest approach.
+ * 
+ * Two fast vehicles drive through each other within a single 10 s step, so
+ * they are far apart again at the end of the step. Continuous detection must
+ * still report the pair with a closest approach of 0 m at t=5s.
+ */
+void testConflictEvents() {
+    std::cout << "[TEST] ConflictEvents\n";
+    Settings s{10.0, 5.0, "m/s", false};
+    Simulation sim(s);
+    sim.addVehicle(Vehicle{7, 0, 0, 30, 0, 4});     // East-bound
+    sim.addVehicle(Vehicle{9, 300, 0, 30, 180, 4}); // West-bound, passes vehicle 7 at x=150
+    sim.addVehicle(Vehicle{11, 0, 500, 1, 0, 4});   // Far away, never involved
+
+    RunResult result = sim.run();
+    const auto& conflicts = result.record.conflicts;
+    if (result.record.status == "Collision" && conflicts.size() == 1 &&
+        conflicts[0].vehicleA == 7 && conflicts[0].vehicleB == 9 && conflicts[0].step == 1 &&
+        almostEqual(conflicts[0].closestTime, 5.0) && almostEqual(conflicts[0].closestDistance, 0.0) &&
+        almostEqual(conflicts[0].distance, 300.0))
+        std::cout << "PASS: Tunnelling pair reported with closest approach at t="
+                  << conflicts[0].closestTime << "s.\n";
+    else
+        std::cout << "FAIL: Status " << result.record.status << " with " << conflicts.size() << " conflicts.\n";
+
+    std::cout << "Test ConflictEvents complete.\n\n";
+}
+
+/**
+ * @brief Tests the compressed run log against uncompressed snapshots.
+ * 
+ * This test steps a fleet 500 times, keeping a full copy of every step on the
+ * side, then checks that sequential iteration and random access both return
+ * every vehicle within the log resolution and that the log is much smaller
+ * than the full copies.
+ */
+void testCompressedLog() {
+    std::cout << "[TEST] CompressedLog\n";
+    Settings s{0.1, 5.0, "m/s", true};
+    Simulation sim(s);
+    for (int i = 0; i < 50; i++) {
+        sim.addVehicle(Vehicle{i, i * 100.0, -i * 37.5, 3.0 + i * 0.7, i * 29.0, 4.5});
+    }
+
+    double elapsed = 0.0;
+    RunRecord run{1, "Running", {}};
+    std::vector<LogEntry> full;
+    for (int stepCount = 0; stepCount < 500; stepCount++) {
+        sim.publicStep(elapsed, run);
+        full.push_back(LogEntry{elapsed, sim.getVehicles()});
+    }
+
+    double worst = 0.0;
+    bool layoutOk = run.logs.size() == full.size();
+    size_t index = 0;
+    for (const auto& entry : run.logs) {
+        const LogEntry random = run.logs[index];
+        for (size_t i = 0; i < entry.positions.size(); i++) {
+            const Vehicle& a = entry.positions[i];
+            const Vehicle& b = full[index].positions[i];
+            const Vehicle& c = random.positions[i];
+            layoutOk = layoutOk && a.id == b.id && a.length == b.length && a.x == c.x && a.y == c.y;
+            worst = std::max(worst, std::max(std::fabs(a.x - b.x), std::fabs(a.y - b.y)));
+        }
+        layoutOk = layoutOk && entry.time == full[index].time;
+        index++;
+    }
+
+    size_t fullBytes = full.size() * full[0].positions.size() * sizeof(Vehicle);
+    if (layoutOk && worst <= s.logResolution && run.logs.byteSize() * 4 < fullBytes)
+        std::cout << "PASS: Log holds " << run.logs.byteSize() << " bytes vs " << fullBytes
+                  << " uncompressed, max error " << worst << "m.\n";
+    else
+        std::cout << "FAIL: Log mismatch (max error " << worst << "m, " << run.logs.byteSize() << " bytes).\n";
+
+    std::cout << "Test CompressedLog complete.\n\n";
+}
+
+/**
+ * @brief Tests the parallel scenario batch runner.
+ * 
+ * This test sweeps the safety distance over 64 head-on scenarios, runs the
+ * batch on one and on four threads, and verifies both match running each
+ * scenario directly.
+ */
+void testScenarioBatch() {
+    std::cout << "[TEST] ScenarioBatch\n";
+    ScenarioBatch serial(1);
+    ScenarioBatch parallel(4);
+    std::vector<Scenario> scenarios;
+    for (int i = 0; i < 64; i++) {
+        Scenario sc;
+        sc.settings = Settings{0.5, i * 1.0, "m/s", i % 2 == 0};
+        sc.vehicles = { Vehicle{1, 0, 0, 5, 0, 4}, Vehicle{2, 200, 10, 5, 180, 4} };
+        sc.options.maxSimTime = 30.0;
+        serial.add(sc);
+        parallel.add(sc);
+        scenarios.push_back(sc);
+    }
+
+    std::vector<ScenarioSummary> a = serial.run();
+    std::vector<ScenarioSummary> b = parallel.run();
+    bool same = a.size() == 64 && b.size() == 64;
+    int collisions = 0;
+    for (size_t i = 0; same && i < a.size(); i++) {
+        ScenarioSummary direct = ScenarioBatch::runOne(scenarios[i], i);
+        same = a[i].index == i && b[i].index == i &&
+               a[i].status == direct.status && b[i].status == direct.status &&
+               a[i].steps == direct.steps && b[i].steps == direct.steps &&
+               a[i].firstCollisionTime == direct.firstCollisionTime &&
+               b[i].firstCollisionTime == direct.firstCollisionTime;
+        if (a[i].status == "Collision") collisions++;
+    }
+
+    // Lateral offset is 10 m, so only safety distances of at least 6 m collide
+    if (same && collisions == 58)
+        std::cout << "PASS: 1- and 4-thread batches match direct runs (" << collisions << " collisions).\n";
+    else
+        std::cout << "FAIL: Batch results differ (" << collisions << " collisions).\n";
+
+    // Scenarios streaming to one path each get a file of their own, holding only their run
+    ScenarioBatch shared(4);
+    const std::string path = "manualtests_batch.vlog";
+    for (int i = 0; i < 4; i++) {
+        Scenario sc = scenarios[i];
+        sc.settings.enableLogging = true;
+        sc.settings.logFile = path;
+        shared.add(sc);
+    }
+    shared.run();
+    int intact = 0;
+    for (int i = 0; i < 4; i++) {
+        const std::string file = path + "." + std::to_string(i);
+        MappedFile mapped;
+        std::string error;
+        int ends = 0;
+        if (mapped.open(file, error)) {
+            std::size_t offset = 0;
+            RunLogChunk chunk;
+            while (RunLogChunk::read(mapped.data(), mapped.size(), offset, chunk)) {
+                ends += chunk.kind == RunLogChunk::RUN_END;
+            }
+            mapped.close();
+        }
+        intact += ends == 1;
+        std::remove(file.c_str());
+    }
+    std::ifstream base(path);
+    if (intact == 4 && !base)
+        std::cout << "PASS: Scenarios sharing a log path each wrote a complete file of their own.\n";
+    else
+        std::cout << "FAIL: " << intact << " of 4 suffixed log files hold exactly one run.\n";
+
+    std::cout << "Test ScenarioBatch complete.\n\n";
+}
+
+/**
+ * @brief Tests that the multithreaded step path matches the serial one exactly.
+ * 
+ * This test steps the same 40000-vehicle fleet with one and with four threads
+ * and compares every position and every reported conflict bit for bit.
+ */
+void testParallelStep() {
+    std::cout << "[TEST] ParallelStep\n";
+    Settings serialSettings{0.5, 2.0, "m/s", false};
+    Settings parallelSettings = serialSettings;
+    parallelSettings.threadCount = 4;
+    Simulation serial(serialSettings);
+    Simulation parallel(parallelSettings);
+
+    unsigned int seed = 777;
+    auto next = [&seed]() {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 8) / double(1u << 24);
+    };
+    for (int i = 0; i < 40000; i++) {
+        Vehicle v{i, next() * 20000, next() * 20000, next() * 40, next() * 360, 3 + next() * 2};
+        serial.addVehicle(v);
+        parallel.addVehicle(v);
+    }
+
+    bool same = true;
+    size_t conflicts = 0;
+    double elapsedA = 0.0, elapsedB = 0.0;
+    RunRecord runA{1, "Running", {}};
+    RunRecord runB{1, "Running", {}};
+    for (int stepCount = 0; stepCount < 3 && same; stepCount++) {
+        serial.publicStep(elapsedA, runA);
+        parallel.publicStep(elapsedB, runB);
+        const VehicleStore& a = serial.getVehicleStore();
+        const VehicleStore& b = parallel.getVehicleStore();
+        same = a.x() == b.x() && a.y() == b.y();
+
+        std::vector<ConflictEvent> ca = serial.publicCheckCollision();
+        std::vector<ConflictEvent> cb = parallel.publicCheckCollision();
+        same = same && ca.size() == cb.size();
+        for (size_t k = 0; same && k < ca.size(); k++) {
+            same = ca[k].vehicleA == cb[k].vehicleA && ca[k].vehicleB == cb[k].vehicleB &&
+                   ca[k].closestTime == cb[k].closestTime && ca[k].closestDistance == cb[k].closestDistance;
+        }
+        conflicts += ca.size();
+    }
+
+    if (same && conflicts > 0)
+        std::cout << "PASS: 4-thread steps match serial steps (" << conflicts << " conflicts compared).\n";
+    else
+        std::cout << "FAIL: Parallel step diverged from serial step.\n";
+
+    std::cout << "Test ParallelStep complete.\n\n";
+}
+
+/**
+ * @brief Tests the binary scenario format and the CSV importer.
+ * 
+ * This test saves a scenario, loads it back through the memory-mapped reader
+ * and checks settings and every vehicle column round-trip exactly. It then
+ * imports a CSV file with a reordered header and a comment line.
+ */
+void testScenarioFiles() {
+    std::cout << "[TEST] ScenarioFiles\n";
+    Settings s{0.2, 3.5, "km/h", false};
+    s.threadCount = 2;
+    Simulation original(s);
+    std::vector<Vehicle> fleet;
+    for (int i = 0; i < 1000; i++) {
+        fleet.push_back(Vehicle{i, i * 0.5, -i * 0.25, 10.0 + i % 7, i * 13.0, 4.0 + i % 3});
+    }
+    original.addVehicles(fleet);
+
+    std::string error;
+    const std::string path = "manualtests_scenario.vsim";
+    bool ok = ScenarioFile::save(path, s, original.getVehicleStore(), error);
+    ScenarioFile file;
+    ok = ok && file.open(path, error);
+    bool same = ok && file.vehicleCount() == fleet.size() &&
+                file.getSettings().timeStep == s.timeStep && file.getSettings().safetyDistance == s.safetyDistance &&
+                file.getSettings().speedUnit == s.speedUnit && file.getSettings().enableLogging == s.enableLogging &&
+                file.getSettings().threadCount == s.threadCount;
+    if (same) {
+        Simulation loaded(file.getSettings());
+        file.loadInto(loaded);
+        const VehicleStore& a = original.getVehicleStore();
+        const VehicleStore& b = loaded.getVehicleStore();
+        same = a.id() == b.id() && a.x() == b.x() && a.y() == b.y() && a.vx() == b.vx() &&
+               a.vy() == b.vy() && a.length() == b.length() && a.speed() == b.speed() &&
+               a.direction() == b.direction();
+    }
+    if (same)
+        std::cout << "PASS: Scenario file round-tripped " << fleet.size() << " vehicles.\n";
+    else
+        std::cout << "FAIL: Scenario file round trip failed. " << error << "\n";
+    file.close();
+    std::remove(path.c_str());
+
+    const std::string csvPath = "manualtests_vehicles.csv";
+    {
+        std::ofstream csv(csvPath);
+        csv << "# exported fleet\n"
+            << "Length,ID,X,Y,Speed,Direction,Notes\n"
+            << "4.5,1,0,0,10,90,car\n"
+            << "12,2,100.25,-3,7.5,180,truck\n";
+    }
+    Simulation imported(s);
+    size_t count = 0;
+    bool csvOk = CsvImporter::importVehicles(csvPath, imported, error, &count);
+    std::vector<Vehicle> vs = imported.getVehicles();
+    if (csvOk && count == 2 && vs.size() == 2 && vs[1].id == 2 && vs[1].x == 100.25 &&
+        vs[1].length == 12 && vs[0].direction == 90)
+        std::cout << "PASS: CSV import matched columns by header name.\n";
+    else
+        std::cout << "FAIL: CSV import failed. " << error << "\n";
+
+    // IDs must be integers that fit an int
+    int rejected = 0;
+    for (const char* id : {"1.7", "3e9", "99999999999", "12x"}) {
+        {
+            std::ofstream csv(csvPath);
+            csv << "1,0,0,10,90,4\n" << id << ",5,5,10,90,4\n";
+        }
+        Simulation bad(s);
+        std::string badError;
+        size_t added = 0;
+        if (!CsvImporter::importVehicles(csvPath, bad, badError, &added) && added == 1 &&
+            badError.find(":2: invalid id '" + std::string(id) + "'") != std::string::npos)
+            rejected++;
+    }
+    if (rejected == 4)
+        std::cout << "PASS: CSV import rejected non-integral and out-of-range IDs with their line numbers.\n";
+    else
+        std::cout << "FAIL: CSV import rejected only " << rejected << " of 4 invalid IDs.\n";
+    std::remove(csvPath.c_str());
+
+    std::cout << "Test ScenarioFiles complete.\n\n";
+}
+
+/**
+ * @brief Test streaming run logs to a file.
+ *
+ * Runs the same fleet with in-memory and file-backed logs and checks that
+ * both logs read back identically, sequentially and by random access, while
+ * the streamed log keeps only its open segment in memory.
+ */
+void testStreamedLog() {
+    std::cout << "[TEST] StreamedLog\n";
+    Settings s{0.1, 0.5, "m/s", true};
+    s.logKeyframeInterval = 16;
+    Settings streamed = s;
+    streamed.logFile = "manualtests_runs.vlog";
+
+    std::vector<Vehicle> fleet;
+    for (int i = 0; i < 200; i++) {
+        fleet.push_back(Vehicle{i, (i % 7) * 3.0, i * 10.0, 5.0 + i % 3, (i % 2) * 180.0, 4.0});
+    }
+    RunOptions options;
+    options.maxSimTime = 0;
+    options.maxSteps = 300;
+
+    bool same = true;
+    size_t memoryBytes = 0;
+    size_t streamedBytes = 0;
+    {
+        Simulation memory(s);
+        Simulation disk(streamed);
+        memory.addVehicles(fleet);
+        disk.addVehicles(fleet);
+        // A first run in the same file must not disturb the second
+        memory.run(options);
+        disk.run(options);
+        RunResult a = memory.run(options);
+        RunResult b = disk.run(options);
+        const RunLog& la = a.record.logs;
+        const RunLog& lb = b.record.logs;
+        memoryBytes = la.byteSize();
+        streamedBytes = lb.byteSize();
+        same = lb.isStreamed() && la.size() == lb.size() && a.record.status == b.record.status;
+
+        auto ib = lb.begin();
+        for (auto ia = la.begin(); same && ia != la.end(); ++ia, ++ib) {
+            same = ia->time == ib->time && ia->positions.size() == ib->positions.size();
+            for (size_t k = 0; same && k < ia->positions.size(); k++) {
+                same = ia->positions[k].x == ib->positions[k].x && ia->positions[k].y == ib->positions[k].y;
+            }
+        }
+        for (size_t step : {size_t(0), size_t(17), size_t(150), la.size() - 1}) {
+            LogEntry ea = la.at(step);
+            LogEntry eb = lb.at(step);
+            same = same && ea.time == eb.time && lb.timeAt(step) == ea.time &&
+                   ea.positions.size() == eb.positions.size() && ea.positions.back().x == eb.positions.back().x;
+        }
+    }
+    std::remove(streamed.logFile.c_str());
+
+    // A finished run's log can be read on this thread while a later run streams to the same file
+    bool concurrent = true;
+    {
+        Simulation disk(streamed);
+        disk.addVehicles(fleet);
+        const RunResult first = disk.run(options);
+        auto checksum = [&first] {
+            double sum = 0;
+            for (const LogEntry& e : first.record.logs) sum += e.positions.back().x;
+            return sum;
+        };
+        const double expected = checksum();
+        AsyncRun later(disk, options);
+        for (int k = 0; k < 20 && concurrent; k++) concurrent = checksum() == expected;
+        concurrent = concurrent && later.wait().record.status == first.record.status && checksum() == expected;
+    }
+    std::remove(streamed.logFile.c_str());
+
+    if (same)
+        std::cout << "PASS: Streamed log replays identically to the in-memory log.\n";
+    else
+        std::cout << "FAIL: Streamed log differs from the in-memory log.\n";
+    if (streamedBytes * 4 < memoryBytes)
+        std::cout << "PASS: Streamed log holds " << streamedBytes << " bytes in memory vs "
+                  << memoryBytes << " in memory mode.\n";
+    else
+        std::cout << "FAIL: Streamed log holds " << streamedBytes << " bytes in memory vs "
+                  << memoryBytes << ".\n";
+    if (concurrent)
+        std::cout << "PASS: Finished streamed log read back while a later run was writing.\n";
+    else
+        std::cout << "FAIL: Finished streamed log changed while a later run was writing.\n";
+
+    std::cout << "Test StreamedLog complete.\n\n";
+}
+
+/**
+ * @brief Test per-phase run telemetry and its Chrome trace export.
+ *
+ * With telemetry compiled in, every step must be counted once per phase and
+ * the counters must match the run; compiled out, everything stays zero.
+ */
+void testTelemetry() {
+    std::cout << "[TEST] Telemetry\n";
+    Settings s{0.1, 1.0, "m/s", true};
+    Simulation sim(s);
+    for (int i = 0; i < 10; i++) {
+        sim.addVehicle(Vehicle{i, 0, i * 20.0, 5.0, 0, 4.0});
+    }
+    RunOptions options;
+    options.maxSimTime = 0;
+    options.maxSteps = 50;
+    RunResult result = sim.run(options);
+    const RunTelemetry& t = result.record.telemetry;
+
+    bool ok;
+    if (RunTelemetry::enabled()) {
+        ok = t.phase(TelemetryPhase::Integrate).calls == 50 && t.phase(TelemetryPhase::Collision).calls == 50 &&
+             t.phase(TelemetryPhase::Log).calls == 50 && t.phase(TelemetryPhase::Sleep).calls == 0 &&
+             t.pairsTested == 50 * 45 && t.logBytes == result.record.logs.encodedBytes() &&
+             t.trace.size() == 150;
+    } else {
+        ok = t.phase(TelemetryPhase::Integrate).calls == 0 && t.pairsTested == 0 && t.trace.empty();
+    }
+    if (ok)
+        std::cout << "PASS: Telemetry " << (RunTelemetry::enabled() ? "counted" : "compiled out for")
+                  << " 50 steps (" << t.pairsTested << " pairs, " << t.logBytes << " log bytes).\n";
+    else
+        std::cout << "FAIL: Telemetry counters do not match the run: " << t.toJson() << "\n";
+
+    const std::string path = "manualtests_trace.json";
+    std::string error;
+    bool written = t.writeChromeTrace(path, result.record.runId, error);
+    std::ifstream in(path);
+    std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::remove(path.c_str());
+    if (written && text.find("\"traceEvents\"") != std::string::npos &&
+        (!RunTelemetry::enabled() || text.find("\"name\": \"collision\", \"ph\": \"X\"") != std::string::npos))
+        std::cout << "PASS: Chrome trace written (" << text.size() << " bytes).\n";
+    else
+        std::cout << "FAIL: Chrome trace export failed. " << error << "\n";
+
+    std::cout << "Test Telemetry complete.\n\n";
+}
+
+/**
+ * @brief Test arena-backed log storage and copy-on-write sharing of finished logs.
+ *
+ * Copying a log must share its data; recording into the copy must leave the
+ * original untouched. With telemetry, recording must not allocate per step.
+ */
+void testLogArena() {
+    std::cout << "[TEST] LogArena\n";
+    Settings s{0.1, 1.0, "m/s", true};
+    Simulation sim(s);
+    for (int i = 0; i < 300; i++) {
+        sim.addVehicle(Vehicle{i, i * 3.0, (i % 10) * 50.0, 10.0 + i % 4, (i % 2) * 180.0, 4.0});
+    }
+    RunOptions options;
+    options.maxSimTime = 0;
+    options.maxSteps = 2000;
+    RunResult result = sim.run(options);
+    const RunLog& original = result.record.logs;
+    const LogEntry lastBefore = original.back();
+
+    RunLog copy = original;
+    VehicleStore extra;
+    extra.add(Vehicle{999, 1, 2, 3, 4, 5});
+    copy.record(1000.0, extra);
+    const LogEntry lastAfter = original.back();
+    bool isolated = copy.size() == original.size() + 1 && copy.back().positions.size() == 1 &&
+                    copy.at(original.size() - 1).positions.back().x == lastBefore.positions.back().x &&
+                    lastAfter.time == lastBefore.time && lastAfter.positions.back().x == lastBefore.positions.back().x;
+    if (isolated)
+        std::cout << "PASS: Copied log shares data and clones it only when recording.\n";
+    else
+        std::cout << "FAIL: Recording into a copied log changed the original.\n";
+
+    // A copy that records keeps sharing the closed segments: it only adds the open segment and its new step
+    RunLog longLog;
+    longLog.configure(16, 1e-6);
+    VehicleStore moving;
+    for (int i = 0; i < 100; i++) moving.add(Vehicle{i, i * 10.0, 0, 1.0 + i * 0.37, i * 7.0, 4});
+    for (int k = 0; k < 1000; k++) {
+        moving.integrate(0.1);
+        longLog.record(k * 0.1, moving);
+    }
+    RunLog fork = longLog;
+    RunLog sibling = longLog;
+    moving.integrate(0.1);
+    fork.record(100.0, moving);
+    sibling.record(100.0, extra);
+    const std::size_t grown = fork.byteSize() - longLog.byteSize();
+    const bool branches = fork.size() == 1001 && sibling.size() == 1001 && longLog.size() == 1000 &&
+                          almostEqual(fork.back().positions.back().x, moving.x().back()) &&
+                          sibling.back().positions.size() == 1 &&
+                          fork.at(517).positions[42].x == longLog.at(517).positions[42].x &&
+                          sibling.at(999).positions[42].x == longLog.at(999).positions[42].x;
+    if (grown * 8 < longLog.encodedBytes() && branches)
+        std::cout << "PASS: Recording into a copy added " << grown << " bytes to a log of " << longLog.encodedBytes()
+                  << " encoded bytes; sibling copies branch independently.\n";
+    else
+        std::cout << "FAIL: Recording into a copy added " << grown << " bytes to a log of " << longLog.encodedBytes()
+                  << " encoded bytes (branches " << branches << ").\n";
+
+    const PhaseStats& log = result.record.telemetry.phase(TelemetryPhase::Log);
+    if (!RunTelemetry::enabled() || !RunTelemetry::countsAllocations() || log.allocations < 64)
+        std::cout << "PASS: Recorded 2000 steps with " << log.allocations << " allocations ("
+                  << log.allocatedBytes << " bytes).\n";
+    else
+        std::cout << "FAIL: Recording allocated " << log.allocations << " times for 2000 steps.\n";
+
+    // A finished log keeps no encoder state, so neither the result nor its history copy holds more than the log
+    Simulation wide(s);
+    std::vector<Vehicle> fleet;
+    for (int i = 0; i < 20000; i++) fleet.push_back(Vehicle{i, (i % 200) * 20.0, (i / 200) * 20.0, 5.0, 0, 4.0});
+    wide.addVehicles(fleet);
+    options.maxSteps = 3;
+    const RunResult short3 = wide.run(options);
+    const RunRecord* kept = wide.findRun(short3.record.runId);
+    // Arena blocks at most double the encoded bytes; layouts add an id and a length per vehicle
+    const std::size_t bound = 2 * short3.record.logs.encodedBytes() + fleet.size() * (sizeof(int) + sizeof(double)) + 4096;
+    if (kept && short3.record.logs.byteSize() <= bound && kept->logs.byteSize() <= bound &&
+        kept->logs.back().positions.back().x == short3.record.logs.back().positions.back().x)
+        std::cout << "PASS: Finished log holds " << short3.record.logs.byteSize() << " bytes for "
+                  << short3.record.logs.encodedBytes() << " encoded, in the result and in the history.\n";
+    else
+        std::cout << "FAIL: Finished log holds " << short3.record.logs.byteSize() << " bytes (history "
+                  << (kept ? kept->logs.byteSize() : 0) << ") for " << short3.record.logs.encodedBytes() << " encoded.\n";
+
+    // Recording after finish() starts over from a keyframe
+    RunLog reopened = short3.record.logs;
+    reopened.record(1.0, wide.getVehicleStore());
+    reopened.record(1.1, wide.getVehicleStore());
+    if (reopened.size() == 5 && reopened.back().positions.back().x == wide.getVehicles().back().x)
+        std::cout << "PASS: A finished log records further steps correctly.\n";
+    else
+        std::cout << "FAIL: Recording after finish() decoded " << reopened.back().positions.back().x << ".\n";
+
+    std::cout << "Test LogArena complete.\n\n";
+}
+
+/**
+ * @brief Test the run-history index and the time and trajectory queries.
+ *
+ * Lookups by run ID must find the right run among thousands, the step at a
+ * time must be the closest logged one, and a vehicle's track must match the
+ * replayed log, for in-memory and streamed logs alike.
+ */
+void testRunHistoryQueries() {
+    std::cout << "[TEST] RunHistoryQueries\n";
+    Settings s{0.1, 0.5, "m/s", true};
+    s.logKeyframeInterval = 16;
+    Settings streamed = s;
+    streamed.logFile = "manualtests_history.vlog";
+    std::vector<Vehicle> fleet;
+    for (int i = 0; i < 6; i++) {
+        fleet.push_back(Vehicle{i, 0, i * 10.0, 4.0 + i, 0, 4.0});
+    }
+    RunOptions options;
+    options.maxSimTime = 0;
+    options.maxSteps = 40;
+
+    Simulation sim(s);
+    sim.addVehicles(fleet);
+    for (int r = 0; r < 5000; r++) sim.run(options);
+    const RunRecord* run = sim.findRun(4321);
+    LogEntry at;
+    bool found = run && run->runId == 4321 && !sim.findRun(5001) && sim.positionsAt(4321, 3.2, at) &&
+                 std::fabs(at.time - 3.2) < 1e-9 && at.positions.size() == fleet.size() &&
+                 !sim.positionsAt(99999, 3.2, at);
+    if (found)
+        std::cout << "PASS: Found run 4321 of 5000 and its step at t=3.2s.\n";
+    else
+        std::cout << "FAIL: Run lookup or time query failed.\n";
+
+    bool tracks = true;
+    Simulation disk(streamed);
+    disk.addVehicles(fleet);
+    options.maxSteps = 300;
+    disk.run(options);
+    RunResult result = disk.run(options);
+    const RunLog* logs[] = {found ? &run->logs : &result.record.logs, &result.record.logs};
+    for (const RunLog* log : logs) {
+        std::vector<TrajectoryPoint> track = log->trajectory(3, 1.05, 2.55);
+        std::vector<TrajectoryPoint> expected;
+        for (const LogEntry& e : *log) {
+            if (e.time >= 1.05 && e.time <= 2.55) {
+                const Vehicle& v = e.positions[3];
+                expected.push_back(TrajectoryPoint{e.time, v.x, v.y, v.speed, v.direction});
+            }
+        }
+        tracks = tracks && !track.empty() && track.size() == expected.size();
+        for (size_t k = 0; tracks && k < track.size(); k++) {
+            tracks = track[k].time == expected[k].time && track[k].x == expected[k].x && track[k].y == expected[k].y;
+        }
+        for (double t : {0.0, 0.1, 1.649, 1.651, 2.0, 100.0}) {
+            const size_t step = log->nearestStep(t);
+            const size_t first = log->lowerBound(t);
+            tracks = tracks && step < log->size() && log->atTime(t).time == log->timeAt(step) &&
+                     (first == log->size() || log->timeAt(first) >= t) && (first == 0 || log->timeAt(first - 1) < t);
+            for (size_t k = 0; tracks && k < log->size(); k += 7) {
+                tracks = std::fabs(log->timeAt(k) - t) >= std::fabs(log->timeAt(step) - t);
+            }
+        }
+    }
+    tracks = tracks && result.record.logs.isStreamed() && disk.vehicleTrack(result.record.runId, 3).size() == 300 &&
+             disk.vehicleTrack(result.record.runId, 42).empty();
+    std::remove(streamed.logFile.c_str());
+    if (tracks)
+        std::cout << "PASS: Time and trajectory queries match the replayed logs.\n";
+    else
+        std::cout << "FAIL: Time or trajectory query differs from the replayed log.\n";
+
+    std::cout << "Test RunHistoryQueries complete.\n\n";
+}
+
+/**
+ * @brief Test event-driven runs against fixed stepping.
+ *
+ * An event-driven run must end on the same step, with the same status and
+ * conflicts, as the fixed-step run of the same fleet, while visiting only a
+ * handful of steps when the vehicles are far apart.
+ */
+void testEventDriven() {
+    std::cout << "[TEST] EventDriven\n";
+    Settings s{0.1, 2.0, "m/s", true};
+    RunOptions fixed;
+    fixed.maxSimTime = 0;
+    fixed.maxSteps = 5000;
+    fixed.recordHistory = false;
+    RunOptions events = fixed;
+    events.eventDriven = true;
+
+    auto compare = [&](const std::vector<Vehicle>& fleet, RunResult& a, RunResult& b) {
+        Simulation simA(s);
+        Simulation simB(s);
+        simA.addVehicles(fleet);
+        simB.addVehicles(fleet);
+        a = simA.run(fixed);
+        b = simB.run(events);
+        bool same = a.record.status == b.record.status && a.stats.steps == b.stats.steps &&
+                    a.stats.simTime == b.stats.simTime && a.record.conflicts.size() == b.record.conflicts.size();
+        for (size_t k = 0; same && k < a.record.conflicts.size(); k++) {
+            const ConflictEvent& ca = a.record.conflicts[k];
+            const ConflictEvent& cb = b.record.conflicts[k];
+            same = ca.vehicleA == cb.vehicleA && ca.vehicleB == cb.vehicleB && ca.step == cb.step &&
+                   std::fabs(ca.closestDistance - cb.closestDistance) < 1e-6;
+        }
+        std::vector<Vehicle> va = simA.getVehicles();
+        std::vector<Vehicle> vb = simB.getVehicles();
+        for (size_t k = 0; same && k < va.size(); k++) {
+            same = std::fabs(va[k].x - vb[k].x) < 1e-6 && std::fabs(va[k].y - vb[k].y) < 1e-6;
+        }
+        return same;
+    };
+
+    // Sparse: two vehicles closing head-on from 2 km, others far away in parallel lanes
+    std::vector<Vehicle> sparse;
+    sparse.push_back(Vehicle{0, 0, 0, 10, 0, 4});
+    sparse.push_back(Vehicle{1, 2000, 0, 10, 180, 4});
+    for (int i = 2; i < 50; i++) {
+        sparse.push_back(Vehicle{i, i * 7.0, 100.0 * i, 15, 0, 4});
+    }
+    RunResult a;
+    RunResult b;
+    bool same = compare(sparse, a, b);
+    if (same && a.record.status == "Collision" && b.stats.iterations <= 4)
+        std::cout << "PASS: Sparse collision found on step " << b.stats.steps << " in "
+                  << b.stats.iterations << " iterations (fixed: " << a.stats.iterations << ").\n";
+    else
+        std::cout << "FAIL: Sparse event-driven run differs: status " << b.record.status << ", step "
+                  << b.stats.steps << " vs " << a.stats.steps << ", " << b.stats.iterations << " iterations.\n";
+
+    // Dense random fleets: every run must agree with fixed stepping
+    unsigned seed = 12345;
+    auto next = [&seed]() {
+        seed = seed * 1103515245u + 12345u;
+        return ((seed >> 8) & 0xFFFF) / 65536.0;
+    };
+    int agreed = 0;
+    int collisions = 0;
+    for (int trial = 0; trial < 20; trial++) {
+        std::vector<Vehicle> fleet;
+        for (int i = 0; i < 100; i++) {
+            fleet.push_back(Vehicle{i, next() * 20000, next() * 20000, 1 + next() * 20, next() * 360, 3 + next() * 3});
+        }
+        if (compare(fleet, a, b)) agreed++;
+        if (a.record.status == "Collision") collisions++;
+    }
+    if (agreed == 20 && collisions > 0)
+        std::cout << "PASS: 20 random fleets end identically (" << collisions << " collisions).\n";
+    else
+        std::cout << "FAIL: Only " << agreed << " of 20 random fleets agree.\n";
+
+    // Sampling: a run without contacts logs only its sample steps and stops on maxSimTime
+    std::vector<Vehicle> apart = {Vehicle{0, 0, 0, 10, 0, 4}, Vehicle{1, 0, 50, 10, 0, 4}};
+    Simulation sim(s);
+    sim.addVehicles(apart);
+    events.maxSteps = 0;
+    events.maxSimTime = 10.0;
+    events.sampleInterval = 2.5;
+    RunResult r = sim.run(events);
+    fixed.maxSteps = 0;
+    fixed.maxSimTime = 10.0;
+    Simulation ref(s);
+    ref.addVehicles(apart);
+    RunResult f = ref.run(fixed);
+    if (r.record.status == "Stopped" && r.stats.steps == f.stats.steps && r.record.logs.size() == 5 &&
+        std::fabs(r.record.logs.timeAt(1) - 5.0) < 1e-9 && r.record.logs.back().time == f.record.logs.back().time)
+        std::cout << "PASS: Sampled run logged " << r.record.logs.size() << " states over "
+                  << r.stats.steps << " steps.\n";
+    else
+        std::cout << "FAIL: Sampled run logged " << r.record.logs.size() << " states, stopped on step "
+                  << r.stats.steps << " vs " << f.stats.steps << ".\n";
+
+    std::cout << "Test EventDriven complete.\n\n";
+}
+
+/**
+ * @brief Test the road network, lane-bound vehicles and lane-neighbour collision checks.
+ *
+ * Lane vehicles must follow their polylines, conflict only with lane
+ * neighbours and free vehicles, and find the same first collision as
+ * free-space vehicles on straight lanes.
+ */
+void testRoadNetwork() {
+    std::cout << "[TEST] RoadNetwork\n";
+    std::string error;
+    RoadNetwork roads;
+    bool valid = roads.addLane(1, {-500, 500}, {0, 0}, error) && roads.addLane(2, {0, 0}, {-500, 500}, error) &&
+                 roads.addLane(3, {0, 100, 100}, {50, 50, 150}, error) &&
+                 !roads.addLane(1, {0, 1}, {0, 0}, error) && !roads.addLane(4, {0}, {0}, error) &&
+                 !roads.addLane(5, {0, 0, 1}, {0, 0, 1}, error) && !roads.setAdjacent(1, 9, error);
+    if (valid)
+        std::cout << "PASS: Road network rejects duplicate IDs, short and degenerate lanes.\n";
+    else
+        std::cout << "FAIL: Road network validation is wrong.\n";
+
+    // Lanes 1 and 2 cross at the origin on different levels; lane 3 turns a corner
+    Settings s{0.1, 2.0, "m/s", true};
+    RunOptions options;
+    options.maxSimTime = 0;
+    options.maxSteps = 100;
+    Simulation sim(s);
+    sim.setRoadNetwork(roads);
+    bool added = sim.addLaneVehicle(10, 1, 450, 10, 4, error) && sim.addLaneVehicle(20, 2, 450, 10, 4, error) &&
+                 sim.addLaneVehicle(30, 3, 90, 10, 4, error) && !sim.addLaneVehicle(40, 7, 0, 10, 4, error);
+    RunResult crossing = sim.run(options);
+    Vehicle corner = sim.getVehicles()[2];
+
+    Simulation free(s);
+    free.addVehicle(Vehicle{10, -50, 0, 10, 0, 4});
+    free.addVehicle(Vehicle{20, 0, -50, 10, 90, 4});
+    RunResult freeCrossing = free.run(options);
+    if (added && crossing.record.status == "Stopped" && freeCrossing.record.status == "Collision")
+        std::cout << "PASS: Vehicles on crossing lanes that are not adjacent do not conflict.\n";
+    else
+        std::cout << "FAIL: Crossing lanes status " << crossing.record.status << ". " << error << "\n";
+    if (std::fabs(corner.x - 100) < 1e-6 && std::fabs(corner.y - 140) < 1e-6 && std::fabs(corner.direction - 90) < 1e-9)
+        std::cout << "PASS: Lane vehicle followed the corner to (" << corner.x << ", " << corner.y << ").\n";
+    else
+        std::cout << "FAIL: Lane vehicle at (" << corner.x << ", " << corner.y << ") heading " << corner.direction << ".\n";
+
+    // Straight parallel lanes 50 m apart: lane checks must stop on the same step as free space
+    unsigned seed = 777;
+    auto next = [&seed]() {
+        seed = seed * 1103515245u + 12345u;
+        return ((seed >> 8) & 0xFFFF) / 65536.0;
+    };
+    RoadNetwork highway;
+    for (int lane = 0; lane < 4; lane++) {
+        highway.addLane(lane, {0, 1e6}, {lane * 50.0, lane * 50.0}, error);
+        if (lane > 0) highway.setAdjacent(lane, lane - 1, error);
+    }
+    Simulation onLanes(s);
+    Simulation inSpace(s);
+    onLanes.setRoadNetwork(highway);
+    int id = 0;
+    for (int lane = 0; lane < 4; lane++) {
+        for (int k = 0; k < 100; k++) {
+            const double x = k * 40.0 + next() * 5;
+            const double speed = 20 + next() * 4;
+            onLanes.addLaneVehicle(id, lane, x, speed, 4, error);
+            inSpace.addVehicle(Vehicle{id, x, lane * 50.0, speed, 0, 4});
+            id++;
+        }
+    }
+    for (int k = 0; k < 100; k++) {
+        // Free vehicles share the simulation but stay far from the road
+        onLanes.addVehicle(Vehicle{id, k * 50.0, -1000, 5, 0, 4});
+        inSpace.addVehicle(Vehicle{id, k * 50.0, -1000, 5, 0, 4});
+        id++;
+    }
+    options.maxSteps = 5000;
+    RunResult a = onLanes.run(options);
+    RunResult b = inSpace.run(options);
+    bool same = a.record.status == "Collision" && a.record.status == b.record.status &&
+                a.stats.steps == b.stats.steps && !a.record.conflicts.empty() &&
+                a.record.conflicts.front().vehicleA == b.record.conflicts.front().vehicleA &&
+                a.record.conflicts.front().vehicleB == b.record.conflicts.front().vehicleB;
+    if (same)
+        std::cout << "PASS: Lane neighbour check found the first collision on step " << a.stats.steps << ".\n";
+    else
+        std::cout << "FAIL: Lane check stopped on step " << a.stats.steps << " (" << a.record.status
+                  << "), free space on step " << b.stats.steps << " (" << b.record.status << ").\n";
+
+    // A free vehicle crossing a lane still conflicts with lane vehicles
+    Simulation mixed(s);
+    mixed.setRoadNetwork(roads);
+    mixed.addLaneVehicle(1, 1, 450, 10, 4, error);
+    mixed.addVehicle(Vehicle{2, 0, -50, 10, 90, 4});
+    options.maxSteps = 100;
+    RunResult m = mixed.run(options);
+    if (m.record.status == "Collision" && m.record.conflicts.size() == 1)
+        std::cout << "PASS: Free vehicle conflicts with a lane vehicle.\n";
+    else
+        std::cout << "FAIL: Free vehicle and lane vehicle status " << m.record.status << ".\n";
+
+    std::cout << "Test RoadNetwork complete.\n\n";
+}
+
+/**
+ * @brief Test the dynamics models and their batching by model.
+ *
+ * A braking vehicle must stop without reversing, a turning vehicle must
+ * drive a quarter circle, and an IDM follower must stop behind a standing
+ * leader that a constant-velocity follower runs into.
+ */
+void testDynamics() {
+    std::cout << "[TEST] Dynamics\n";
+    Settings s{0.1, 2.0, "m/s", true};
+    RunOptions options;
+    options.maxSimTime = 0;
+    options.maxSteps = 100;
+
+    // 20 m/s braking at 5 m/s^2 stops after 4 s and 39 m (semi-implicit Euler)
+    Simulation braking(s);
+    ConstantAcceleration::Params brake;
+    brake.acceleration = -5;
+    braking.addVehicle(Vehicle{1, 0, 0, 20, 0, 4}, brake);
+    braking.addVehicle(Vehicle{2, 0, 1000, 0, 0, 4});
+    braking.run(options);
+    Vehicle stopped = braking.getVehicles()[0];
+    if (stopped.speed == 0 && almostEqual(stopped.x, 39, 1e-6))
+        std::cout << "PASS: Braking vehicle stopped at x = " << stopped.x << ".\n";
+    else
+        std::cout << "FAIL: Braking vehicle at x = " << stopped.x << " with speed " << stopped.speed << ".\n";
+
+    // 10 m/s at 9 deg/s for 10 s: a quarter circle of radius 10 / (9 pi / 180)
+    Simulation turning(s);
+    ConstantAcceleration::Params turn;
+    turn.yawRate = 9;
+    turning.addVehicle(Vehicle{1, 0, 0, 10, 0, 4}, turn);
+    turning.addVehicle(Vehicle{2, 0, 1000, 0, 0, 4});
+    turning.run(options);
+    Vehicle turned = turning.getVehicles()[0];
+    const double radius = 10 / (9 * std::acos(-1.0) / 180);
+    if (almostEqual(turned.direction, 90, 1e-9) && almostEqual(turned.x, radius, 1.0) && almostEqual(turned.y, radius, 1.0))
+        std::cout << "PASS: Turning vehicle drove a quarter circle to (" << turned.x << ", " << turned.y << ").\n";
+    else
+        std::cout << "FAIL: Turning vehicle at (" << turned.x << ", " << turned.y << ") heading " << turned.direction << ".\n";
+
+    // A follower approaches a standing vehicle on a lane, with a turning vehicle elsewhere
+    std::string error;
+    RoadNetwork road;
+    road.addLane(1, {0, 10000}, {0, 0}, error);
+    IntelligentDriver::Params idm;
+    idm.minGap = 4;
+    IntelligentDriver::Params broken = idm;
+    broken.desiredSpeed = 0;
+    Simulation following(s);
+    following.setRoadNetwork(road);
+    bool added = following.addLaneVehicle(1, 1, 500, 0, 4, error) &&
+                 following.addLaneVehicle(2, 1, 0, 20, 4, idm, error) &&
+                 !following.addLaneVehicle(3, 1, 100, 20, 4, broken, error) &&
+                 !following.addVehicle(Vehicle{3, 0, 0, 20, 0, 4}, broken, error);
+    following.addVehicle(Vehicle{4, 0, -1000, 10, 0, 4}, turn);
+    Simulation ramming(s);
+    ramming.setRoadNetwork(road);
+    ramming.addLaneVehicle(1, 1, 500, 0, 4, error);
+    ramming.addLaneVehicle(2, 1, 0, 20, 4, error);
+    options.maxSteps = 1000;
+    RunResult followed = following.run(options);
+    RunResult rammed = ramming.run(options);
+    const LaneIndex& lanes = following.getLaneIndex();
+    const double gap = lanes.arcOf(0) - lanes.arcOf(1) - 4;
+    Vehicle follower = following.getVehicles()[1];
+    Vehicle turner = following.getVehicles()[2];
+    if (added && followed.record.status == "Stopped" && rammed.record.status == "Collision" &&
+        follower.speed < 0.1 && gap > 2 && almostEqual(turner.direction, 900, 1e-6))
+        std::cout << "PASS: IDM follower stopped " << gap << " m behind the leader; constant velocity collided.\n";
+    else
+        std::cout << "FAIL: IDM run " << followed.record.status << ", gap " << gap << ", speed " << follower.speed
+                  << ", turner heading " << turner.direction << "; constant velocity run " << rammed.record.status << ".\n";
+
+    // A braking constant-acceleration leader ahead of an IDM follower: the
+    // follower must react to the leader's speed at the start of the step
+    VehicleStore store;
+    store.add(Vehicle{1, 30, 0, 10, 0, 4});
+    store.add(Vehicle{2, 0, 0, 10, 0, 4});
+    LaneIndex mixedLanes;
+    mixedLanes.reset(road);
+    mixedLanes.add(0, 0, 30);
+    mixedLanes.add(1, 0, 0);
+    const DynamicsContext before{store.speed().data(), store.length().data(), mixedLanes};
+    const double expected = 10 + IntelligentDriver::acceleration(idm, before, 1) * 0.1;
+    VehicleDynamics mixed;
+    mixed.add(0, brake);
+    mixed.add(1, idm);
+    mixed.step(store, mixedLanes, 0.1);
+    if (store.speed()[0] == 9.5 && store.speed()[1] == expected)
+        std::cout << "PASS: IDM follower reacted to its braking leader's speed at the start of the step.\n";
+    else
+        std::cout << "FAIL: Leader speed " << store.speed()[0] << ", follower speed " << store.speed()[1]
+                  << " instead of " << expected << ".\n";
+
+    std::cout << "Test Dynamics complete.\n\n";
+}
+
+/**
+ * @brief Test snapshots of a run and forks continuing from them.
+ *
+ * A fork with unchanged settings must end exactly like the uninterrupted
+ * run, with the same steps and log, while sharing the snapshot's unchanged
+ * vehicle columns. A fork with a larger safety distance must branch off
+ * into a collision, and the snapshot must survive being forked.
+ */
+void testSnapshotFork() {
+    std::cout << "[TEST] SnapshotFork\n";
+    Settings s{0.1, 2.0, "m/s", true};
+    s.logKeyframeInterval = 8;
+    RunOptions options;
+    options.maxSimTime = 0;
+    options.maxSteps = 50;
+
+    // Two vehicles passing 10 m apart at t = 4.5 s
+    auto populate = [](Simulation& sim) {
+        sim.addVehicle(Vehicle{1, 0, 0, 10, 0, 4});
+        sim.addVehicle(Vehicle{2, 90, 10, 10, 180, 4});
+    };
+    Simulation full(s);
+    populate(full);
+    RunResult whole = full.run(options);
+
+    Simulation prefix(s);
+    populate(prefix);
+    options.snapshotStep = 20;
+    RunResult cut = prefix.run(options);
+    std::shared_ptr<const SimulationSnapshot> snap = cut.snapshot;
+    options.snapshotStep = 0;
+
+    Simulation same(s, *snap);
+    const int sharedBefore = same.getVehicleStore().sharedColumns(snap->vehicles);
+    RunResult resumed = same.run(options);
+    const int sharedAfter = same.getVehicleStore().sharedColumns(snap->vehicles);
+    bool identical = resumed.record.status == whole.record.status && resumed.stats.steps == whole.stats.steps &&
+                     resumed.record.logs.size() == whole.record.logs.size();
+    for (size_t k = 0; identical && k < whole.record.logs.size(); k++) {
+        LogEntry a = whole.record.logs[k];
+        LogEntry b = resumed.record.logs[k];
+        identical = a.time == b.time && a.positions.size() == b.positions.size();
+        for (size_t i = 0; identical && i < a.positions.size(); i++) {
+            identical = almostEqual(a.positions[i].x, b.positions[i].x, 1e-9) &&
+                        almostEqual(a.positions[i].y, b.positions[i].y, 1e-9);
+        }
+    }
+    if (snap && snap->steps == 20 && identical && sharedBefore == 8 && sharedAfter == 6)
+        std::cout << "PASS: Fork at step 20 reproduced the full run, copying only the positions.\n";
+    else
+        std::cout << "FAIL: Fork status " << resumed.record.status << " after " << resumed.stats.steps
+                  << " steps, " << sharedBefore << " / " << sharedAfter << " shared columns.\n";
+
+    Settings wider = s;
+    wider.safetyDistance = 7;
+    Simulation cautious(wider, *snap);
+    RunResult branched = cautious.run(options);
+    options.eventDriven = true;
+    Simulation jumping(wider, *snap);
+    RunResult jumped = jumping.run(options);
+    if (branched.record.status == "Collision" && branched.stats.steps == 43 && jumped.record.status == "Collision" &&
+        jumped.stats.steps == 43 && snap->run.logs.size() == 20 && almostEqual(snap->vehicles.x()[0], 20, 1e-9))
+        std::cout << "PASS: Branches with a larger safety distance collided at step 43; the snapshot is unchanged.\n";
+    else
+        std::cout << "FAIL: Branch status " << branched.record.status << " at step " << branched.stats.steps
+                  << ", event-driven " << jumped.record.status << " at step " << jumped.stats.steps << ".\n";
+
+    // A snapshot of a large fleet leaves the log's encoder state behind, and its fork still records exactly
+    std::vector<Vehicle> fleet;
+    for (int i = 0; i < 20000; i++) fleet.push_back(Vehicle{i, (i % 200) * 20.0, (i / 200) * 20.0, 5.0, 0, 4.0});
+    Simulation wide(s);
+    wide.addVehicles(fleet);
+    RunOptions wideOptions;
+    wideOptions.maxSimTime = 0;
+    wideOptions.maxSteps = 6;
+    wideOptions.snapshotStep = 3;
+    RunResult wideRun = wide.run(wideOptions);
+    const RunLog& prefix3 = wideRun.snapshot->run.logs;
+    // Arena blocks at most double the encoded bytes; layouts add an id and a length per vehicle
+    const std::size_t bound = 2 * prefix3.encodedBytes() + fleet.size() * (sizeof(int) + sizeof(double)) + 4096;
+    wideOptions.snapshotStep = 0;
+    Simulation wideFork(s, *wideRun.snapshot);
+    RunResult wideResumed = wideFork.run(wideOptions);
+    const RunLog& forkLog = wideResumed.record.logs;
+    if (prefix3.size() == 3 && prefix3.byteSize() <= bound && forkLog.size() == wideRun.record.logs.size() &&
+        forkLog.back().positions.back().x == wideRun.record.logs.back().positions.back().x &&
+        forkLog.at(3).positions[777].y == wideRun.record.logs.at(3).positions[777].y)
+        std::cout << "PASS: Snapshot log holds " << prefix3.byteSize() << " bytes for " << prefix3.encodedBytes()
+                  << " encoded; the fork's log matches the full run.\n";
+    else
+        std::cout << "FAIL: Snapshot log holds " << prefix3.byteSize() << " bytes for " << prefix3.encodedBytes()
+                  << " encoded; fork logged " << forkLog.size() << " steps.\n";
+
+    std::cout << "Test SnapshotFork complete.\n\n";
+}
+
+/**
+ * @brief Test the asynchronous output path and its sinks.
+ *
+ * A verbose run must reach a ring-buffer sink with large fleets sampled,
+ * a replay must reach it in full, a queue to a stalled sink must drop
+ * messages instead of blocking the writer, and an idle queue must wake for
+ * every message.
+ */
+void testOutputSink() {
+    std::cout << "[TEST] OutputSink\n";
+    Settings s{1.0, 5.0, "m/s", true};
+    Simulation sim(s);
+    for (int i = 0; i < 200; i++) {
+        sim.addVehicle(Vehicle{i, i * 100.0, 0, 1, 90, 4});
+    }
+    auto ring = std::make_shared<RingBufferSink>(1 << 16);
+    sim.setOutputSink(ring);
+    RunOptions options;
+    options.maxSimTime = 0;
+    options.maxSteps = 4;
+    options.verbose = true;
+    options.printEvery = 2;
+    options.printVehicles = 10;
+    sim.run(options);
+    sim.flushOutput();
+    std::string text = ring->contents();
+    const size_t times = static_cast<size_t>(std::count(text.begin(), text.end(), 'T'));
+    const bool sampled = text.find("(10 of 200 vehicles)") != std::string::npos &&
+                         text.find("Vehicle 20 at (2000, 2)") != std::string::npos &&
+                         text.find("Vehicle 21 at") == std::string::npos;
+    if (times == 2 && sampled && text.find("Step budget exhausted") != std::string::npos)
+        std::cout << "PASS: Every second step printed with 10 of 200 vehicles.\n";
+    else
+        std::cout << "FAIL: Verbose output was:\n" << text << "\n";
+
+    auto replay = std::make_shared<RingBufferSink>(1 << 20);
+    sim.setOutputSink(replay);
+    sim.replayRun(1, 0);
+    text = replay->contents();
+    if (text.find("=== Replay of Run 1 ===") != std::string::npos && text.find("Vehicle 199 Pos(19900, 4)") != std::string::npos)
+        std::cout << "PASS: Replay written in full to the sink.\n";
+    else
+        std::cout << "FAIL: Replay output was " << text.size() << " bytes.\n";
+
+    // A sink stuck in its first write must not block the producer
+    struct StalledSink : OutputSink {
+        std::atomic<bool> release{false};
+        void write(const char*, std::size_t) override {
+            while (!release.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    };
+    auto stalled = std::make_shared<StalledSink>();
+    size_t accepted = 0;
+    uint64_t dropped = 0;
+    {
+        AsyncOutput queue(stalled, 1024);
+        const std::string line(100, 'x');
+        for (int i = 0; i < 100; i++) {
+            if (queue.tryWrite(line)) accepted++;
+        }
+        dropped = queue.droppedMessages();
+        stalled->release = true;
+    }
+    auto nothing = std::make_shared<NullSink>();
+    {
+        AsyncOutput queue(nothing, 64);
+        queue.write(std::string(1000, 'y'));
+        queue.flush();
+    }
+    // An idle drain thread sleeps until text arrives, and every message after a pause still reaches the sink
+    auto quiet = std::make_shared<NullSink>();
+    {
+        AsyncOutput queue(quiet, 64);
+        for (int i = 0; i < 20; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            queue.tryWrite(std::string(10, 'z'));
+            queue.flush();
+        }
+    }
+    if (accepted >= 10 && accepted <= 20 && dropped == 100 - accepted && nothing->bytes() == 1000 &&
+        quiet->bytes() == 200)
+        std::cout << "PASS: Stalled sink: " << accepted << " messages queued, " << dropped << " dropped.\n";
+    else
+        std::cout << "FAIL: Stalled sink: " << accepted << " queued, " << dropped << " dropped; null sinks got "
+                  << nothing->bytes() << " and " << quiet->bytes() << " bytes.\n";
+
+    std::cout << "Test OutputSink complete.\n\n";
+}
+
+/**
+ * @brief Test the incremental collision check against the grid check.
+ *
+ * Pseudo-random fleets must end on the same step with the same conflicts
+ * with and without incremental checking, for constant-velocity, lane-bound
+ * and car-following vehicles. In a platoon moving together, almost every
+ * candidate pair must be skipped.
+ */
+void testIncrementalCollision() {
+    std::cout << "[TEST] IncrementalCollision\n";
+    unsigned int seed = 4242;
+    auto next = [&seed]() {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 8) / double(1u << 24);
+    };
+    auto sameRun = [](const RunResult& a, const RunResult& b) {
+        if (a.record.status != b.record.status || a.stats.steps != b.stats.steps ||
+            a.record.conflicts.size() != b.record.conflicts.size()) return false;
+        for (size_t k = 0; k < a.record.conflicts.size(); k++) {
+            if (a.record.conflicts[k].vehicleA != b.record.conflicts[k].vehicleA ||
+                a.record.conflicts[k].vehicleB != b.record.conflicts[k].vehicleB) return false;
+        }
+        return true;
+    };
+
+    RunOptions options;
+    options.maxSimTime = 0;
+    options.maxSteps = 3000;
+    RunOptions incremental = options;
+    incremental.incrementalCollision = true;
+
+    int matching = 0;
+    std::string mismatch;
+    for (int trial = 0; trial < 12; trial++) {
+        Settings s{0.05 + 0.05 * (trial % 3), 1.0 + trial % 4, "m/s", false};
+        const int n = 100 + 50 * trial;
+        const double side = 800.0 * std::sqrt(static_cast<double>(n));
+        std::vector<Vehicle> fleet;
+        for (int i = 0; i < n; i++) {
+            fleet.push_back(Vehicle{i, next() * side, next() * side, 2 + next() * 15, next() * 360, 3 + next() * 3});
+        }
+        Simulation grid(s);
+        Simulation coherent(s);
+        grid.addVehicles(fleet);
+        coherent.addVehicles(fleet);
+        RunResult a = grid.run(options);
+        RunResult b = coherent.run(incremental);
+        if (sameRun(a, b)) matching++;
+        else mismatch = "trial " + std::to_string(trial) + ": " + a.record.status + " at " + std::to_string(a.stats.steps) +
+                        " vs " + b.record.status + " at " + std::to_string(b.stats.steps);
+    }
+
+    // Lane-bound car-following traffic plus free vehicles crossing the road
+    std::string error;
+    RoadNetwork road;
+    road.addLane(1, {0, 5000}, {0, 0}, error);
+    road.addLane(2, {0, 5000}, {4, 4}, error);
+    road.setAdjacent(2, 1, error);
+    auto populate = [&](Simulation& sim) {
+        sim.setRoadNetwork(road);
+        IntelligentDriver::Params idm;
+        for (int k = 0; k < 60; k++) {
+            sim.addLaneVehicle(k, 1 + k % 2, 40.0 * (k / 2) + 20 * (k % 2), 10 + (k % 7), 4, idm, error);
+        }
+        for (int k = 0; k < 10; k++) {
+            sim.addVehicle(Vehicle{100 + k, 1500.0 + 97 * k, -300.0 - 40 * k, 8, 90, 4});
+        }
+    };
+    Settings laneSettings{0.1, 1.0, "m/s", false};
+    Simulation laneGrid(laneSettings);
+    Simulation laneCoherent(laneSettings);
+    populate(laneGrid);
+    populate(laneCoherent);
+    RunResult la = laneGrid.run(options);
+    RunResult lb = laneCoherent.run(incremental);
+    const bool lanesMatch = sameRun(la, lb);
+
+    if (matching == 12 && lanesMatch)
+        std::cout << "PASS: 12 random fleets and a lane scenario (" << la.record.status << " at step "
+                  << la.stats.steps << ") match the grid check.\n";
+    else
+        std::cout << "FAIL: " << matching << " of 12 random fleets match (" << mismatch << "); lane scenario "
+                  << la.record.status << " at " << la.stats.steps << " vs " << lb.record.status << " at " << lb.stats.steps << ".\n";
+
+    // A platoon of 2000 vehicles moving together: pairs never close in
+    Settings platoonSettings{0.1, 2.0, "m/s", false};
+    Simulation platoon(platoonSettings);
+    std::vector<Vehicle> column;
+    for (int i = 0; i < 2000; i++) {
+        column.push_back(Vehicle{i, (i % 100) * 12.0, (i / 100) * 8.0, 25, 0, 4});
+    }
+    platoon.addVehicles(column);
+    incremental.maxSteps = 50;
+    RunResult p = platoon.run(incremental);
+    const IncrementalCollider& c = platoon.getIncrementalCollider();
+    const double fraction = c.candidatePairs() > 0 ? 1.0 - double(c.skippedPairs()) / c.candidatePairs() : 1.0;
+    if (p.record.status == "Stopped" && c.candidatePairs() > 1000 && fraction < 0.01)
+        std::cout << "PASS: Platoon re-examined " << fraction * 100 << "% of " << c.candidatePairs()
+                  << " candidate pairs in the last step.\n";
+    else
+        std::cout << "FAIL: Platoon " << p.record.status << ", re-examined " << fraction * 100 << "% of "
+                  << c.candidatePairs() << " pairs.\n";
+
+    std::cout << "Test IncrementalCollision complete.\n\n";
+}
+
+/**
+ * @brief Tests fixed-point tiled coordinates against double runs, far from the origin and across thread counts.
+ */
+void testTiledCoordinates() {
+    std::cout << "[TEST] TiledCoordinates\n";
+    unsigned int seed = 777;
+    auto next = [&seed]() {
+        seed = seed * 1103515245u + 12345u;
+        return (seed >> 8) / double(1u << 24);
+    };
+    // Coordinates on a 1/1024 m grid, so shifting them by 1e9 m is exact
+    auto fleetAt = [&](int n, double side, double offset) {
+        std::vector<Vehicle> fleet;
+        for (int i = 0; i < n; i++) {
+            const double x = std::floor(next() * side * 1024) / 1024;
+            const double y = std::floor(next() * side * 1024) / 1024;
+            fleet.push_back(Vehicle{i, offset + x, offset + y, 2 + next() * 15, next() * 360, 3 + next() * 3});
+        }
+        return fleet;
+    };
+    auto sameConflicts = [](const RunResult& a, const RunResult& b) {
+        if (a.record.status != b.record.status || a.stats.steps != b.stats.steps ||
+            a.record.conflicts.size() != b.record.conflicts.size()) return false;
+        for (size_t k = 0; k < a.record.conflicts.size(); k++) {
+            const ConflictEvent& p = a.record.conflicts[k];
+            const ConflictEvent& q = b.record.conflicts[k];
+            if (p.vehicleA != q.vehicleA || p.vehicleB != q.vehicleB || p.distance != q.distance ||
+                p.closestDistance != q.closestDistance) return false;
+        }
+        return true;
+    };
+
+    RunOptions options;
+    options.maxSimTime = 0;
+    options.maxSteps = 3000;
+    RunOptions tiled = options;
+    tiled.tiledCoordinates = true;
+
+    // Same collision steps and pairs as double runs near the origin
+    int matching = 0;
+    for (int trial = 0; trial < 6; trial++) {
+        Settings s{0.05 + 0.05 * (trial % 3), 1.0 + trial % 4, "m/s", false};
+        const int n = 100 + 80 * trial;
+        std::vector<Vehicle> fleet = fleetAt(n, 800.0 * std::sqrt(static_cast<double>(n)), 0.0);
+        Simulation doubles(s);
+        Simulation fixed(s);
+        doubles.addVehicles(fleet);
+        fixed.addVehicles(fleet);
+        RunResult a = doubles.run(options);
+        RunResult b = fixed.run(tiled);
+        bool same = a.record.status == b.record.status && a.stats.steps == b.stats.steps &&
+                    a.record.conflicts.size() == b.record.conflicts.size();
+        for (size_t k = 0; same && k < a.record.conflicts.size(); k++) {
+            same = a.record.conflicts[k].vehicleA == b.record.conflicts[k].vehicleA &&
+                   a.record.conflicts[k].vehicleB == b.record.conflicts[k].vehicleB &&
+                   std::fabs(a.record.conflicts[k].closestDistance - b.record.conflicts[k].closestDistance) < 1e-3;
+        }
+        if (same) matching++;
+    }
+    if (matching == 6)
+        std::cout << "PASS: 6 random fleets collide on the same steps with tiled and double coordinates.\n";
+    else
+        std::cout << "FAIL: Only " << matching << " of 6 random fleets match the double runs.\n";
+
+    // The same scenario 1e9 m from the origin gives bit-identical decisions
+    Settings s{0.1, 1.0, "m/s", false};
+    const unsigned int scenarioSeed = seed;
+    std::vector<Vehicle> nearFleet = fleetAt(400, 16000.0, 0.0);
+    seed = scenarioSeed;
+    std::vector<Vehicle> farFleet = fleetAt(400, 16000.0, 1e9);
+    Simulation near(s);
+    Simulation far(s);
+    near.addVehicles(nearFleet);
+    far.addVehicles(farFleet);
+    RunResult rn = near.run(tiled);
+    RunResult rf = far.run(tiled);
+    bool shifted = true;
+    const VehicleStore& nv = near.getVehicleStore();
+    const VehicleStore& fv = far.getVehicleStore();
+    for (size_t i = 0; i < nv.size(); i++) {
+        shifted = shifted && fv.x()[i] - nv.x()[i] == 1e9 && fv.y()[i] - nv.y()[i] == 1e9;
+    }
+    if (sameConflicts(rn, rf) && shifted && !rn.record.conflicts.empty())
+        std::cout << "PASS: Fleet 1e9 m out collides identically (" << rf.record.status << " at step "
+                  << rf.stats.steps << ") and ends exactly 1e9 m from the near fleet.\n";
+    else
+        std::cout << "FAIL: Far fleet " << rf.record.status << " at " << rf.stats.steps << " vs near " << rn.record.status
+                  << " at " << rn.stats.steps << ", exact shift " << shifted << ".\n";
+
+    // Thread count does not change positions or conflicts
+    Settings serialSettings{0.1, 1.0, "m/s", false};
+    Settings parallelSettings = serialSettings;
+    parallelSettings.threadCount = 4;
+    std::vector<Vehicle> big = fleetAt(20000, 300000.0, 1e9);
+    Simulation serial(serialSettings);
+    Simulation parallel(parallelSettings);
+    serial.addVehicles(big);
+    parallel.addVehicles(big);
+    RunOptions shortRun = tiled;
+    shortRun.maxSteps = 200;
+    RunResult rs = serial.run(shortRun);
+    RunResult rp = parallel.run(shortRun);
+    const bool samePositions = serial.getVehicleStore().x() == parallel.getVehicleStore().x() &&
+                               serial.getVehicleStore().y() == parallel.getVehicleStore().y();
+    if (sameConflicts(rs, rp) && samePositions)
+        std::cout << "PASS: 20000 vehicles on 1 and 4 threads end identically (" << rs.record.status << " at step "
+                  << rs.stats.steps << ").\n";
+    else
+        std::cout << "FAIL: Serial " << rs.record.status << " at " << rs.stats.steps << " vs parallel "
+                  << rp.record.status << " at " << rp.stats.steps << ", same positions " << samePositions << ".\n";
+
+    std::cout << "Test TiledCoordinates complete.\n\n";
+}
+
+/**
+ * @brief Tests the Philox generator and the reproducibility and early stopping of Monte Carlo estimates.
+ */
+void testMonteCarlo() {
+    std::cout << "[TEST] MonteCarlo\n";
+
+    // Known-answer vectors of the Random123 reference implementation
+    const std::uint32_t zeroCounter[4] = {0, 0, 0, 0};
+    const std::uint32_t zeroKey[2] = {0, 0};
+    const std::uint32_t piCounter[4] = {0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u};
+    const std::uint32_t piKey[2] = {0xa4093822u, 0x299f31d0u};
+    std::uint32_t a[4], b[4];
+    Philox::block(zeroCounter, zeroKey, a);
+    Philox::block(piCounter, piKey, b);
+    const bool known = a[0] == 0x6627e8d5u && a[1] == 0xe169c58du && a[2] == 0xbc57ac4cu && a[3] == 0x9b00dbd8u &&
+                       b[0] == 0xd16cfe09u && b[1] == 0x94fdccebu && b[2] == 0x5001e420u && b[3] == 0x24126ea1u;
+    // The SSE2 batch path gives the same words as single blocks
+    std::vector<std::uint32_t> words(4 * 11);
+    Philox::stream(0x123456789abcdefULL, 77, 5, 11, words.data());
+    bool batched = true;
+    for (std::uint32_t k = 0; k < 11; k++) {
+        const std::uint32_t counter[4] = {5 + k, 77, 0, 0};
+        const std::uint32_t key[2] = {0x89abcdefu, 0x01234567u};
+        std::uint32_t w[4];
+        Philox::block(counter, key, w);
+        batched = batched && std::equal(w, w + 4, words.begin() + 4 * k);
+    }
+    if (known && batched)
+        std::cout << "PASS: Philox matches the reference vectors and the batched stream matches single blocks.\n";
+    else
+        std::cout << "FAIL: Philox reference vectors " << known << ", batched stream " << batched << ".\n";
+
+    // Two vehicles approaching head-on whose headings are uncertain
+    MonteCarloConfig config;
+    config.settings = Settings{0.1, 1.0, "m/s", true};
+    config.vehicles = {Vehicle{1, 0, 0, 10, 0, 4}, Vehicle{2, 100, 0, 10, 180, 4}};
+    config.options.maxSimTime = 10.0;
+    config.headingSigma = 3.0;
+    config.speedSigma = 1.0;
+    config.seed = 2024;
+    config.batchSize = 100;
+    config.minReplicas = 200;
+    config.targetHalfWidth = 0.03;
+    config.maxReplicas = 5000;
+
+    std::vector<std::size_t> progress;
+    MonteCarloEstimate serial = MonteCarlo(config, 1).run([&](const MonteCarloEstimate& e) {
+        progress.push_back(e.replicas);
+    });
+    MonteCarloEstimate parallel = MonteCarlo(config, 4).run();
+    const bool same = serial.replicas == parallel.replicas && serial.collisions == parallel.collisions &&
+                      serial.histogram == parallel.histogram && serial.meanTimeToConflict == parallel.meanTimeToConflict;
+    if (same && serial.converged && serial.replicas < config.maxReplicas && progress.size() == serial.batches &&
+        serial.collisionRate > 0.3 && serial.collisionRate < 0.95 && serial.ciHigh - serial.ciLow <= 0.06)
+        std::cout << "PASS: Estimate " << serial.collisionRate << " [" << serial.ciLow << ", " << serial.ciHigh
+                  << "] converged after " << serial.replicas << " replicas, identical on 1 and 4 threads.\n";
+    else
+        std::cout << "FAIL: Estimate " << serial.collisionRate << " after " << serial.replicas << " replicas (converged "
+                  << serial.converged << "), parallel " << parallel.collisionRate << " after " << parallel.replicas << ".\n";
+
+    // Conflicts happen around t = 5 s, where the histogram should peak
+    std::size_t peak = 0;
+    for (std::size_t k = 1; k < serial.histogram.size(); k++) {
+        if (serial.histogram[k] > serial.histogram[peak]) peak = k;
+    }
+    if (serial.meanTimeToConflict > 4.0 && serial.meanTimeToConflict < 5.5 && peak >= 8 && peak <= 10)
+        std::cout << "PASS: Mean time to conflict " << serial.meanTimeToConflict << " s, histogram peaks in bin " << peak << ".\n";
+    else
+        std::cout << "FAIL: Mean time to conflict " << serial.meanTimeToConflict << " s, peak bin " << peak << ".\n";
+
+    std::cout << "Test MonteCarlo complete.\n\n";
+}
+
+/**
+ * @brief Tests pausing, stepping, stopping and observing a run on a background thread.
+ */
+void testAsyncRun() {
+    std::cout << "[TEST] AsyncRun\n";
+    // Polls until pred holds, for at most 10 s
+    auto waitFor = [](const std::function<bool()>& pred) {
+        for (int k = 0; k < 10000 && !pred(); k++) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return pred();
+    };
+
+    // A column of vehicles moving together never collides, so the run only ends when stopped
+    Settings s{0.1, 1.0, "m/s", false};
+    Simulation sim(s);
+    std::vector<Vehicle> column;
+    for (int i = 0; i < 5000; i++) {
+        column.push_back(Vehicle{i, (i % 100) * 20.0, (i / 100) * 20.0, 10, 0, 4});
+    }
+    sim.addVehicles(column);
+    RunOptions unlimited;
+    unlimited.maxSimTime = 0;
+
+    AsyncRun async(sim, unlimited, 1, true);
+    RunControl& control = async.control();
+    SimulationFrame frame;
+    control.step(5);
+    const bool stepped = waitFor([&] { return control.poll(frame) && frame.step == 5; });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    control.poll(frame);
+    const bool held = stepped && frame.step == 5 && std::fabs(frame.vehicles.x()[0] - 5.0) < 1e-9 && !async.finished();
+    if (held)
+        std::cout << "PASS: Paused run executed exactly 5 granted steps and held.\n";
+    else
+        std::cout << "FAIL: Paused run published step " << frame.step << ", finished " << async.finished() << ".\n";
+
+    // While running, every polled frame is one consistent step: all vehicles moved the same distance
+    control.resume();
+    int frames = 0;
+    bool consistent = true;
+    long long lastStep = 0;
+    bool monotonic = true;
+    for (int k = 0; k < 200; k++) {
+        if (!control.poll(frame)) continue;
+        const std::vector<double>& xs = frame.vehicles.x();
+        const double moved = xs[0] - column[0].x;
+        for (size_t i = 0; i < xs.size(); i += 97) {
+            consistent = consistent && std::fabs(xs[i] - column[i].x - moved) < 1e-6;
+        }
+        consistent = consistent && std::fabs(moved - frame.step * 1.0) < 1e-6;
+        monotonic = monotonic && frame.step >= lastStep;
+        lastStep = frame.step;
+        frames++;
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    control.stop();
+    const RunResult& result = async.wait();
+    control.poll(frame);
+    if (consistent && monotonic && frames == 200 && result.record.status == "Stopped" &&
+        frame.status == "Stopped" && frame.step == result.stats.steps && result.stats.steps > 5)
+        std::cout << "PASS: " << frames << " polled frames were consistent; stop ended the run at step "
+                  << result.stats.steps << ".\n";
+    else
+        std::cout << "FAIL: Frames consistent " << consistent << ", monotonic " << monotonic << ", status "
+                  << result.record.status << "/" << frame.status << " at " << frame.step << " of " << result.stats.steps << ".\n";
+
+    // A background run reaches the same collision as a blocking run
+    Settings crashSettings{0.1, 1.0, "m/s", true};
+    std::vector<Vehicle> headOn = {Vehicle{1, 0, 0, 10, 0, 4}, Vehicle{2, 100, 0, 10, 180, 4}};
+    Simulation blocking(crashSettings);
+    Simulation background(crashSettings);
+    blocking.addVehicles(headOn);
+    background.addVehicles(headOn);
+    RunOptions options;
+    options.maxSimTime = 20.0;
+    RunResult expected = blocking.run(options);
+    AsyncRun crash(background, options, 10);
+    const RunResult& got = crash.wait();
+    SimulationFrame last;
+    const bool published = crash.control().poll(last);
+    if (got.record.status == expected.record.status && got.stats.steps == expected.stats.steps && published &&
+        last.status == "Collision" && last.step == got.stats.steps)
+        std::cout << "PASS: Background run collided at step " << got.stats.steps << " like the blocking run.\n";
+    else
+        std::cout << "FAIL: Background run " << got.record.status << " at " << got.stats.steps << " vs "
+                  << expected.record.status << " at " << expected.stats.steps << ".\n";
+
+    std::cout << "Test AsyncRun complete.\n\n";
+}
+
+/**
+ * @brief Tests generational handles and adding and removing vehicles during a run.
+ */
+void testVehiclePool() {
+    std::cout << "[TEST] VehiclePool\n";
+    Settings s{0.1, 1.0, "m/s", true};
+    Simulation sim(s);
+    VehicleHandle a = sim.addVehicle(Vehicle{1, 0, 0, 10, 0, 4});
+    VehicleHandle b = sim.addVehicle(Vehicle{2, 0, 50, 10, 0, 4});
+    VehicleHandle c = sim.addVehicle(Vehicle{3, 0, 100, 10, 0, 4});
+    const bool removed = sim.removeVehicle(b) && !sim.removeVehicle(b);
+    VehicleHandle d = sim.addVehicle(Vehicle{4, 0, 150, 10, 0, 4});
+    Vehicle v;
+    // c moved into b's place, d reuses b's slot under a new generation
+    if (removed && d.slot == b.slot && d != b && !sim.getVehicle(b, v) && sim.indexOf(c) == 1 &&
+        sim.getVehicle(c, v) && v.id == 3 && sim.indexOf(a) == 0 && sim.indexOf(d) == 2 &&
+        !sim.findVehicle(2).valid() && sim.findVehicle(4) == d && sim.getVehicleStore().size() == 3)
+        std::cout << "PASS: Removed vehicle's handle is stale; the others still resolve after swap-and-pop.\n";
+    else
+        std::cout << "FAIL: Handles after removal: b index " << sim.indexOf(b) << ", c index " << sim.indexOf(c) << ".\n";
+
+    // Removing a lane vehicle relinks its follower and keeps the moved vehicle's dynamics model
+    std::string error;
+    RoadNetwork roads;
+    roads.addLane(1, {0, 1000}, {0, 0}, error);
+    Simulation lanes(s);
+    lanes.setRoadNetwork(roads);
+    IntelligentDriver::Params idm;
+    ConstantAcceleration::Params speedUp;
+    speedUp.acceleration = 2.0;
+    lanes.addLaneVehicle(1, 1, 100, 10, 4, idm, error);
+    lanes.addLaneVehicle(2, 1, 200, 10, 4, idm, error);
+    lanes.addLaneVehicle(3, 1, 300, 10, 4, idm, error);
+    lanes.addVehicle(Vehicle{4, 0, 500, 0, 0, 4}, speedUp);
+    lanes.removeVehicle(lanes.findVehicle(2));
+    const LaneIndex& index = lanes.getLaneIndex();
+    const std::uint32_t follower = lanes.indexOf(lanes.findVehicle(1));
+    const std::uint32_t leader = lanes.indexOf(lanes.findVehicle(3));
+    RunOptions tenSteps;
+    tenSteps.maxSimTime = 0;
+    tenSteps.maxSteps = 10;
+    lanes.run(tenSteps);
+    lanes.getVehicle(lanes.findVehicle(4), v);
+    if (index.boundCount() == 2 && index.leaderOf(follower) == leader && lanes.indexOf(lanes.findVehicle(4)) == 1 &&
+        std::fabs(v.speed - 2.0) < 1e-9)
+        std::cout << "PASS: Lane follower relinked to the next leader; moved vehicle kept its model.\n";
+    else
+        std::cout << "FAIL: Lane bound " << index.boundCount() << ", leader " << index.leaderOf(follower)
+                  << ", moved vehicle speed " << v.speed << ".\n";
+
+    // A stream of vehicles enters at x = 0 every 10 steps and leaves once past x = 60
+    auto traffic = [](bool intruder, bool tiledRun) {
+        Simulation flow(Settings{0.1, 1.0, "m/s", true});
+        RunOptions options;
+        options.maxSimTime = 0;
+        options.maxSteps = 200;
+        options.tiledCoordinates = tiledRun;
+        int nextId = 0;
+        options.beforeStep = [&nextId, intruder](Simulation& sim, long long step, double) {
+            if (step % 10 == 0) sim.addVehicle(Vehicle{nextId++, 0, 0, 10, 0, 4});
+            if (intruder && step == 150) sim.addVehicle(Vehicle{999, 59, 0, 10, 180, 4});
+            std::vector<int> leaving;
+            const VehicleStore& store = sim.getVehicleStore();
+            for (size_t i = 0; i < store.size(); i++) {
+                if (store.x()[i] > 60) leaving.push_back(store.id()[i]);
+            }
+            for (int id : leaving) sim.removeVehicle(sim.findVehicle(id));
+        };
+        RunResult result = flow.run(options);
+        bool consistent = true;
+        const VehicleStore& store = flow.getVehicleStore();
+        for (size_t i = 0; i < store.size(); i++) {
+            consistent = consistent && flow.indexOf(flow.findVehicle(store.id()[i])) == i;
+        }
+        return std::make_pair(result, consistent);
+    };
+    std::pair<RunResult, bool> flow = traffic(false, false);
+    const RunLog& log = flow.first.record.logs;
+    size_t fewest = log.front().positions.size(), most = 0;
+    for (const LogEntry& entry : log) {
+        fewest = std::min(fewest, entry.positions.size());
+        most = std::max(most, entry.positions.size());
+    }
+    std::vector<TrajectoryPoint> first = log.trajectory(0, 0, 1e9);
+    std::vector<TrajectoryPoint> sixth = log.trajectory(5, 0, 1e9);
+    if (flow.first.record.status == "Stopped" && flow.second && log.size() == 200 && fewest == 1 && most == 7 &&
+        first.size() == 61 && sixth.size() == 61 && std::fabs(first.back().time - 6.1) < 1e-9 &&
+        std::fabs(sixth.front().time - 5.1) < 1e-9)
+        std::cout << "PASS: Log recorded " << fewest << " to " << most
+                  << " vehicles; each track starts when its vehicle enters and ends when it leaves.\n";
+    else
+        std::cout << "FAIL: Flow run " << flow.first.record.status << ", " << fewest << " to " << most << " vehicles, tracks "
+                  << first.size() << "/" << sixth.size() << ", consistent " << flow.second << ".\n";
+
+    // Spawned vehicles are checked from their first step, with doubles and with tiles
+    std::pair<RunResult, bool> crash = traffic(true, false);
+    std::pair<RunResult, bool> tiledCrash = traffic(true, true);
+    const std::vector<ConflictEvent>& conflicts = crash.first.record.conflicts;
+    const bool intruderHit = !conflicts.empty() && (conflicts[0].vehicleA == 999 || conflicts[0].vehicleB == 999);
+    if (crash.first.record.status == "Collision" && intruderHit && tiledCrash.first.record.status == "Collision" &&
+        tiledCrash.first.stats.steps == crash.first.stats.steps && tiledCrash.second)
+        std::cout << "PASS: Vehicle spawned at step 150 collided at step " << crash.first.stats.steps << " in both modes.\n";
+    else
+        std::cout << "FAIL: Intruder run " << crash.first.record.status << " at " << crash.first.stats.steps
+                  << ", tiled " << tiledCrash.first.record.status << " at " << tiledCrash.first.stats.steps << ".\n";
+
+    // Bulk loads register a handle per vehicle after growing the table once, including into freed slots
+    Simulation bulk(s);
+    std::vector<Vehicle> batch;
+    for (int i = 0; i < 5000; i++) batch.push_back(Vehicle{i, i * 10.0, 0, 10, 0, 4});
+    bulk.addVehicles(batch);
+    bulk.removeVehicle(bulk.findVehicle(17));
+    bulk.removeVehicle(bulk.findVehicle(4321));
+    for (Vehicle& v : batch) v.id += 5000;
+    bulk.addVehicles(batch);
+    bool resolved = bulk.getVehicleStore().size() == 9998;
+    for (int id = 0; resolved && id < 10000; id++) {
+        const VehicleHandle h = bulk.findVehicle(id);
+        resolved = (id == 17 || id == 4321) ? !h.valid() : bulk.getVehicle(h, v) && v.id == id;
+    }
+    if (resolved)
+        std::cout << "PASS: Two bulk loads of 5000 vehicles resolve every handle by ID.\n";
+    else
+        std::cout << "FAIL: Bulk-loaded handles do not resolve.\n";
+
+    // Copies share the tables until one of them adds or removes a vehicle
+    VehiclePool pool;
+    for (int i = 0; i < 100; i++) pool.add(i);
+    VehiclePool copy = pool;
+    const bool sharedCopy = copy.shares(pool);
+    const VehicleHandle fresh = copy.add(100);
+    copy.remove(copy.indexOf(copy.find(7)));
+    if (sharedCopy && !copy.shares(pool) && pool.size() == 100 && copy.size() == 100 && pool.find(7).valid() &&
+        !copy.find(7).valid() && !pool.find(100).valid() && copy.indexOf(fresh) == 7 && pool.indexOf(pool.find(99)) == 99)
+        std::cout << "PASS: A copied pool shares its tables until it changes, leaving the original intact.\n";
+    else
+        std::cout << "FAIL: Copied pool shared " << sharedCopy << ", sizes " << pool.size() << " / " << copy.size() << ".\n";
+
+    std::cout << "Test VehiclePool complete.\n\n";
+}
+
+/**
+ * @brief Tests exporting runs as Arrow IPC trajectory files and reading them back in place.
+ */
+void testArrowExport() {
+    std::cout << "[TEST] ArrowExport\n";
+    Settings s{0.1, 1.0, "m/s", true};
+    Simulation sim(s);
+    sim.addVehicles({Vehicle{1, 0, 0, 10, 0, 4}, Vehicle{2, 0, 50, 12, 0, 4}, Vehicle{3, 0, 100, 5, 0, 4}});
+    RunOptions options;
+    options.maxSimTime = 2.0;
+    sim.run(options);
+    // A second run whose vehicles come and go grows the vehicle dictionary part-way
+    options.maxSimTime = 0;
+    options.maxSteps = 120;
+    int nextId = 100;
+    options.beforeStep = [&nextId](Simulation& run, long long step, double) {
+        if (step % 20 == 0) {
+            const int id = nextId++;
+            run.addVehicle(Vehicle{id, 0, 200.0 + 20 * (id - 100), 10, 0, 4});
+        }
+        if (step == 60) run.removeVehicle(run.findVehicle(3));
+    };
+    sim.run(options);
+
+    const std::string path = "manualtests_runs.arrow";
+    ArrowTrajectoryWriter writer(path, 50);
+    const RunRecord* runs[2] = {sim.findRun(1), sim.findRun(2)};
+    const bool written = writer.write(*runs[0]) && writer.write(*runs[1]) && writer.close();
+    ArrowTrajectoryFile file;
+    std::string error;
+    const bool opened = file.open(path, error);
+
+    // Walk the file's rows alongside the decoded logs
+    bool match = opened;
+    std::size_t batch = 0, row = 0;
+    std::uint64_t expected = 0;
+    for (const RunRecord* r : runs) {
+        std::int64_t step = 0;
+        for (const LogEntry& entry : r->logs) {
+            for (const Vehicle& v : entry.positions) {
+                expected++;
+                while (match && batch < file.batchCount() && row == file.batch(batch).rows) {
+                    batch++;
+                    row = 0;
+                }
+                if (!match || batch == file.batchCount()) {
+                    match = false;
+                    continue;
+                }
+                const ArrowTrajectoryBatch& b = file.batch(batch);
+                match = file.runIds()[b.runCode[row]] == r->runId && b.step[row] == step && b.time[row] == entry.time &&
+                        file.vehicleIds()[b.vehicleCode[row]] == v.id && b.x[row] == v.x && b.y[row] == v.y &&
+                        b.speed[row] == v.speed && b.heading[row] == v.direction;
+                row++;
+            }
+            step++;
+        }
+    }
+    if (written && match && file.rows() == expected && writer.rows() == expected && file.batchCount() == writer.batches() &&
+        file.batchCount() > 2 && file.vehicleIds().size() == 9 && file.runIds().size() == 2)
+        std::cout << "PASS: " << expected << " rows in " << file.batchCount()
+                  << " record batches read back bit-exact, with delta-grown dictionaries.\n";
+    else
+        std::cout << "FAIL: Arrow round trip: written " << written << ", opened " << opened << " (" << error << "), match "
+                  << match << ", rows " << file.rows() << " of " << expected << ".\n";
+
+    // The simulation exports its whole history or one run; bad input is rejected
+    const bool allRuns = sim.exportRuns(path, error) && file.open(path, error) && file.rows() == expected;
+    const bool oneRun = sim.exportRun(1, path, error) && file.open(path, error) && file.runIds().size() == 1;
+    file.close();
+    std::string unknown, missing, notArrow;
+    const bool rejected = !sim.exportRun(99, path, unknown) && !unknown.empty() &&
+                          !file.open("manualtests_missing.arrow", missing);
+    { std::ofstream text("manualtests_notarrow.txt"); text << "x,y\n1,2\n"; }
+    const bool rejectedText = !file.open("manualtests_notarrow.txt", notArrow) && !notArrow.empty();
+    std::remove("manualtests_notarrow.txt");
+    std::remove(path.c_str());
+    if (allRuns && oneRun && rejected && rejectedText)
+        std::cout << "PASS: History and single-run exports open; unknown runs and non-Arrow files are rejected.\n";
+    else
+        std::cout << "FAIL: All runs " << allRuns << ", one run " << oneRun << ", rejected " << rejected << "/" << rejectedText
+                  << ". " << error << "\n";
+
+    std::cout << "Test ArrowExport complete.\n\n";
+}
+
+/**
+ * @brief Runs one random scenario of N vehicles in both FixedSimulation<N> and Simulation and compares the outcomes.
+ *
+ * @param seed Seed of the scenario.
+ * @param side Side of the square the vehicles start in, in meters; smaller squares collide more often.
+ * @param maxSimTime Time limit of both runs.
+ * @param maxSteps Step limit of both runs.
+ * @param status Receives the fixed run's status.
+ * @return true if status, steps, time, conflicts and final positions are identical.
+ */
+template <std::size_t N>
+bool fixedMatchesSimulation(unsigned seed, double side, double maxSimTime, long long maxSteps, RunStatus& status) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::vector<Vehicle> fleet;
+    for (std::size_t i = 0; i < N; i++) {
+        fleet.emplace_back(static_cast<int>(i + 1), unit(rng) * side, unit(rng) * side, 5.0 + unit(rng) * 25.0,
+                           unit(rng) * 360.0, 3.0 + unit(rng) * 3.0);
+    }
+    Settings s{0.1, 2.0, "m/s", false};
+    Simulation sim(s);
+    sim.addVehicles(fleet);
+    RunOptions options;
+    options.maxSimTime = maxSimTime;
+    options.maxSteps = maxSteps;
+    options.recordHistory = false;
+    const RunResult expected = sim.run(options);
+
+    FixedSimulation<N> fixed(s, fleet.data());
+    const typename FixedSimulation<N>::Result r = fixed.run(maxSimTime, maxSteps);
+    status = r.status;
+
+    bool same = expected.record.status == statusName(r.status) && expected.stats.steps == r.steps &&
+                expected.stats.simTime == r.simTime && expected.record.conflicts.size() == r.conflictCount;
+    for (std::size_t k = 0; same && k < r.conflictCount; k++) {
+        const ConflictEvent& a = expected.record.conflicts[k];
+        const ConflictEvent& b = r.conflicts[k];
+        same = a.vehicleA == b.vehicleA && a.vehicleB == b.vehicleB && a.step == b.step && a.time == b.time &&
+               a.distance == b.distance && a.closestTime == b.closestTime && a.closestDistance == b.closestDistance;
+    }
+    const std::vector<Vehicle> end = sim.getVehicles();
+    for (std::size_t i = 0; same && i < N; i++) {
+        const Vehicle v = fixed.vehicle(i);
+        same = end[i].id == v.id && end[i].x == v.x && end[i].y == v.y;
+    }
+    return same;
+}
+
+/**
+ * @brief Tests that the fixed-size kernel reproduces Simulation runs exactly.
+ */
+void testFixedSimulation() {
+    std::cout << "[TEST] FixedSimulation\n";
+
+    // Crowded and sparse random scenarios, under time and step limits
+    int runs = 0;
+    int matched = 0;
+    int collisions = 0;
+    int stopped = 0;
+    auto tally = [&](bool same, RunStatus status) {
+        runs++;
+        matched += same;
+        collisions += status == RunStatus::Collision;
+        stopped += status == RunStatus::Stopped;
+    };
+    for (unsigned seed = 1; seed <= 20; seed++) {
+        RunStatus status = RunStatus::Running;
+        const double side = seed % 2 ? 60.0 : 600.0;
+        bool same = fixedMatchesSimulation<2>(seed, side / 2, 10.0, 0, status);
+        tally(same, status);
+        same = fixedMatchesSimulation<3>(seed, side, 8.0, 0, status);
+        tally(same, status);
+        same = fixedMatchesSimulation<8>(seed, side, 0.0, 40, status);
+        tally(same, status);
+        same = fixedMatchesSimulation<16>(seed, side * 2, 5.0, 0, status);
+        tally(same, status);
+    }
+    if (matched == runs && collisions > 0 && stopped > 0)
+        std::cout << "PASS: " << runs << " runs of 2 to 16 vehicles match Simulation bit for bit (" << collisions
+                  << " collisions, " << stopped << " stopped).\n";
+    else
+        std::cout << "FAIL: " << matched << " of " << runs << " runs match (" << collisions << " collisions, " << stopped
+                  << " stopped).\n";
+
+    // A reloaded kernel replays the same scenario
+    Settings s{0.1, 1.0, "m/s", false};
+    const Vehicle pair[2] = {Vehicle{1, 0, 0, 10, 0, 4}, Vehicle{2, 100, 0, 10, 180, 4}};
+    FixedSimulation<2> fixed(s, pair);
+    const FixedSimulation<2>::Result first = fixed.run(10.0);
+    fixed.load(pair);
+    const FixedSimulation<2>::Result second = fixed.run(10.0);
+    if (first.status == RunStatus::Collision && second.status == first.status && second.steps == first.steps &&
+        second.conflictCount == 1 && second.conflicts[0].vehicleA == 1 && second.conflicts[0].vehicleB == 2 &&
+        second.conflicts[0].distance == first.conflicts[0].distance)
+        std::cout << "PASS: Reloading the vehicles replays the head-on collision after " << second.steps << " steps.\n";
+    else
+        std::cout << "FAIL: Head-on replay: status " << statusName(second.status) << " after " << second.steps << " steps.\n";
+
+    const FixedSimulation<2>::Result unbounded = fixed.run(0.0, 0);
+    if (unbounded.status == RunStatus::Unbounded && unbounded.steps == 0)
+        std::cout << "PASS: Run without limits was rejected, as by Simulation.\n";
+    else
+        std::cout << "FAIL: Run without limits ended with status " << statusName(unbounded.status) << ".\n";
+
+    std::cout << "Test FixedSimulation complete.\n\n";
+}
+
 /**
  * @brief Main function to run all manual tests.
  * 
@@ -183,5 +2154,29 @@ int main() {
     testNoCollision();
     testHistoryRecording();
     testReplayRun();
+    testHeadlessRun();
+    testVectorizedIntegration();
+    testGridBroadPhase();
+    testConflictEvents();
+    testCompressedLog();
+    testScenarioBatch();
+    testParallelStep();
+    testScenarioFiles();
+    testStreamedLog();
+    testTelemetry();
+    testLogArena();
+    testRunHistoryQueries();
+    testEventDriven();
+    testRoadNetwork();
+    testDynamics();
+    testSnapshotFork();
+    testOutputSink();
+    testIncrementalCollision();
+    testTiledCoordinates();
+    testMonteCarlo();
+    testAsyncRun();
+    testVehiclePool();
+    testArrowExport();
+    testFixedSimulation();
     return 0;
 }
\ No newline at end of file
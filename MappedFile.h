@@ -0,0 +1,70 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/**
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * Wraps mmap on POSIX systems and CreateFileMapping/MapViewOfFile on Windows.
+ * The mapping is released when the object is destroyed or close() is called.
+ */
+class MappedFile {
+private:
+    const unsigned char* base = nullptr; /**< Start of the mapped bytes, or null. */
+    std::size_t length = 0;              /**< Size of the mapping in bytes. */
+#ifdef _WIN32
+    void* fileHandle = nullptr;          /**< Windows file handle. */
+    void* mappingHandle = nullptr;       /**< Windows file-mapping handle. */
+#endif
+
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Maps a file read-only, replacing any previous mapping.
+     *
+     * An empty file maps successfully with size() 0 and a null data().
+     *
+     * @param path Path of the file to map.
+     * @param error Receives a description of the failure, if any.
+     * @return true on success, false otherwise.
+     */
+    bool open(const std::string& path, std::string& error);
+
+    /**
+     * @brief Releases the mapping.
+     */
+    void close();
+
+    /**
+     * @brief Returns true if a file is mapped.
+     */
+    bool isOpen() const { return base != nullptr; }
+
+    const unsigned char* data() const { return base; } /**< @brief Start of the mapped bytes. */
+    std::size_t size() const { return length; }        /**< @brief Size of the mapping in bytes. */
+};
+
+/**
+ * @brief Returns true if the host stores integers little-endian.
+ *
+ * The project's binary formats (scenario files, run-log chunks, Arrow IPC
+ * files) are little-endian and are read by mapping them in place, so their
+ * readers and writers refuse other hosts.
+ */
+inline bool littleEndian() {
+    const std::uint16_t probe = 1;
+    unsigned char first;
+    std::memcpy(&first, &probe, 1);
+    return first == 1;
+}
+
+#endif // MAPPEDFILE_H
@@ -0,0 +1,114 @@
+#define _USE_MATH_DEFINES
+#include "MonteCarlo.h"
+#include "Philox.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+/**
+ * @brief Creates an estimator.
+ *
+ * @param c The scenario and stopping rule.
+ * @param threads Number of worker threads; 0 uses the hardware thread count.
+ */
+MonteCarlo::MonteCarlo(MonteCarloConfig c, std::size_t threads)
+    : config(std::move(c)), threadCount(threads) {}
+
+/**
+ * @brief Builds the perturbed vehicle set of one replica.
+ *
+ * Vehicle k uses block k of the replica's stream: its first two words give
+ * two independent standard normals by the Box-Muller transform, scaled by
+ * speedSigma and headingSigma. Perturbed speeds are clamped at 0.
+ *
+ * @param replica Index of the replica.
+ * @param out Receives the vehicles; its previous contents are replaced.
+ */
+void MonteCarlo::perturb(std::uint64_t replica, std::vector<Vehicle>& out) const {
+    const std::size_t n = config.vehicles.size();
+    std::vector<std::uint32_t> words(4 * n);
+    Philox::stream(config.seed, replica, 0, n, words.data());
+
+    out = config.vehicles;
+    for (std::size_t k = 0; k < n; k++) {
+        const double radius = std::sqrt(-2.0 * std::log(Philox::uniform(words[4 * k])));
+        const double angle = 2.0 * M_PI * Philox::uniform(words[4 * k + 1]);
+        out[k].speed = std::max(0.0, out[k].speed + config.speedSigma * radius * std::cos(angle));
+        out[k].direction += config.headingSigma * radius * std::sin(angle);
+    }
+}
+
+/**
+ * @brief Runs batches of replicas until the interval converges or maxReplicas is reached.
+ *
+ * The collision rate's interval is the Wilson score interval, which stays
+ * inside [0, 1] and does not collapse when no or every replica collides.
+ * The estimate stops early once at least minReplicas replicas ran and its
+ * half-width is at most targetHalfWidth.
+ *
+ * @param onBatch Optional callback given the estimate after every batch.
+ * @return MonteCarloEstimate The final estimate.
+ */
+MonteCarloEstimate MonteCarlo::run(const std::function<void(const MonteCarloEstimate&)>& onBatch) const {
+    MonteCarloEstimate estimate;
+    estimate.histogram.assign(config.histogramBins, 0);
+    if (config.maxReplicas == 0) return estimate;
+
+    Scenario base;
+    base.settings = config.settings;
+    base.settings.enableLogging = false;
+    base.settings.logFile.clear();
+    base.settings.threadCount = 1;
+    base.options = config.options;
+
+    std::size_t threads = threadCount;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    const std::size_t batch = std::max<std::size_t>(config.batchSize, 1);
+    ThreadPool pool(std::min(threads, batch));
+    std::vector<ScenarioSummary> results(batch);
+    double conflictTimeSum = 0.0;
+
+    while (estimate.replicas < config.maxReplicas) {
+        const std::size_t first = estimate.replicas;
+        const std::size_t count = std::min(batch, config.maxReplicas - first);
+        for (std::size_t k = 0; k < count; k++) {
+            pool.submit([this, &base, &results, first, k] {
+                Scenario s = base;
+                perturb(first + k, s.vehicles);
+                results[k] = ScenarioBatch::runOne(s, first + k);
+            });
+        }
+        pool.wait();
+
+        // Fold in replica order so sums are rounded the same for every thread count
+        for (std::size_t k = 0; k < count; k++) {
+            const ScenarioSummary& r = results[k];
+            if (r.status != "Collision") continue;
+            estimate.collisions++;
+            conflictTimeSum += r.firstCollisionTime;
+            const double bin = std::floor(r.firstCollisionTime / config.histogramBinWidth);
+            if (bin >= 0 && bin < static_cast<double>(config.histogramBins)) {
+                estimate.histogram[static_cast<std::size_t>(bin)]++;
+            } else {
+                estimate.histogramOverflow++;
+            }
+        }
+        estimate.replicas += count;
+        estimate.batches++;
+
+        const double n = static_cast<double>(estimate.replicas);
+        const double p = estimate.collisions / n;
+        const double z2 = config.z * config.z;
+        const double centre = (p + z2 / (2 * n)) / (1 + z2 / n);
+        const double half = config.z * std::sqrt(p * (1 - p) / n + z2 / (4 * n * n)) / (1 + z2 / n);
+        estimate.collisionRate = p;
+        estimate.ciLow = std::max(0.0, centre - half);
+        estimate.ciHigh = std::min(1.0, centre + half);
+        estimate.meanTimeToConflict = estimate.collisions > 0 ? conflictTimeSum / estimate.collisions : 0.0;
+        estimate.converged = estimate.replicas >= config.minReplicas && half <= config.targetHalfWidth;
+
+        if (onBatch) onBatch(estimate);
+        if (estimate.converged) break;
+    }
+    return estimate;
+}
@@ -0,0 +1,88 @@
+#ifndef MONTECARLO_H
+#define MONTECARLO_H
+
+#include "ScenarioBatch.h"
+#include <vector>
+#include <functional>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief A base scenario, the uncertainty of its initial state and the stopping rule of an estimate.
+ */
+struct MonteCarloConfig {
+    Settings settings;             /**< Settings of every replica; logging is turned off and each replica runs serially. */
+    std::vector<Vehicle> vehicles; /**< The base vehicle set. */
+    RunOptions options;            /**< Run limits of every replica; pacing, printing and history are always off. */
+    double speedSigma = 0.0;       /**< Standard deviation of the initial speed, in the vehicles' speed unit. */
+    double headingSigma = 0.0;     /**< Standard deviation of the initial direction, in degrees. */
+    std::uint64_t seed = 0;        /**< Key of the random streams; replica r always draws from stream r. */
+    std::size_t batchSize = 256;   /**< Replicas run between two convergence checks. */
+    std::size_t minReplicas = 256; /**< Replicas run before the estimate may stop early. */
+    std::size_t maxReplicas = 100000; /**< Replicas after which the estimate stops regardless. */
+    double targetHalfWidth = 0.01; /**< Stop once the confidence interval of the collision rate is at most this wide on each side. */
+    double z = 1.96;               /**< Normal quantile of the confidence level (1.96 for 95%). */
+    double histogramBinWidth = 0.5; /**< Width of a time-to-conflict histogram bin, in seconds. */
+    std::size_t histogramBins = 20; /**< Number of histogram bins; later conflicts are counted as overflow. */
+};
+
+/**
+ * @brief Aggregate statistics over the replicas run so far.
+ */
+struct MonteCarloEstimate {
+    std::size_t replicas = 0;     /**< Replicas run. */
+    std::size_t collisions = 0;   /**< Replicas that ended in a collision. */
+    double collisionRate = 0.0;   /**< collisions / replicas. */
+    double ciLow = 0.0;           /**< Lower end of the Wilson score interval of the collision rate. */
+    double ciHigh = 1.0;          /**< Upper end of the Wilson score interval. */
+    double meanTimeToConflict = 0.0; /**< Mean first closest-approach time of the colliding replicas, in seconds. */
+    std::vector<std::size_t> histogram; /**< Colliding replicas per time-to-conflict bin. */
+    std::size_t histogramOverflow = 0;  /**< Colliding replicas past the last bin. */
+    std::size_t batches = 0;      /**< Batches run. */
+    bool converged = false;       /**< True if the estimate stopped because the interval was narrow enough. */
+};
+
+/**
+ * @brief Estimates collision probability under uncertain initial speeds and headings.
+ *
+ * Each replica perturbs every base vehicle's speed and direction with
+ * normal noise drawn from its own Philox stream (stream = replica index,
+ * block = vehicle index), so a replica's vehicles depend only on the seed
+ * and its index. Replicas run headless in batches on a work-stealing pool,
+ * one Simulation per replica as in ScenarioBatch. After each batch the
+ * results are folded into the estimate in replica order and the stopping
+ * rule is checked, so the estimate, including when it stops, is the same
+ * for every thread count.
+ */
+class MonteCarlo {
+private:
+    MonteCarloConfig config;   /**< The scenario and stopping rule. */
+    std::size_t threadCount;   /**< Worker count for run(); 0 means hardware concurrency. */
+
+public:
+    /**
+     * @brief Creates an estimator.
+     *
+     * @param c The scenario and stopping rule.
+     * @param threads Number of worker threads; 0 uses the hardware thread count.
+     */
+    explicit MonteCarlo(MonteCarloConfig c, std::size_t threads = 0);
+
+    /**
+     * @brief Builds the perturbed vehicle set of one replica.
+     *
+     * @param replica Index of the replica.
+     * @param out Receives the vehicles; its previous contents are replaced.
+     */
+    void perturb(std::uint64_t replica, std::vector<Vehicle>& out) const;
+
+    /**
+     * @brief Runs batches of replicas until the interval converges or maxReplicas is reached.
+     *
+     * @param onBatch Optional callback given the estimate after every batch.
+     * @return MonteCarloEstimate The final estimate.
+     */
+    MonteCarloEstimate run(const std::function<void(const MonteCarloEstimate&)>& onBatch = nullptr) const;
+};
+
+#endif // MONTECARLO_H
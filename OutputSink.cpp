@@ -0,0 +1,91 @@
+#include "OutputSink.h"
+#include <algorithm>
+#include <iostream>
+
+/**
+ * @brief Writes a block of text to std::cout.
+ */
+void ConsoleSink::write(const char* data, std::size_t size) {
+    std::cout.write(data, static_cast<std::streamsize>(size));
+}
+
+/**
+ * @brief Flushes std::cout.
+ */
+void ConsoleSink::flush() {
+    std::cout.flush();
+}
+
+/**
+ * @brief Creates (truncating) the file.
+ *
+ * @param path Path of the file.
+ */
+FileSink::FileSink(const std::string& path) {
+    file = std::fopen(path.c_str(), "wb");
+}
+
+/**
+ * @brief Closes the file.
+ */
+FileSink::~FileSink() {
+    if (file) std::fclose(file);
+}
+
+/**
+ * @brief Appends a block of text to the file; does nothing if it could not be opened.
+ */
+void FileSink::write(const char* data, std::size_t size) {
+    if (file) std::fwrite(data, 1, size, file);
+}
+
+/**
+ * @brief Flushes the file's stdio buffer.
+ */
+void FileSink::flush() {
+    if (file) std::fflush(file);
+}
+
+/**
+ * @brief Creates a ring holding the last capacity bytes.
+ *
+ * @param capacity Size of the ring in bytes (at least 1).
+ */
+RingBufferSink::RingBufferSink(std::size_t capacity)
+    : buffer(std::max<std::size_t>(capacity, 1)) {}
+
+/**
+ * @brief Appends text to the ring, overwriting the oldest bytes once it is full.
+ */
+void RingBufferSink::write(const char* data, std::size_t size) {
+    std::lock_guard<std::mutex> lock(mutex);
+    total += size;
+    if (size > buffer.size()) {
+        // Only the last capacity bytes can survive
+        data += size - buffer.size();
+        size = buffer.size();
+    }
+    const std::size_t first = std::min(size, buffer.size() - next);
+    std::copy(data, data + first, buffer.begin() + next);
+    std::copy(data + first, data + size, buffer.begin());
+    next = (next + size) % buffer.size();
+}
+
+/**
+ * @brief Returns the retained text, oldest byte first.
+ */
+std::string RingBufferSink::contents() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (total < buffer.size()) return std::string(buffer.begin(), buffer.begin() + next);
+    std::string out(buffer.begin() + next, buffer.end());
+    out.append(buffer.begin(), buffer.begin() + next);
+    return out;
+}
+
+/**
+ * @brief Returns the number of bytes written over the sink's lifetime.
+ */
+std::uint64_t RingBufferSink::bytesWritten() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return total;
+}
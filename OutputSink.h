@@ -0,0 +1,126 @@
+#ifndef OUTPUTSINK_H
+#define OUTPUTSINK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Destination of the simulation's text output.
+ *
+ * Sinks are written by the drain thread of an AsyncOutput, never by the
+ * simulation thread, so a slow sink only delays the output, not the run.
+ */
+class OutputSink {
+public:
+    virtual ~OutputSink() = default;
+
+    /**
+     * @brief Writes a block of text.
+     *
+     * @param data Start of the text.
+     * @param size Number of bytes.
+     */
+    virtual void write(const char* data, std::size_t size) = 0;
+
+    /**
+     * @brief Pushes buffered text to its destination.
+     */
+    virtual void flush() {}
+};
+
+/**
+ * @brief Writes to std::cout.
+ */
+class ConsoleSink : public OutputSink {
+public:
+    void write(const char* data, std::size_t size) override;
+    void flush() override;
+};
+
+/**
+ * @brief Writes to a file, truncated when the sink is created.
+ */
+class FileSink : public OutputSink {
+private:
+    std::FILE* file = nullptr; /**< The open file, or null if opening failed. */
+
+public:
+    /**
+     * @brief Creates (truncating) the file.
+     *
+     * @param path Path of the file.
+     */
+    explicit FileSink(const std::string& path);
+
+    /**
+     * @brief Closes the file.
+     */
+    ~FileSink() override;
+
+    FileSink(const FileSink&) = delete;
+    FileSink& operator=(const FileSink&) = delete;
+
+    /**
+     * @brief Returns true if the file was opened.
+     */
+    bool good() const { return file != nullptr; }
+
+    void write(const char* data, std::size_t size) override;
+    void flush() override;
+};
+
+/**
+ * @brief Discards the text, counting its bytes.
+ */
+class NullSink : public OutputSink {
+private:
+    std::uint64_t discarded = 0; /**< Bytes written so far. */
+
+public:
+    void write(const char*, std::size_t size) override { discarded += size; }
+
+    /**
+     * @brief Returns the number of bytes written so far; call after AsyncOutput::flush().
+     */
+    std::uint64_t bytes() const { return discarded; }
+};
+
+/**
+ * @brief Keeps the most recent text in a fixed-size buffer, dropping the oldest bytes.
+ *
+ * Useful to keep the tail of a long run's output for inspection without
+ * writing it anywhere. Safe to read from another thread while it is written.
+ */
+class RingBufferSink : public OutputSink {
+private:
+    std::vector<char> buffer;  /**< Ring storage. */
+    std::size_t next = 0;      /**< Position of the next byte to write. */
+    std::uint64_t total = 0;   /**< Bytes written over the sink's lifetime. */
+    mutable std::mutex mutex;  /**< Guards the fields above. */
+
+public:
+    /**
+     * @brief Creates a ring holding the last capacity bytes.
+     *
+     * @param capacity Size of the ring in bytes (at least 1).
+     */
+    explicit RingBufferSink(std::size_t capacity);
+
+    void write(const char* data, std::size_t size) override;
+
+    /**
+     * @brief Returns the retained text, oldest byte first.
+     */
+    std::string contents() const;
+
+    /**
+     * @brief Returns the number of bytes written over the sink's lifetime.
+     */
+    std::uint64_t bytesWritten() const;
+};
+
+#endif // OUTPUTSINK_H
@@ -0,0 +1,90 @@
+#include "Philox.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PHILOX_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace Philox {
+
+#ifdef PHILOX_SSE2
+namespace {
+
+/**
+ * @brief Full 32x32 -> 64-bit products of four lanes by m, split into high and low words.
+ *
+ * _mm_mul_epu32 multiplies lanes 0 and 2; the odd lanes are shifted down
+ * and multiplied separately, then the halves are interleaved back.
+ */
+inline void mulHiLo(__m128i x, __m128i m, __m128i& hi, __m128i& lo) {
+    const __m128i even = _mm_mul_epu32(x, m);
+    const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(x, 32), m);
+    const __m128i low32 = _mm_set_epi32(0, -1, 0, -1);
+    lo = _mm_or_si128(_mm_and_si128(even, low32), _mm_slli_epi64(odd, 32));
+    hi = _mm_or_si128(_mm_srli_epi64(even, 32), _mm_andnot_si128(low32, odd));
+}
+
+} // namespace
+#endif
+
+/**
+ * @brief Generates consecutive blocks of one stream.
+ *
+ * The SSE2 path keeps the four counter words of four consecutive blocks in
+ * four registers, one block per lane, and transposes them into block order
+ * at the end.
+ *
+ * @param seed The key.
+ * @param stream Stream number.
+ * @param first Index of the first block.
+ * @param blocks Number of blocks to generate.
+ * @param out Receives 4 * blocks words, block by block.
+ */
+void stream(std::uint64_t seed, std::uint64_t stream, std::uint32_t first, std::size_t blocks, std::uint32_t* out) {
+    const std::uint32_t key[2] = {static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)};
+    const std::uint32_t lowStream = static_cast<std::uint32_t>(stream);
+    const std::uint32_t highStream = static_cast<std::uint32_t>(stream >> 32);
+    std::size_t b = 0;
+
+#ifdef PHILOX_SSE2
+    const __m128i m0 = _mm_set1_epi32(static_cast<int>(M0));
+    const __m128i m1 = _mm_set1_epi32(static_cast<int>(M1));
+    for (; b + 4 <= blocks; b += 4) {
+        const std::uint32_t at = first + static_cast<std::uint32_t>(b);
+        __m128i c0 = _mm_set_epi32(static_cast<int>(at + 3), static_cast<int>(at + 2),
+                                   static_cast<int>(at + 1), static_cast<int>(at));
+        __m128i c1 = _mm_set1_epi32(static_cast<int>(lowStream));
+        __m128i c2 = _mm_set1_epi32(static_cast<int>(highStream));
+        __m128i c3 = _mm_setzero_si128();
+        std::uint32_t k0 = key[0], k1 = key[1];
+        for (int round = 0; round < 10; round++) {
+            __m128i hi0, lo0, hi1, lo1;
+            mulHiLo(c0, m0, hi0, lo0);
+            mulHiLo(c2, m1, hi1, lo1);
+            c0 = _mm_xor_si128(_mm_xor_si128(hi1, c1), _mm_set1_epi32(static_cast<int>(k0)));
+            c2 = _mm_xor_si128(_mm_xor_si128(hi0, c3), _mm_set1_epi32(static_cast<int>(k1)));
+            c1 = lo1;
+            c3 = lo0;
+            k0 += W0;
+            k1 += W1;
+        }
+        // Transpose the word registers into four consecutive blocks
+        const __m128i t0 = _mm_unpacklo_epi32(c0, c1);
+        const __m128i t1 = _mm_unpacklo_epi32(c2, c3);
+        const __m128i t2 = _mm_unpackhi_epi32(c0, c1);
+        const __m128i t3 = _mm_unpackhi_epi32(c2, c3);
+        __m128i* dst = reinterpret_cast<__m128i*>(out + 4 * b);
+        _mm_storeu_si128(dst, _mm_unpacklo_epi64(t0, t1));
+        _mm_storeu_si128(dst + 1, _mm_unpackhi_epi64(t0, t1));
+        _mm_storeu_si128(dst + 2, _mm_unpacklo_epi64(t2, t3));
+        _mm_storeu_si128(dst + 3, _mm_unpackhi_epi64(t2, t3));
+    }
+#endif
+
+    for (; b < blocks; b++) {
+        const std::uint32_t counter[4] = {first + static_cast<std::uint32_t>(b), lowStream, highStream, 0};
+        block(counter, key, out + 4 * b);
+    }
+}
+
+} // namespace Philox
@@ -0,0 +1,77 @@
+#ifndef PHILOX_H
+#define PHILOX_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Philox4x32-10 counter-based random number generator.
+ *
+ * A block of four 32-bit random words is a pure function of a 128-bit
+ * counter and a 64-bit key, so any block of any stream can be generated
+ * directly, on any thread and in any order, without carrying generator
+ * state. Streams of a seed are addressed by the upper counter words and
+ * blocks within a stream by the lowest word.
+ *
+ * Matches the Random123 reference implementation.
+ */
+namespace Philox {
+
+const std::uint32_t M0 = 0xD2511F53u; /**< Multiplier of the first word pair. */
+const std::uint32_t M1 = 0xCD9E8D57u; /**< Multiplier of the second word pair. */
+const std::uint32_t W0 = 0x9E3779B9u; /**< Weyl increment of the first key word. */
+const std::uint32_t W1 = 0xBB67AE85u; /**< Weyl increment of the second key word. */
+
+/**
+ * @brief Generates one block of four words.
+ *
+ * @param counter The four counter words.
+ * @param key The two key words.
+ * @param out Receives the four random words.
+ */
+inline void block(const std::uint32_t counter[4], const std::uint32_t key[2], std::uint32_t out[4]) {
+    std::uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+    std::uint32_t k0 = key[0], k1 = key[1];
+    for (int round = 0; round < 10; round++) {
+        const std::uint64_t p0 = static_cast<std::uint64_t>(M0) * c0;
+        const std::uint64_t p1 = static_cast<std::uint64_t>(M1) * c2;
+        const std::uint32_t n0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1 ^ k0;
+        const std::uint32_t n2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3 ^ k1;
+        c1 = static_cast<std::uint32_t>(p1);
+        c3 = static_cast<std::uint32_t>(p0);
+        c0 = n0;
+        c2 = n2;
+        k0 += W0;
+        k1 += W1;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+}
+
+/**
+ * @brief Generates consecutive blocks of one stream.
+ *
+ * Block k uses the counter (first + k, stream low word, stream high word, 0)
+ * and the seed as key. Four blocks at a time are generated in SSE2 lanes
+ * when available; the words are the same as from block().
+ *
+ * @param seed The key.
+ * @param stream Stream number.
+ * @param first Index of the first block.
+ * @param blocks Number of blocks to generate.
+ * @param out Receives 4 * blocks words, block by block.
+ */
+void stream(std::uint64_t seed, std::uint64_t stream, std::uint32_t first, std::size_t blocks, std::uint32_t* out);
+
+/**
+ * @brief Maps a random word to a double uniformly distributed in (0, 1).
+ */
+inline double uniform(std::uint32_t word) {
+    return (static_cast<double>(word) + 0.5) * (1.0 / 4294967296.0);
+}
+
+} // namespace Philox
+
+#endif // PHILOX_H
@@ -0,0 +1,101 @@
+#define _USE_MATH_DEFINES
+#include "RoadNetwork.h"
+#include <cmath>
+
+/**
+ * @brief Adds a lane given as a polyline.
+ *
+ * @param id Lane identifier; must not be in use.
+ * @param xs X-coordinates of the points.
+ * @param ys Y-coordinates of the points.
+ * @param error Receives a description of the failure, if any.
+ * @return true on success, false otherwise.
+ */
+bool RoadNetwork::addLane(int id, const std::vector<double>& xs, const std::vector<double>& ys, std::string& error) {
+    if (byId.count(id)) {
+        error = "lane " + std::to_string(id) + " already exists";
+        return false;
+    }
+    if (xs.size() != ys.size() || xs.size() < 2) {
+        error = "lane " + std::to_string(id) + " needs at least two points";
+        return false;
+    }
+
+    Lane lane;
+    lane.id = id;
+    lane.xs = xs;
+    lane.ys = ys;
+    lane.arc.push_back(0.0);
+    for (std::size_t k = 0; k + 1 < xs.size(); k++) {
+        const double dx = xs[k + 1] - xs[k];
+        const double dy = ys[k + 1] - ys[k];
+        const double len = std::sqrt(dx * dx + dy * dy);
+        if (!std::isfinite(len) || !std::isfinite(xs[k]) || !std::isfinite(ys[k])) {
+            error = "lane " + std::to_string(id) + " has a non-finite point";
+            return false;
+        }
+        if (!(len > 0)) {
+            error = "lane " + std::to_string(id) + " repeats point " + std::to_string(k + 1);
+            return false;
+        }
+        lane.arc.push_back(lane.arc.back() + len);
+        lane.ux.push_back(dx / len);
+        lane.uy.push_back(dy / len);
+        lane.heading.push_back(std::atan2(dy, dx) * 180.0 / M_PI);
+    }
+
+    byId[id] = lanes.size();
+    lanes.push_back(std::move(lane));
+    return true;
+}
+
+/**
+ * @brief Declares two lanes adjacent, leftLane lying to the left of rightLane.
+ *
+ * @param leftLane ID of the left lane.
+ * @param rightLane ID of the right lane.
+ * @param error Receives a description of the failure, if any.
+ * @return true on success, false otherwise.
+ */
+bool RoadNetwork::setAdjacent(int leftLane, int rightLane, std::string& error) {
+    const int l = find(leftLane);
+    const int r = find(rightLane);
+    if (l < 0 || r < 0) {
+        error = "unknown lane " + std::to_string(l < 0 ? leftLane : rightLane);
+        return false;
+    }
+    if (l == r) {
+        error = "lane " + std::to_string(leftLane) + " cannot be its own neighbour";
+        return false;
+    }
+    lanes[l].right = r;
+    lanes[r].left = l;
+    return true;
+}
+
+/**
+ * @brief Returns the index of a lane ID, or -1 if there is no such lane.
+ */
+int RoadNetwork::find(int id) const {
+    auto it = byId.find(id);
+    return it == byId.end() ? -1 : static_cast<int>(it->second);
+}
+
+/**
+ * @brief Returns the pose at an arc length on a lane.
+ *
+ * @param lane Index of the lane.
+ * @param s Arc length in meters.
+ * @param segment Hint: the segment found last time for this vehicle; updated.
+ * @return LanePose The position and heading at s.
+ */
+LanePose RoadNetwork::locate(std::size_t lane, double s, std::uint32_t& segment) const {
+    const Lane& l = lanes[lane];
+    const std::uint32_t last = static_cast<std::uint32_t>(l.ux.size() - 1);
+    std::uint32_t k = segment > last ? last : segment;
+    while (k < last && s >= l.arc[k + 1]) k++;
+    while (k > 0 && s < l.arc[k]) k--;
+    segment = k;
+    const double t = s - l.arc[k];
+    return LanePose{l.xs[k] + l.ux[k] * t, l.ys[k] + l.uy[k] * t, l.heading[k], l.ux[k], l.uy[k]};
+}
@@ -0,0 +1,111 @@
+#ifndef ROADNETWORK_H
+#define ROADNETWORK_H
+
+#include <vector>
+#include <string>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+
+/**
+ * @brief A point on a lane: position, heading and unit heading vector.
+ */
+struct LanePose {
+    double x;         /**< X-coordinate in meters. */
+    double y;         /**< Y-coordinate in meters. */
+    double direction; /**< Heading in degrees, as in Vehicle::direction. */
+    double ux;        /**< X component of the unit heading vector. */
+    double uy;        /**< Y component of the unit heading vector. */
+};
+
+/**
+ * @brief Optional road layer: lanes as polylines, with their left/right neighbours.
+ *
+ * A lane is a polyline followed in the order of its points; a position on it
+ * is its arc length from the first point. Each segment's heading and unit
+ * vector are computed once when the lane is added, so placing a vehicle on a
+ * lane needs no trigonometry. Positions before the start or past the end of a
+ * lane are extrapolated along the first or last segment.
+ *
+ * Adjacent lanes are assumed to run side by side in the same direction, so
+ * that equal arc lengths on them are roughly abreast.
+ */
+class RoadNetwork {
+private:
+    /**
+     * @brief One lane.
+     */
+    struct Lane {
+        int id;                      /**< Caller-chosen lane identifier. */
+        std::vector<double> xs;      /**< X-coordinates of the polyline points. */
+        std::vector<double> ys;      /**< Y-coordinates of the polyline points. */
+        std::vector<double> arc;     /**< Arc length at each point; arc[0] is 0. */
+        std::vector<double> ux;      /**< Unit heading X component of each segment. */
+        std::vector<double> uy;      /**< Unit heading Y component of each segment. */
+        std::vector<double> heading; /**< Heading of each segment in degrees. */
+        int left = -1;               /**< Index of the lane to the left, or -1. */
+        int right = -1;              /**< Index of the lane to the right, or -1. */
+    };
+
+    std::vector<Lane> lanes;                  /**< Lanes in the order they were added. */
+    std::unordered_map<int, std::size_t> byId; /**< Index of each lane ID in lanes. */
+
+public:
+    /**
+     * @brief Adds a lane given as a polyline.
+     *
+     * @param id Lane identifier; must not be in use.
+     * @param xs X-coordinates of the points.
+     * @param ys Y-coordinates of the points.
+     * @param error Receives a description of the failure, if any.
+     * @return true on success; false if the ID is taken, the polyline has
+     *         fewer than two points, a coordinate is not finite or two
+     *         consecutive points coincide.
+     */
+    bool addLane(int id, const std::vector<double>& xs, const std::vector<double>& ys, std::string& error);
+
+    /**
+     * @brief Declares two lanes adjacent, leftLane lying to the left of rightLane.
+     *
+     * @param leftLane ID of the left lane.
+     * @param rightLane ID of the right lane.
+     * @param error Receives a description of the failure, if any.
+     * @return true on success, false if a lane is unknown or both IDs are equal.
+     */
+    bool setAdjacent(int leftLane, int rightLane, std::string& error);
+
+    /**
+     * @brief Returns the index of a lane ID, or -1 if there is no such lane.
+     */
+    int find(int id) const;
+
+    /**
+     * @brief Returns the number of lanes.
+     */
+    std::size_t size() const { return lanes.size(); }
+
+    /**
+     * @brief Returns true if the network has no lanes.
+     */
+    bool empty() const { return lanes.empty(); }
+
+    int laneId(std::size_t lane) const { return lanes[lane].id; }          /**< @brief ID of the lane at an index. */
+    double length(std::size_t lane) const { return lanes[lane].arc.back(); } /**< @brief Arc length of a lane. */
+    int left(std::size_t lane) const { return lanes[lane].left; }          /**< @brief Index of the left neighbour, or -1. */
+    int right(std::size_t lane) const { return lanes[lane].right; }        /**< @brief Index of the right neighbour, or -1. */
+
+    /**
+     * @brief Returns the pose at an arc length on a lane.
+     *
+     * The segment is found by walking from a hint, so a vehicle moving along
+     * a lane is located in O(1) amortized time per step.
+     *
+     * @param lane Index of the lane.
+     * @param s Arc length in meters.
+     * @param segment Hint: the segment found last time for this vehicle; updated.
+     * @return LanePose The position and heading at s.
+     */
+    LanePose locate(std::size_t lane, double s, std::uint32_t& segment) const;
+};
+
+#endif // ROADNETWORK_H
@@ -0,0 +1,664 @@
+#include "RunLog.h"
+#include "MappedFile.h"
+#include "RunLogWriter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+
+/** Largest magnitude a quantized value may have; beyond it doubles lose integer precision. */
+const double QUANT_LIMIT = 9007199254740992.0; // 2^53
+
+/**
+ * @brief Appends an unsigned LEB128 varint.
+ */
+void putVarint(std::vector<std::uint8_t>& out, std::uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back(static_cast<std::uint8_t>(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back(static_cast<std::uint8_t>(v));
+}
+
+/**
+ * @brief Reads an unsigned LEB128 varint and advances the offset.
+ */
+std::uint64_t getVarint(const std::uint8_t* data, std::size_t& offset) {
+    std::uint64_t v = 0;
+    int shift = 0;
+    while (true) {
+        std::uint8_t b = data[offset++];
+        v |= static_cast<std::uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) return v;
+        shift += 7;
+    }
+}
+
+/**
+ * @brief Maps a signed residual to an unsigned value with small magnitudes first.
+ */
+std::uint64_t zigzag(std::uint64_t r) {
+    return (r << 1) ^ (0 - (r >> 63));
+}
+
+/**
+ * @brief Inverse of zigzag().
+ */
+std::uint64_t unzigzag(std::uint64_t z) {
+    return (z >> 1) ^ (0 - (z & 1));
+}
+
+/** Size of the fixed fields of a segment payload: vehicle count, step count, resolution. */
+const std::size_t SEGMENT_FIXED = 2 * sizeof(std::uint64_t) + sizeof(double);
+
+/**
+ * @brief Copies count values of type T out of a payload and advances the offset.
+ */
+template <typename T>
+void takeArray(const unsigned char* data, std::size_t& offset, std::size_t count, std::vector<T>& out) {
+    out.resize(count);
+    if (count > 0) std::memcpy(out.data(), data + offset, count * sizeof(T));
+    offset += count * sizeof(T);
+}
+
+} // namespace
+
+/**
+ * @brief Returns the storage for recording, creating it or cloning a shared one first.
+ *
+ * A clone copies the layouts and the step index, and only the open segment
+ * into an arena of its own, since that is the one it appends to. The closed
+ * segments stay where they are: the clone keeps the source's arenas alive
+ * and points into them. The source may go on appending to its open segment,
+ * which never touches the closed ones.
+ */
+RunLog::Storage& RunLog::writable() {
+    if (!store) {
+        store = std::make_shared<Storage>();
+    } else if (store.use_count() > 1) {
+        auto copy = std::make_shared<Storage>();
+        copy->layouts = store->layouts;
+        copy->times = store->times;
+        copy->keyframes = store->keyframes;
+        copy->inherited = store->inherited;
+        copy->inherited.push_back(store->arena);
+        if (!copy->keyframes.empty()) {
+            Keyframe& open = copy->keyframes.back();
+            copy->arena->append(open.data, open.size);
+            open.data = copy->arena->runData();
+        }
+        store = std::move(copy);
+    }
+    return *store;
+}
+
+/**
+ * @brief Sets the keyframe interval and quantization resolution.
+ *
+ * @param interval Maximum number of steps per keyframe segment (at least 1).
+ * @param res Quantization step for delta frames.
+ */
+void RunLog::configure(std::size_t interval, double res) {
+    if (!empty()) return;
+    keyframeInterval = std::max<std::size_t>(1, interval);
+    if (res > 0 && std::isfinite(res)) resolution = res;
+}
+
+/**
+ * @brief Quantizes a value to the log resolution.
+ *
+ * Values that cannot be represented are quantized to 0; the step holding them
+ * is written as a keyframe, so the quantized value is only used as a
+ * prediction base, identically by encoder and decoder.
+ *
+ * @return true if the value is representable.
+ */
+bool RunLog::quantize(double v, std::int64_t& q) const {
+    double scaled = v * (1.0 / resolution);
+    if (!(std::fabs(scaled) < QUANT_LIMIT)) {
+        q = 0;
+        return false;
+    }
+    q = std::llround(scaled);
+    return true;
+}
+
+/**
+ * @brief Encodes the values in scratch as a keyframe or delta frame.
+ *
+ * A keyframe is written for the first step, when the vehicle set changes,
+ * when keyframeInterval steps have passed since the last keyframe, or when a
+ * value is out of range for quantization. A streamed log hands the
+ * finished segment to its writer before starting a new keyframe.
+ */
+void RunLog::encode(double time, std::size_t n, const int* ids, const double* lengths) {
+    Storage& s = writable();
+    std::vector<Layout>& layouts = s.layouts;
+    std::vector<Keyframe>& keyframes = s.keyframes;
+    std::vector<double>& times = s.times;
+    const std::size_t count = n * CHANNELS;
+    bool sameLayout = !layouts.empty() && layouts.back().ids.size() == n &&
+                      std::equal(ids, ids + n, layouts.back().ids.begin()) &&
+                      std::equal(lengths, lengths + n, layouts.back().lengths.begin());
+
+    // A log recording again after finish() has no prediction state left
+    bool key = !sameLayout || keyframes.empty() || times.size() - keyframes.back().step >= keyframeInterval ||
+               encQ1.size() != count;
+
+    std::vector<std::int64_t>& q = encQ0;
+    q.resize(count);
+    for (std::size_t k = 0; k < count; k++) {
+        if (!quantize(scratch[k], q[k])) key = true;
+    }
+
+    if (key && sink && !times.empty()) flushSegment();
+    if (!sameLayout || layouts.empty()) {
+        layouts.push_back(Layout{std::vector<int>(ids, ids + n), std::vector<double>(lengths, lengths + n)});
+    }
+
+    std::size_t appended;
+    if (key) {
+        s.arena->beginRun();
+        keyframes.push_back(Keyframe{times.size(), layouts.size() - 1, nullptr, 0});
+        appended = count * sizeof(double);
+        s.arena->append(scratch.data(), appended);
+        encQ2.assign(q.begin(), q.end());
+    } else {
+        frame.clear();
+        for (std::size_t k = 0; k < count; k++) {
+            std::uint64_t r = static_cast<std::uint64_t>(q[k]) - 2 * static_cast<std::uint64_t>(encQ1[k])
+                            + static_cast<std::uint64_t>(encQ2[k]);
+            putVarint(frame, zigzag(r));
+        }
+        appended = frame.size();
+        s.arena->append(frame.data(), appended);
+        encQ2.swap(encQ1);
+    }
+    // Appending may have moved the open segment
+    keyframes.back().data = s.arena->runData();
+    keyframes.back().size = s.arena->runSize();
+    encQ1.swap(encQ0);
+    times.push_back(time);
+    encodedTotal += appended;
+}
+
+/**
+ * @brief Writes the segment in memory as one SEGMENT chunk and drops it.
+ *
+ * A streamed log starts a segment only at a keyframe, so the segment holds
+ * exactly one layout and one keyframe at offset 0. Payload layout: vehicle
+ * count, step count and resolution, then ids (int32), lengths and step times
+ * (double), then the encoded bytes.
+ */
+void RunLog::flushSegment() {
+    Storage& s = writable();
+    const Layout& layout = s.layouts.back();
+    const Keyframe& kf = s.keyframes.back();
+    const std::uint64_t n = layout.ids.size();
+    const std::uint64_t steps = s.times.size();
+    const RunLogWriter::Part parts[] = {
+        {&n, sizeof(n)},
+        {&steps, sizeof(steps)},
+        {&resolution, sizeof(resolution)},
+        {layout.ids.data(), layout.ids.size() * sizeof(int)},
+        {layout.lengths.data(), layout.lengths.size() * sizeof(double)},
+        {s.times.data(), s.times.size() * sizeof(double)},
+        {kf.data, kf.size}
+    };
+    const std::uint64_t offset = sink->writeChunk(RunLogChunk::SEGMENT, sinkRunId, flushedSteps, steps,
+                                                  parts, sizeof(parts) / sizeof(parts[0]));
+    segments.push_back(SegmentRef{flushedSteps, s.times.front(), offset});
+    flushedSteps += s.times.size();
+    s.layouts.clear();
+    s.keyframes.clear();
+    s.times.clear();
+    // Closed segments shared with clones must stay intact, so reuse the arena only if it is not shared
+    s.inherited.clear();
+    if (s.arena.use_count() > 1) {
+        s.arena = std::make_shared<LogArena>();
+    } else {
+        s.arena->reset();
+    }
+}
+
+/**
+ * @brief Streams finished segments of this log to a writer instead of keeping them.
+ *
+ * @param writer The writer to append segments to.
+ * @param runId The run ID stored with each segment.
+ */
+void RunLog::streamTo(std::shared_ptr<RunLogWriter> writer, std::uint64_t runId) {
+    if (!empty()) return;
+    sink = std::move(writer);
+    sinkRunId = runId;
+}
+
+/**
+ * @brief Closes the run: releases the encoder state and, for a streamed log, writes what is left.
+ *
+ * A finished log is only read, so its per-vehicle encoder buffers are
+ * dropped for in-memory logs too; copies of it then share the recorded data
+ * and hold nothing else of size proportional to the fleet.
+ *
+ * @param status The final status of the run.
+ */
+void RunLog::finish(const std::string& status) {
+    if (sink) {
+        if (localSize() > 0) flushSegment();
+        const RunLogWriter::Part part = {status.data(), status.size()};
+        sink->writeChunk(RunLogChunk::RUN_END, sinkRunId, flushedSteps, 0, &part, 1);
+        store.reset();
+    }
+    std::vector<std::int64_t>().swap(encQ0);
+    std::vector<std::int64_t>().swap(encQ1);
+    std::vector<std::int64_t>().swap(encQ2);
+    std::vector<double>().swap(scratch);
+    std::vector<std::uint8_t>().swap(frame);
+}
+
+/**
+ * @brief Returns a copy of the recorded steps without the encoder state.
+ *
+ * The copy has no prediction state, so encode() starts its next step with a
+ * keyframe.
+ */
+RunLog RunLog::prefix() const {
+    RunLog copy;
+    copy.keyframeInterval = keyframeInterval;
+    copy.resolution = resolution;
+    copy.store = store;
+    copy.sink = sink;
+    copy.sinkRunId = sinkRunId;
+    copy.flushedSteps = flushedSteps;
+    copy.segments = segments;
+    copy.encodedTotal = encodedTotal;
+    return copy;
+}
+
+/**
+ * @brief Appends the current state of all vehicles in the store.
+ *
+ * @param time The simulation time of the step.
+ * @param vehs The vehicles to record.
+ */
+void RunLog::record(double time, const VehicleStore& vehs) {
+    const std::size_t n = vehs.size();
+    scratch.resize(n * CHANNELS);
+    const double* xs = vehs.x().data();
+    const double* ys = vehs.y().data();
+    const double* sp = vehs.speed().data();
+    const double* dir = vehs.direction().data();
+    for (std::size_t i = 0; i < n; i++) {
+        scratch[i * CHANNELS] = xs[i];
+        scratch[i * CHANNELS + 1] = ys[i];
+        scratch[i * CHANNELS + 2] = sp[i];
+        scratch[i * CHANNELS + 3] = dir[i];
+    }
+    encode(time, n, vehs.id().data(), vehs.length().data());
+}
+
+/**
+ * @brief Appends a log entry given as Vehicle structs.
+ *
+ * @param entry The entry to record.
+ */
+void RunLog::push_back(const LogEntry& entry) {
+    const std::size_t n = entry.positions.size();
+    std::vector<int> ids(n);
+    std::vector<double> lengths(n);
+    scratch.resize(n * CHANNELS);
+    for (std::size_t i = 0; i < n; i++) {
+        const Vehicle& v = entry.positions[i];
+        ids[i] = v.id;
+        lengths[i] = v.length;
+        scratch[i * CHANNELS] = v.x;
+        scratch[i * CHANNELS + 1] = v.y;
+        scratch[i * CHANNELS + 2] = v.speed;
+        scratch[i * CHANNELS + 3] = v.direction;
+    }
+    encode(entry.time, n, ids.data(), lengths.data());
+}
+
+/**
+ * @brief Removes all recorded steps and layouts and detaches the log from its writer.
+ */
+void RunLog::clear() {
+    sink.reset();
+    sinkRunId = 0;
+    flushedSteps = 0;
+    segments.clear();
+    encodedTotal = 0;
+    store.reset();
+    encQ0.clear();
+    encQ1.clear();
+    encQ2.clear();
+}
+
+/**
+ * @brief Positions the cursor on a step by loading its keyframe and decoding forward.
+ */
+void RunLog::seek(Cursor& cursor, std::size_t step) const {
+    const std::vector<Keyframe>& keyframes = store->keyframes;
+    auto it = std::upper_bound(keyframes.begin(), keyframes.end(), step,
+                               [](std::size_t s, const Keyframe& k) { return s < k.step; });
+    const std::size_t index = static_cast<std::size_t>(it - keyframes.begin()) - 1;
+    const Keyframe& kf = keyframes[index];
+    const std::size_t count = store->layouts[kf.layout].ids.size() * CHANNELS;
+
+    cursor.keyframe = index;
+    cursor.step = kf.step;
+    cursor.values.resize(count);
+    cursor.q1.resize(count);
+    if (count > 0) std::memcpy(cursor.values.data(), kf.data, count * sizeof(double));
+    cursor.offset = count * sizeof(double);
+    for (std::size_t k = 0; k < count; k++) {
+        quantize(cursor.values[k], cursor.q1[k]);
+    }
+    cursor.q2 = cursor.q1;
+
+    while (cursor.step < step) advance(cursor);
+}
+
+/**
+ * @brief Decodes the step following the cursor's current step.
+ */
+void RunLog::advance(Cursor& cursor) const {
+    const std::size_t next = cursor.step + 1;
+    const std::vector<Keyframe>& keyframes = store->keyframes;
+    if (cursor.keyframe + 1 < keyframes.size() && keyframes[cursor.keyframe + 1].step == next) {
+        seek(cursor, next);
+        return;
+    }
+    const double scale = 1.0 / resolution;
+    const std::size_t count = cursor.values.size();
+    const std::uint8_t* bytes = keyframes[cursor.keyframe].data;
+    for (std::size_t k = 0; k < count; k++) {
+        std::uint64_t r = unzigzag(getVarint(bytes, cursor.offset));
+        std::uint64_t q = r + 2 * static_cast<std::uint64_t>(cursor.q1[k]) - static_cast<std::uint64_t>(cursor.q2[k]);
+        cursor.q2[k] = cursor.q1[k];
+        cursor.q1[k] = static_cast<std::int64_t>(q);
+        cursor.values[k] = static_cast<double>(cursor.q1[k]) / scale;
+    }
+    cursor.step = next;
+}
+
+/**
+ * @brief Converts the cursor's decoded values into a LogEntry.
+ */
+void RunLog::fill(const Cursor& cursor, LogEntry& entry) const {
+    const Layout& layout = store->layouts[store->keyframes[cursor.keyframe].layout];
+    const std::size_t n = layout.ids.size();
+    entry.time = store->times[cursor.step];
+    entry.positions.resize(n);
+    for (std::size_t i = 0; i < n; i++) {
+        const double* v = &cursor.values[i * CHANNELS];
+        entry.positions[i] = Vehicle(layout.ids[i], v[0], v[1], v[2], v[3], layout.lengths[i]);
+    }
+}
+
+/**
+ * @brief Returns the index in segments of the streamed segment holding a step.
+ *
+ * @param step Index of a step below flushedSteps.
+ */
+std::size_t RunLog::segmentOf(std::size_t step) const {
+    auto it = std::upper_bound(segments.begin(), segments.end(), step,
+                               [](std::size_t s, const SegmentRef& r) { return s < r.firstStep; });
+    return static_cast<std::size_t>(it - segments.begin()) - 1;
+}
+
+/**
+ * @brief Decodes one streamed segment from the mapped log file.
+ *
+ * @param index Index of the segment in segments.
+ * @param file The mapped log file.
+ * @param segment Receives the segment as an in-memory log.
+ * @return false if the chunk is missing, belongs to another run or is corrupt.
+ */
+bool RunLog::readSegment(std::size_t index, const MappedFile& file, RunLog& segment) const {
+    const SegmentRef& ref = segments[index];
+    std::size_t offset = static_cast<std::size_t>(ref.offset);
+    RunLogChunk chunk;
+    if (!RunLogChunk::read(file.data(), file.size(), offset, chunk) || chunk.kind != RunLogChunk::SEGMENT ||
+        chunk.runId != sinkRunId || chunk.firstStep != ref.firstStep) {
+        return false;
+    }
+
+    const unsigned char* p = chunk.payload;
+    const std::size_t size = static_cast<std::size_t>(chunk.payloadSize);
+    if (size < SEGMENT_FIXED) return false;
+    std::uint64_t n;
+    std::uint64_t steps;
+    double res;
+    std::memcpy(&n, p, sizeof(n));
+    std::memcpy(&steps, p + sizeof(n), sizeof(steps));
+    std::memcpy(&res, p + 2 * sizeof(n), sizeof(res));
+    const std::size_t tables = sizeof(int) + sizeof(double);
+    if (steps != chunk.stepCount || steps == 0 || n > (size - SEGMENT_FIXED) / tables ||
+        steps > (size - SEGMENT_FIXED - n * tables) / sizeof(double)) {
+        return false;
+    }
+
+    segment.clear();
+    segment.resolution = res;
+    Storage& s = segment.writable();
+    std::size_t at = SEGMENT_FIXED;
+    Layout layout;
+    takeArray(p, at, static_cast<std::size_t>(n), layout.ids);
+    takeArray(p, at, static_cast<std::size_t>(n), layout.lengths);
+    takeArray(p, at, static_cast<std::size_t>(steps), s.times);
+    s.arena->append(p + at, size - at);
+    s.layouts.push_back(std::move(layout));
+    s.keyframes.push_back(Keyframe{0, 0, s.arena->runData(), s.arena->runSize()});
+    return true;
+}
+
+/**
+ * @brief Maps the log file and decodes the streamed segment holding a step.
+ *
+ * @param step Index of a step below flushedSteps.
+ * @param segment Receives the segment as an in-memory log.
+ * @param base Receives the index in this log of the segment's first step.
+ * @return false if the file or segment cannot be read.
+ */
+bool RunLog::readFlushed(std::size_t step, RunLog& segment, std::size_t& base) const {
+    sink->flush();
+    MappedFile file;
+    std::string error;
+    if (!file.open(sink->path(), error)) return false;
+    const std::size_t index = segmentOf(step);
+    base = segments[index].firstStep;
+    return readSegment(index, file, segment);
+}
+
+/**
+ * @brief Returns the simulation time of a logged step.
+ *
+ * @param step Index of the step.
+ */
+double RunLog::timeAt(std::size_t step) const {
+    if (step >= flushedSteps) return store->times[step - flushedSteps];
+    return at(step).time;
+}
+
+/**
+ * @brief Decodes the log entry of a step.
+ *
+ * @param step Index of the step.
+ * @return LogEntry The decoded vehicle states.
+ */
+LogEntry RunLog::at(std::size_t step) const {
+    if (step < flushedSteps) {
+        RunLog segment;
+        std::size_t base = 0;
+        if (!readFlushed(step, segment, base)) return LogEntry{};
+        return segment.at(step - base);
+    }
+    Cursor cursor;
+    seek(cursor, step - flushedSteps);
+    LogEntry entry;
+    fill(cursor, entry);
+    return entry;
+}
+
+/**
+ * @brief Returns the first step logged at or after a time, or size() if there is none.
+ *
+ * @param time Simulation time in seconds.
+ */
+std::size_t RunLog::lowerBound(double time) const {
+    const std::size_t local = localSize();
+    if (local > 0 && (flushedSteps == 0 || time > store->times.front())) {
+        const auto& times = store->times;
+        return flushedSteps + static_cast<std::size_t>(std::lower_bound(times.begin(), times.end(), time) - times.begin());
+    }
+    if (flushedSteps == 0) return 0;
+
+    // The answer is the first step of the first segment starting at or after
+    // time, unless the segment before it holds a later step that qualifies
+    auto next = std::lower_bound(segments.begin(), segments.end(), time,
+                                 [](const SegmentRef& r, double t) { return r.firstTime < t; });
+    if (next == segments.begin()) return 0;
+    const std::size_t after = next == segments.end() ? flushedSteps : next->firstStep;
+    RunLog segment;
+    std::size_t base = 0;
+    if (!readFlushed((next - 1)->firstStep, segment, base)) return size();
+    const auto& times = segment.store->times;
+    const auto it = std::lower_bound(times.begin(), times.end(), time);
+    return it == times.end() ? after : base + static_cast<std::size_t>(it - times.begin());
+}
+
+/**
+ * @brief Returns the step logged closest to a time, or size() if the log is empty.
+ *
+ * Ties go to the earlier step.
+ *
+ * @param time Simulation time in seconds.
+ */
+std::size_t RunLog::nearestStep(double time) const {
+    const std::size_t n = size();
+    if (n == 0) return 0;
+    const std::size_t i = lowerBound(time);
+    if (i == 0) return 0;
+    if (i >= n) return n - 1;
+    return time - timeAt(i - 1) <= timeAt(i) - time ? i - 1 : i;
+}
+
+/**
+ * @brief Decodes the step logged closest to a time.
+ *
+ * @param time Simulation time in seconds.
+ * @return LogEntry The decoded vehicle states; no vehicles if the log is empty.
+ */
+LogEntry RunLog::atTime(double time) const {
+    if (empty()) return LogEntry{};
+    return at(nearestStep(time));
+}
+
+/**
+ * @brief Extracts the states of one vehicle over a time window.
+ *
+ * Decodes the steps of the window in order; the vehicle's position in the
+ * entry is remembered, so it is only searched for when the vehicle set changes.
+ *
+ * @param vehicleId ID of the vehicle.
+ * @param from Start of the window in seconds (inclusive).
+ * @param to End of the window in seconds (inclusive).
+ * @return The vehicle's states, in step order.
+ */
+std::vector<TrajectoryPoint> RunLog::trajectory(int vehicleId, double from, double to) const {
+    std::vector<TrajectoryPoint> track;
+    if (to < from) return track;
+    std::size_t slot = 0;
+    for (auto it = const_iterator(this, lowerBound(from)), last = end(); it != last; ++it) {
+        const LogEntry& e = *it;
+        if (e.time > to) break;
+        const auto& vs = e.positions;
+        if (slot >= vs.size() || vs[slot].id != vehicleId) {
+            slot = 0;
+            while (slot < vs.size() && vs[slot].id != vehicleId) slot++;
+            if (slot == vs.size()) continue;
+        }
+        const Vehicle& v = vs[slot];
+        track.push_back(TrajectoryPoint{e.time, v.x, v.y, v.speed, v.direction});
+    }
+    return track;
+}
+
+/**
+ * @brief Returns the approximate number of bytes held in memory by the log.
+ *
+ * Data shared with copies of the log is counted in full.
+ */
+std::size_t RunLog::byteSize() const {
+    std::size_t total = (encQ0.capacity() + encQ1.capacity() + encQ2.capacity()) * sizeof(std::int64_t)
+                      + scratch.capacity() * sizeof(double) + frame.capacity();
+    if (store) {
+        total += store->arena->bytesReserved() + store->times.capacity() * sizeof(double)
+               + store->keyframes.capacity() * sizeof(Keyframe);
+        for (const auto& l : store->layouts) {
+            total += l.ids.capacity() * sizeof(int) + l.lengths.capacity() * sizeof(double);
+        }
+        for (const auto& a : store->inherited) total += a->bytesReserved();
+    }
+    return total;
+}
+
+/**
+ * @brief Creates an iterator positioned on a step, decoding it if it exists.
+ */
+RunLog::const_iterator::const_iterator(const RunLog* l, std::size_t i)
+    : log(l), index(i) {
+    if (index < log->size()) load();
+}
+
+/**
+ * @brief Positions the iterator on the segment holding index and decodes the step.
+ *
+ * Streamed steps come from the mapped log file, which is mapped once per
+ * iterator; the segment index gives the chunk of each segment directly.
+ */
+void RunLog::const_iterator::load() {
+    if (index >= log->flushedSteps) {
+        source = log;
+        base = log->flushedSteps;
+        segment.reset();
+        file.reset();
+    } else {
+        if (!file) {
+            log->sink->flush();
+            file = std::make_shared<MappedFile>();
+            std::string error;
+            file->open(log->sink->path(), error);
+        }
+        auto next = std::make_shared<RunLog>();
+        const std::size_t s = log->segmentOf(index);
+        base = log->segments[s].firstStep;
+        if (!file->isOpen() || !log->readSegment(s, *file, *next)) {
+            source = nullptr;
+            entry = LogEntry{};
+            return;
+        }
+        segment = std::move(next);
+        source = segment.get();
+    }
+    source->seek(cursor, index - base);
+    source->fill(cursor, entry);
+}
+
+/**
+ * @brief Advances to the next step, decoding it incrementally.
+ */
+RunLog::const_iterator& RunLog::const_iterator::operator++() {
+    index++;
+    if (index < log->size()) {
+        if (source && index - base < source->localSize()) {
+            source->advance(cursor);
+            source->fill(cursor, entry);
+        } else {
+            load();
+        }
+    }
+    return *this;
+}
@@ -0,0 +1,339 @@
+#ifndef RUNLOG_H
+#define RUNLOG_H
+
+#include "Vehicle.h"
+#include "VehicleStore.h"
+#include "LogArena.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <string>
+
+class MappedFile;
+class RunLogWriter;
+
+/**
+ * @brief Represents a single log entry in the simulation.
+ *
+ * This struct stores the state of all vehicles at a specific point in time
+ * during the simulation.
+ */
+struct LogEntry {
+    double time; /**< The simulation time at which this log entry was created. */
+    std::vector<Vehicle> positions; /**< The positions and states of all vehicles at this time. */
+};
+
+/**
+ * @brief The state of one vehicle at one logged step.
+ */
+struct TrajectoryPoint {
+    double time;      /**< Simulation time of the step. */
+    double x;         /**< X-coordinate. */
+    double y;         /**< Y-coordinate. */
+    double speed;     /**< Speed. */
+    double direction; /**< Direction in degrees. */
+};
+
+/**
+ * @brief Compact, compressed log of the vehicle states of one simulation run.
+ *
+ * Instead of a full copy of every Vehicle per step, the log stores:
+ * - the static attributes (id, length) once per vehicle set ("layout"),
+ * - periodic keyframes holding exact x, y, speed and direction values,
+ * - between keyframes, the second difference of each value quantized to a
+ *   fixed resolution and written as a zigzag varint. Vehicles at constant
+ *   velocity therefore cost about one byte per value and step.
+ *
+ * A keyframe index gives random access: reading step k decodes forward from
+ * the closest keyframe at or before k. Iterating the log decodes incrementally.
+ *
+ * Each keyframe segment is stored contiguously in a LogArena, so steps are
+ * recorded without per-step heap allocations and the encoded bytes are not
+ * re-copied as the log grows. The recorded data is shared copy-on-write: copying a log is O(1),
+ * and a copy that records further steps first clones the step index and the
+ * open segment, while the closed segments stay shared.
+ * Values read back from delta frames are within half a resolution unit of the
+ * recorded ones; keyframe values are exact.
+ *
+ * The log behaves like a read-only container of LogEntry (size(), back(),
+ * operator[], range-for), so callers reading the log do not need to know it
+ * is compressed.
+ *
+ * A log can also stream to a RunLogWriter (see streamTo()). It then keeps only
+ * the segment being recorded in memory: whenever a new keyframe starts, the
+ * finished segment is handed to the writer and dropped. Reading a streamed
+ * step maps the log file and decodes the segment holding it, so memory stays
+ * bounded by one segment however long the run is.
+ */
+class RunLog {
+private:
+    /**
+     * @brief The static attributes of one set of vehicles.
+     */
+    struct Layout {
+        std::vector<int> ids;        /**< Vehicle identifiers, in store order. */
+        std::vector<double> lengths; /**< Vehicle lengths. */
+    };
+
+    /**
+     * @brief Index entry for one keyframe.
+     */
+    struct Keyframe {
+        std::size_t step;          /**< Index of the keyframe's step in the log. */
+        std::size_t layout;        /**< Index of the layout in effect from this keyframe on. */
+        const std::uint8_t* data;  /**< The segment's bytes in the arena: the keyframe, then its delta frames. */
+        std::size_t size;          /**< Size of the segment in bytes. */
+    };
+
+    /**
+     * @brief Location of one streamed segment in the log file.
+     */
+    struct SegmentRef {
+        std::size_t firstStep; /**< Index of the segment's first step in the log. */
+        double firstTime;      /**< Simulation time of that step. */
+        std::uint64_t offset;  /**< File offset of the segment's chunk. */
+    };
+
+    /**
+     * @brief The recorded data, shared between copies of a log.
+     *
+     * Closed segments are never written again, so a clone keeps pointing at
+     * them in the arenas it inherits and copies only the open segment.
+     */
+    struct Storage {
+        std::vector<Layout> layouts;     /**< Distinct vehicle sets seen during the run. */
+        std::vector<Keyframe> keyframes; /**< Keyframe index, ordered by step. */
+        std::vector<double> times;       /**< Simulation time of each logged step. */
+        std::shared_ptr<LogArena> arena = std::make_shared<LogArena>(); /**< Encoded segments; the last one is the open run. */
+        std::vector<std::shared_ptr<const LogArena>> inherited; /**< Arenas of the logs this one was cloned from, holding its earlier closed segments. */
+    };
+
+    /**
+     * @brief Decoder position: the last decoded step and its reconstructed values.
+     */
+    struct Cursor {
+        std::size_t step = 0;          /**< Index of the decoded step. */
+        std::size_t offset = 0;        /**< Byte offset of the next step in the current segment. */
+        std::size_t keyframe = 0;      /**< Index of the keyframe that starts the current segment. */
+        std::vector<std::int64_t> q1;  /**< Quantized values of the decoded step. */
+        std::vector<std::int64_t> q2;  /**< Quantized values of the step before it. */
+        std::vector<double> values;    /**< Reconstructed values of the decoded step. */
+    };
+
+    /** Number of values recorded per vehicle and step: x, y, speed, direction. */
+    static const std::size_t CHANNELS = 4;
+
+    std::size_t keyframeInterval = 64; /**< Maximum number of steps per keyframe segment. */
+    double resolution = 1e-6;          /**< Quantization step for values between keyframes. */
+    std::shared_ptr<Storage> store;    /**< Recorded data; null while the log is empty. */
+
+    std::vector<std::int64_t> encQ0;   /**< Encoder: quantized values of the step being recorded. */
+    std::vector<std::int64_t> encQ1;   /**< Encoder: quantized values of the last step. */
+    std::vector<std::int64_t> encQ2;   /**< Encoder: quantized values of the step before. */
+    std::vector<double> scratch;       /**< Encoder: interleaved values of the step being recorded. */
+    std::vector<std::uint8_t> frame;   /**< Encoder: varints of the delta frame being recorded. */
+
+    std::shared_ptr<RunLogWriter> sink; /**< Writer receiving finished segments; null for an in-memory log. */
+    std::uint64_t sinkRunId = 0;        /**< Run ID written with each streamed segment. */
+    std::size_t flushedSteps = 0;       /**< Number of leading steps already handed to the sink. */
+    std::vector<SegmentRef> segments;   /**< Index of the streamed segments, in step order. */
+    std::uint64_t encodedTotal = 0;     /**< Encoded bytes appended over the log's lifetime. */
+
+    Storage& writable();
+    std::size_t localSize() const { return store ? store->times.size() : 0; }
+    void encode(double time, std::size_t n, const int* ids, const double* lengths);
+    void flushSegment();
+    std::size_t segmentOf(std::size_t step) const;
+    bool readSegment(std::size_t index, const MappedFile& file, RunLog& segment) const;
+    bool readFlushed(std::size_t step, RunLog& segment, std::size_t& base) const;
+    bool quantize(double v, std::int64_t& q) const;
+    void seek(Cursor& cursor, std::size_t step) const;
+    void advance(Cursor& cursor) const;
+    void fill(const Cursor& cursor, LogEntry& entry) const;
+
+public:
+    /**
+     * @brief Forward iterator decoding one LogEntry per step.
+     */
+    class const_iterator {
+    private:
+        const RunLog* log = nullptr;      /**< The log being iterated. */
+        std::size_t index = 0;            /**< Index of the current step. */
+        const RunLog* source = nullptr;   /**< Log holding the segment being decoded: log itself or segment. */
+        std::size_t base = 0;             /**< Index in log of the first step of source. */
+        std::shared_ptr<MappedFile> file; /**< Mapped log file of a streamed log. */
+        std::shared_ptr<RunLog> segment;  /**< Streamed segment read back from file. */
+        Cursor cursor;                    /**< Incremental decoder state. */
+        LogEntry entry;                   /**< The decoded current entry. */
+
+        void load();
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = LogEntry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const LogEntry*;
+        using reference = const LogEntry&;
+
+        const_iterator() = default;
+        const_iterator(const RunLog* l, std::size_t i);
+        reference operator*() const { return entry; }
+        pointer operator->() const { return &entry; }
+        const_iterator& operator++();
+        bool operator==(const const_iterator& o) const { return index == o.index; }
+        bool operator!=(const const_iterator& o) const { return index != o.index; }
+    };
+
+    /**
+     * @brief Sets the keyframe interval and quantization resolution.
+     *
+     * Ignored once a step has been recorded, since earlier steps must be
+     * decoded with the settings they were encoded with.
+     *
+     * @param interval Maximum number of steps per keyframe segment (at least 1).
+     * @param res Quantization step in meters (and m/s, degrees) for delta frames.
+     */
+    void configure(std::size_t interval, double res);
+
+    /**
+     * @brief Streams finished segments of this log to a writer instead of keeping them.
+     *
+     * Ignored once a step has been recorded.
+     *
+     * @param writer The writer to append segments to.
+     * @param runId The run ID stored with each segment.
+     */
+    void streamTo(std::shared_ptr<RunLogWriter> writer, std::uint64_t runId);
+
+    /**
+     * @brief Closes the run and releases the encoder state.
+     *
+     * A streamed log hands the segment being recorded to the writer and
+     * writes a RUN_END chunk holding the status. Every log drops its encoder
+     * buffers, so copying a finished log only shares its recorded data.
+     * Recording more steps afterwards starts with a keyframe.
+     *
+     * @param status The final status of the run.
+     */
+    void finish(const std::string& status);
+
+    /**
+     * @brief Returns a copy of the recorded steps without the encoder state.
+     *
+     * The copy shares the recorded data like a plain copy, but leaves the
+     * encoder buffers behind (about 128 bytes per vehicle), so copying a log
+     * mid-run costs O(1). The copy's first recorded step is a keyframe.
+     */
+    RunLog prefix() const;
+
+    /**
+     * @brief Returns true if the log streams its segments to a file.
+     */
+    bool isStreamed() const { return sink != nullptr; }
+
+    /**
+     * @brief Appends the current state of all vehicles in the store.
+     *
+     * @param time The simulation time of the step.
+     * @param vehs The vehicles to record.
+     */
+    void record(double time, const VehicleStore& vehs);
+
+    /**
+     * @brief Appends a log entry given as Vehicle structs.
+     *
+     * @param entry The entry to record.
+     */
+    void push_back(const LogEntry& entry);
+
+    /**
+     * @brief Removes all recorded steps and layouts and detaches the log from its writer.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the number of logged steps, including streamed ones.
+     */
+    std::size_t size() const { return flushedSteps + localSize(); }
+
+    /**
+     * @brief Returns true if no step has been logged.
+     */
+    bool empty() const { return size() == 0; }
+
+    /**
+     * @brief Returns the simulation time of a logged step.
+     *
+     * @param step Index of the step.
+     */
+    double timeAt(std::size_t step) const;
+
+    /**
+     * @brief Decodes the log entry of a step.
+     *
+     * For a streamed step the entry has no vehicles if the log file cannot be read.
+     *
+     * @param step Index of the step.
+     * @return LogEntry The decoded vehicle states.
+     */
+    LogEntry at(std::size_t step) const;
+
+    /**
+     * @brief Returns the first step logged at or after a time, or size() if there is none.
+     *
+     * Logged times are non-decreasing, so this is a binary search over the
+     * step times; for streamed steps it searches the segment index and reads
+     * at most one segment back from the file.
+     *
+     * @param time Simulation time in seconds.
+     */
+    std::size_t lowerBound(double time) const;
+
+    /**
+     * @brief Returns the step logged closest to a time, or size() if the log is empty.
+     *
+     * @param time Simulation time in seconds.
+     */
+    std::size_t nearestStep(double time) const;
+
+    /**
+     * @brief Decodes the step logged closest to a time.
+     *
+     * @param time Simulation time in seconds.
+     * @return LogEntry The decoded vehicle states; no vehicles if the log is empty.
+     */
+    LogEntry atTime(double time) const;
+
+    /**
+     * @brief Extracts the states of one vehicle over a time window.
+     *
+     * Steps in which the vehicle is absent are skipped.
+     *
+     * @param vehicleId ID of the vehicle.
+     * @param from Start of the window in seconds (inclusive).
+     * @param to End of the window in seconds (inclusive).
+     * @return The vehicle's states, in step order.
+     */
+    std::vector<TrajectoryPoint> trajectory(int vehicleId, double from, double to) const;
+
+    LogEntry operator[](std::size_t step) const { return at(step); } /**< @brief Same as at(). */
+    LogEntry front() const { return at(0); }                         /**< @brief Decodes the first step. */
+    LogEntry back() const { return at(size() - 1); }                 /**< @brief Decodes the last step. */
+
+    const_iterator begin() const { return const_iterator(this, 0); }      /**< @brief Iterator to the first step. */
+    const_iterator end() const { return const_iterator(this, size()); }   /**< @brief Iterator past the last step. */
+
+    /**
+     * @brief Returns the number of encoded bytes appended so far, including streamed segments.
+     */
+    std::uint64_t encodedBytes() const { return encodedTotal; }
+
+    /**
+     * @brief Returns the approximate number of bytes held in memory by the log.
+     */
+    std::size_t byteSize() const;
+};
+
+#endif // RUNLOG_H
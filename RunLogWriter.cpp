@@ -0,0 +1,172 @@
+#include "RunLogWriter.h"
+#include "MappedFile.h"
+#include <cstring>
+
+namespace {
+
+template <typename T>
+void append(std::vector<unsigned char>& buf, T value) {
+    const std::size_t at = buf.size();
+    buf.resize(at + sizeof(T));
+    std::memcpy(buf.data() + at, &value, sizeof(T));
+}
+
+template <typename T>
+T load(const unsigned char* data) {
+    T value;
+    std::memcpy(&value, data, sizeof(T));
+    return value;
+}
+
+} // namespace
+
+/**
+ * @brief Reads the chunk starting at offset and advances offset past it.
+ *
+ * @param data Start of the mapped file.
+ * @param size Size of the mapped file.
+ * @param offset Byte offset of the chunk; advanced to the next chunk on success.
+ * @param chunk Receives the decoded header and payload pointer.
+ * @return false at the end of the data or on a truncated/corrupt chunk.
+ */
+bool RunLogChunk::read(const unsigned char* data, std::size_t size, std::size_t& offset, RunLogChunk& chunk) {
+    if (!littleEndian()) return false;
+    if (offset > size || size - offset < HEADER_SIZE) return false;
+    const unsigned char* h = data + offset;
+    if (load<std::uint32_t>(h) != MAGIC) return false;
+    chunk.kind = load<std::uint32_t>(h + 4);
+    chunk.runId = load<std::uint64_t>(h + 8);
+    chunk.firstStep = load<std::uint64_t>(h + 16);
+    chunk.stepCount = load<std::uint64_t>(h + 24);
+    chunk.payloadSize = load<std::uint64_t>(h + 32);
+    if (chunk.payloadSize > size - offset - HEADER_SIZE) return false;
+    chunk.payload = h + HEADER_SIZE;
+    offset += HEADER_SIZE + static_cast<std::size_t>(chunk.payloadSize);
+    return true;
+}
+
+/**
+ * @brief Creates (truncating) the log file and starts the writer thread.
+ *
+ * The file is truncated because run IDs restart at 1 for every Simulation,
+ * so chunks left over from an earlier process would be mistaken for this
+ * simulation's runs. Chunk headers are written in host byte order, so on a
+ * big-endian host no file is opened and good() returns false.
+ *
+ * @param path Path of the log file.
+ * @param capacity Buffer size in bytes that triggers a write.
+ */
+RunLogWriter::RunLogWriter(const std::string& path, std::size_t capacity)
+    : filePath(path), bufferCapacity(capacity) {
+    if (littleEndian()) file = std::fopen(path.c_str(), "wb");
+    front.reserve(bufferCapacity);
+    back.reserve(bufferCapacity);
+    writer = std::thread(&RunLogWriter::writerLoop, this);
+}
+
+/**
+ * @brief Writes all buffered chunks and stops the writer thread.
+ */
+RunLogWriter::~RunLogWriter() {
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    changed.notify_all();
+    writer.join();
+    if (file) std::fclose(file);
+}
+
+/**
+ * @brief Returns true if the file was opened and no write has failed.
+ */
+bool RunLogWriter::good() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return file != nullptr && !writeFailed;
+}
+
+/**
+ * @brief Writer thread: writes the back buffer whenever one is handed off.
+ */
+void RunLogWriter::writerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        changed.wait(lock, [this] { return backPending || stopping; });
+        if (backPending) {
+            // back is owned by this thread until backPending is cleared
+            lock.unlock();
+            bool ok = file && std::fwrite(back.data(), 1, back.size(), file) == back.size() && std::fflush(file) == 0;
+            back.clear();
+            lock.lock();
+            if (!ok) writeFailed = true;
+            backPending = false;
+            changed.notify_all();
+        } else if (stopping) {
+            return;
+        }
+    }
+}
+
+/**
+ * @brief Swaps the front buffer with the back buffer once the writer is done with it.
+ *
+ * @param lock A lock on mutex held by the caller.
+ */
+void RunLogWriter::handOff(std::unique_lock<std::mutex>& lock) {
+    changed.wait(lock, [this] { return !backPending; });
+    front.swap(back);
+    backPending = true;
+    changed.notify_all();
+}
+
+/**
+ * @brief Appends a chunk whose payload is the concatenation of parts to the front buffer.
+ *
+ * The front buffer is appended to under the lock: logs of finished runs
+ * call flush() when they are read, which may happen on another thread while
+ * a later run of the same simulation is still writing. The writer thread
+ * only takes the lock to pick up and release the back buffer, so the lock
+ * is almost never contended. Passing the payload in parts lets callers write large arrays without first
+ * copying them into one contiguous block.
+ *
+ * @param kind Chunk kind (RunLogChunk::SEGMENT or RunLogChunk::RUN_END).
+ * @param runId Run the chunk belongs to.
+ * @param firstStep Index of the first step in the chunk.
+ * @param stepCount Number of steps in the chunk.
+ * @param parts The payload pieces, in order.
+ * @param partCount Number of pieces.
+ * @return std::uint64_t The file offset of the chunk.
+ */
+std::uint64_t RunLogWriter::writeChunk(std::uint32_t kind, std::uint64_t runId, std::uint64_t firstStep,
+                              std::uint64_t stepCount, const Part* parts, std::size_t partCount) {
+    std::uint64_t size = 0;
+    for (std::size_t p = 0; p < partCount; p++) size += parts[p].size;
+    std::unique_lock<std::mutex> lock(mutex);
+    const std::uint64_t offset = appended;
+    appended += RunLogChunk::HEADER_SIZE + size;
+    append<std::uint32_t>(front, RunLogChunk::MAGIC);
+    append<std::uint32_t>(front, kind);
+    append<std::uint64_t>(front, runId);
+    append<std::uint64_t>(front, firstStep);
+    append<std::uint64_t>(front, stepCount);
+    append<std::uint64_t>(front, size);
+    for (std::size_t p = 0; p < partCount; p++) {
+        const unsigned char* data = static_cast<const unsigned char*>(parts[p].data);
+        front.insert(front.end(), data, data + parts[p].size);
+    }
+
+    if (front.size() >= bufferCapacity) handOff(lock);
+    return offset;
+}
+
+/**
+ * @brief Blocks until every chunk appended so far is written and flushed to the file.
+ *
+ * Safe to call from any thread, concurrently with writeChunk().
+ */
+void RunLogWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (!front.empty()) handOff(lock);
+    changed.wait(lock, [this] { return !backPending; });
+}
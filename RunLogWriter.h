@@ -0,0 +1,133 @@
+#ifndef RUNLOGWRITER_H
+#define RUNLOGWRITER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Header of one chunk in a run-log file.
+ *
+ * A run-log file is a sequence of chunks, each a fixed 40-byte little-endian
+ * header followed by its payload. SEGMENT chunks hold one self-contained
+ * RunLog segment (vehicle layout, step times and one keyframe with its delta
+ * frames); a RUN_END chunk closes a run and holds its final status text.
+ * Integers are stored in host order, so files are only written and read on
+ * little-endian hosts.
+ */
+struct RunLogChunk {
+    static const std::uint32_t MAGIC = 0x434C5356;  /**< "VSLC" in little-endian byte order. */
+    static const std::uint32_t SEGMENT = 1;         /**< Chunk kind: encoded log segment. */
+    static const std::uint32_t RUN_END = 2;         /**< Chunk kind: end of run, payload is the status. */
+    static const std::size_t HEADER_SIZE = 40;      /**< Size of the encoded chunk header in bytes. */
+
+    std::uint32_t kind = 0;          /**< SEGMENT or RUN_END. */
+    std::uint64_t runId = 0;         /**< Run the chunk belongs to. */
+    std::uint64_t firstStep = 0;     /**< Index of the first step in the chunk (total steps for RUN_END). */
+    std::uint64_t stepCount = 0;     /**< Number of steps in the chunk. */
+    std::uint64_t payloadSize = 0;   /**< Size of the payload in bytes. */
+    const unsigned char* payload = nullptr; /**< Start of the payload when read from a mapped file. */
+
+    /**
+     * @brief Reads the chunk starting at offset and advances offset past it.
+     *
+     * @param data Start of the mapped file.
+     * @param size Size of the mapped file.
+     * @param offset Byte offset of the chunk; advanced to the next chunk on success.
+     * @param chunk Receives the decoded header and payload pointer.
+     * @return false at the end of the data, on a truncated/corrupt chunk or on a big-endian host.
+     */
+    static bool read(const unsigned char* data, std::size_t size, std::size_t& offset, RunLogChunk& chunk);
+};
+
+/**
+ * @brief Append-only run-log file written by a background thread.
+ *
+ * Chunks are appended to an in-memory front buffer. When it fills up it is
+ * swapped with the back buffer, which the writer thread then writes to disk
+ * while the simulation keeps filling the front buffer. The simulation only
+ * waits if it fills a whole buffer before the previous one has been written.
+ * A mutex guards the front buffer, so logs streamed to the writer can be
+ * read (which flushes it) from other threads while it is being appended to.
+ */
+class RunLogWriter {
+private:
+    std::string filePath;              /**< Path of the log file. */
+    std::FILE* file = nullptr;         /**< Open log file, or null if opening failed. */
+    std::size_t bufferCapacity;        /**< Front-buffer size that triggers a hand-off to the writer. */
+    std::vector<unsigned char> front;  /**< Buffer the simulation appends to. */
+    std::vector<unsigned char> back;   /**< Buffer the writer thread is writing. */
+    std::uint64_t appended = 0;        /**< Bytes appended so far, i.e. the file offset of the next chunk. */
+    bool backPending = false;          /**< True while back holds data not yet written. */
+    bool stopping = false;             /**< Set when the writer should exit. */
+    bool writeFailed = false;          /**< Set if a write to the file failed. */
+    std::mutex mutex;                  /**< Guards front, appended, backPending, stopping and writeFailed, and back while not pending. */
+    std::condition_variable changed;   /**< Signalled when a buffer is handed off or written. */
+    std::thread writer;                /**< The background writer thread. */
+
+    void writerLoop();
+    void handOff(std::unique_lock<std::mutex>& lock);
+
+public:
+    /**
+     * @brief Creates (truncating) the log file and starts the writer thread.
+     *
+     * @param path Path of the log file.
+     * @param capacity Buffer size in bytes that triggers a write.
+     */
+    explicit RunLogWriter(const std::string& path, std::size_t capacity = 4 << 20);
+
+    /**
+     * @brief Writes all buffered chunks and stops the writer thread.
+     */
+    ~RunLogWriter();
+
+    RunLogWriter(const RunLogWriter&) = delete;
+    RunLogWriter& operator=(const RunLogWriter&) = delete;
+
+    /**
+     * @brief Returns true if the file was opened and no write has failed.
+     */
+    bool good();
+
+    /**
+     * @brief Returns the path of the log file.
+     */
+    const std::string& path() const { return filePath; }
+
+    /**
+     * @brief One contiguous piece of a chunk payload.
+     */
+    struct Part {
+        const void* data; /**< Start of the bytes. */
+        std::size_t size; /**< Number of bytes. */
+    };
+
+    /**
+     * @brief Appends a chunk whose payload is the concatenation of parts to the front buffer.
+     *
+     * @param kind Chunk kind (RunLogChunk::SEGMENT or RunLogChunk::RUN_END).
+     * @param runId Run the chunk belongs to.
+     * @param firstStep Index of the first step in the chunk.
+     * @param stepCount Number of steps in the chunk.
+     * @param parts The payload pieces, in order.
+     * @param partCount Number of pieces.
+     * @return std::uint64_t The file offset of the chunk.
+     */
+    std::uint64_t writeChunk(std::uint32_t kind, std::uint64_t runId, std::uint64_t firstStep,
+                    std::uint64_t stepCount, const Part* parts, std::size_t partCount);
+
+    /**
+     * @brief Blocks until every chunk appended so far is written and flushed to the file.
+     *
+     * Safe to call from any thread, concurrently with writeChunk().
+     */
+    void flush();
+};
+
+#endif // RUNLOGWRITER_H
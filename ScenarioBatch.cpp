@@ -0,0 +1,119 @@
+#include "ScenarioBatch.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+/**
+ * @brief Creates an empty batch.
+ *
+ * @param threads Number of worker threads; 0 uses the hardware thread count.
+ */
+ScenarioBatch::ScenarioBatch(std::size_t threads)
+    : threadCount(threads) {}
+
+/**
+ * @brief Adds a scenario to the batch.
+ *
+ * @param s The scenario to add.
+ */
+void ScenarioBatch::add(Scenario s) {
+    scenarios.push_back(std::move(s));
+}
+
+/**
+ * @brief Runs a single scenario on the calling thread.
+ *
+ * The run is always headless and is not kept in the Simulation's history,
+ * since only the summary outlives the call.
+ *
+ * @param s The scenario to run.
+ * @param index The index recorded in the summary.
+ * @return ScenarioSummary The scenario's result.
+ */
+ScenarioSummary ScenarioBatch::runOne(const Scenario& s, std::size_t index) {
+    Simulation sim(s.settings);
+    for (const auto& v : s.vehicles) {
+        sim.addVehicle(v);
+    }
+
+    RunOptions options = s.options;
+    options.realTime = false;
+    options.verbose = false;
+    options.recordHistory = false;
+    RunResult result = sim.run(options);
+
+    ScenarioSummary summary;
+    summary.index = index;
+    summary.status = result.record.status;
+    summary.steps = result.stats.steps;
+    summary.simTime = result.stats.simTime;
+    summary.conflicts = result.record.conflicts.size();
+    summary.wallSeconds = result.stats.wallSeconds;
+    for (const auto& c : result.record.conflicts) {
+        if (summary.firstCollisionTime < 0 || c.closestTime < summary.firstCollisionTime) {
+            summary.firstCollisionTime = c.closestTime;
+        }
+    }
+    return summary;
+}
+
+/**
+ * @brief Returns the log file each scenario streams to, suffixing paths that several scenarios share.
+ *
+ * A suffixed path that another scenario names explicitly gets the suffix
+ * again until it is unique.
+ */
+std::vector<std::string> ScenarioBatch::logFiles() const {
+    std::unordered_map<std::string, std::size_t> uses;
+    for (const Scenario& s : scenarios) {
+        if (!s.settings.logFile.empty()) uses[s.settings.logFile]++;
+    }
+    std::unordered_set<std::string> taken;
+    for (const auto& u : uses) taken.insert(u.first);
+
+    std::vector<std::string> files(scenarios.size());
+    for (std::size_t i = 0; i < scenarios.size(); i++) {
+        const std::string& path = scenarios[i].settings.logFile;
+        files[i] = path;
+        if (path.empty() || uses[path] < 2) continue;
+        const std::string suffix = "." + std::to_string(i);
+        do {
+            files[i] += suffix;
+        } while (!taken.insert(files[i]).second);
+    }
+    return files;
+}
+
+/**
+ * @brief Runs every queued scenario and returns one summary per scenario.
+ *
+ * One task per scenario is queued on a work-stealing pool, so long and short
+ * scenarios balance across the workers automatically.
+ *
+ * @return std::vector<ScenarioSummary> Summaries indexed like the scenarios.
+ */
+std::vector<ScenarioSummary> ScenarioBatch::run() const {
+    std::vector<ScenarioSummary> results(scenarios.size());
+    if (scenarios.empty()) return results;
+
+    std::size_t threads = threadCount;
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, scenarios.size());
+
+    const std::vector<std::string> files = logFiles();
+    ThreadPool pool(threads);
+    for (std::size_t i = 0; i < scenarios.size(); i++) {
+        pool.submit([this, i, &files, &results] {
+            if (files[i] == scenarios[i].settings.logFile) {
+                results[i] = runOne(scenarios[i], i);
+            } else {
+                Scenario own = scenarios[i];
+                own.settings.logFile = files[i];
+                results[i] = runOne(own, i);
+            }
+        });
+    }
+    pool.wait();
+    return results;
+}
@@ -0,0 +1,89 @@
+#ifndef SCENARIOBATCH_H
+#define SCENARIOBATCH_H
+
+#include "Simulation.h"
+#include <vector>
+#include <string>
+#include <cstddef>
+
+/**
+ * @brief One independent scenario of a batch: settings, initial vehicles and run limits.
+ */
+struct Scenario {
+    Settings settings;             /**< Settings for the scenario's Simulation. */
+    std::vector<Vehicle> vehicles; /**< Initial vehicle set. */
+    RunOptions options;            /**< Run limits; pacing, printing and history are always off in a batch. */
+};
+
+/**
+ * @brief Per-scenario result of a batch run.
+ */
+struct ScenarioSummary {
+    std::size_t index = 0;              /**< Position of the scenario in the batch. */
+    std::string status;                 /**< Final run status ("Collision", "Stopped", "Skipped" or "Unbounded"). */
+    long long steps = 0;                /**< Number of steps executed. */
+    double simTime = 0.0;               /**< Simulated time reached, in seconds. */
+    double firstCollisionTime = -1.0;   /**< Earliest closest-approach time among the conflicts, or -1 if none. */
+    std::size_t conflicts = 0;          /**< Number of conflicting pairs reported. */
+    double wallSeconds = 0.0;           /**< Wall-clock duration of the scenario's run loop. */
+};
+
+/**
+ * @brief Runs many independent scenarios in parallel on a work-stealing thread pool.
+ *
+ * Each scenario gets its own Simulation, built and run entirely on one worker
+ * thread. The only shared state is the result array, in which every worker
+ * writes only the slot of the scenario it ran, so results need no locking and
+ * come back in submission order whatever the thread count.
+ *
+ * Scenarios that stream their logs to the same settings.logFile would
+ * truncate each other's file, so run() gives each of them its own file: the
+ * shared path followed by "." and the scenario index.
+ */
+class ScenarioBatch {
+private:
+    std::vector<Scenario> scenarios; /**< The queued scenarios. */
+    std::size_t threadCount;         /**< Worker count for run(); 0 means hardware concurrency. */
+
+    std::vector<std::string> logFiles() const;
+
+public:
+    /**
+     * @brief Creates an empty batch.
+     *
+     * @param threads Number of worker threads; 0 uses the hardware thread count.
+     */
+    explicit ScenarioBatch(std::size_t threads = 0);
+
+    /**
+     * @brief Adds a scenario to the batch.
+     *
+     * @param s The scenario to add.
+     */
+    void add(Scenario s);
+
+    /**
+     * @brief Returns the number of queued scenarios.
+     */
+    std::size_t size() const { return scenarios.size(); }
+
+    /**
+     * @brief Runs every queued scenario and returns one summary per scenario.
+     *
+     * Scenarios sharing a log file write to suffixed paths instead (see the class description).
+     *
+     * @return std::vector<ScenarioSummary> Summaries indexed like the scenarios.
+     */
+    std::vector<ScenarioSummary> run() const;
+
+    /**
+     * @brief Runs a single scenario on the calling thread.
+     *
+     * @param s The scenario to run.
+     * @param index The index recorded in the summary.
+     * @return ScenarioSummary The scenario's result.
+     */
+    static ScenarioSummary runOne(const Scenario& s, std::size_t index);
+};
+
+#endif // SCENARIOBATCH_H
@@ -0,0 +1,203 @@
+#include "ScenarioFile.h"
+#include "Simulation.h"
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+const char MAGIC[8] = {'V', 'S', 'I', 'M', 'S', 'C', 'E', 'N'};
+const std::size_t HEADER_SIZE = 256;
+const std::size_t SPEED_UNIT_SIZE = 32;
+const std::size_t COLUMN_ALIGN = 64;
+
+// Header field offsets
+const std::size_t OFF_VERSION = 8;
+const std::size_t OFF_HEADER_SIZE = 12;
+const std::size_t OFF_COUNT = 16;
+const std::size_t OFF_TIME_STEP = 24;
+const std::size_t OFF_SAFETY = 32;
+const std::size_t OFF_LOG_RES = 40;
+const std::size_t OFF_LOG_INTERVAL = 48;
+const std::size_t OFF_LOGGING = 56;
+const std::size_t OFF_THREADS = 60;
+const std::size_t OFF_SPEED_UNIT = 64;
+const std::size_t OFF_COLUMNS = 96;
+
+template <typename T>
+void put(std::vector<char>& buf, std::size_t offset, T value) {
+    std::memcpy(buf.data() + offset, &value, sizeof(T));
+}
+
+template <typename T>
+T get(const unsigned char* data, std::size_t offset) {
+    T value;
+    std::memcpy(&value, data + offset, sizeof(T));
+    return value;
+}
+
+std::size_t alignUp(std::size_t v) {
+    return (v + COLUMN_ALIGN - 1) / COLUMN_ALIGN * COLUMN_ALIGN;
+}
+
+} // namespace
+
+/**
+ * @brief Writes settings and vehicles as a scenario file.
+ *
+ * @param path Path of the file to create or overwrite.
+ * @param s The settings to store.
+ * @param vehicles The vehicles to store.
+ * @param error Receives a description of the failure, if any.
+ * @return true on success, false otherwise.
+ */
+bool ScenarioFile::save(const std::string& path, const Settings& s, const VehicleStore& vehicles, std::string& error) {
+    if (!littleEndian()) {
+        error = "scenario files are only supported on little-endian hosts";
+        return false;
+    }
+    if (s.speedUnit.size() >= SPEED_UNIT_SIZE) {
+        error = "speed unit is too long";
+        return false;
+    }
+    const std::size_t n = vehicles.size();
+    const void* data[COLUMNS] = {
+        vehicles.id().data(), vehicles.x().data(), vehicles.y().data(), vehicles.speed().data(),
+        vehicles.direction().data(), vehicles.length().data(), vehicles.vx().data(), vehicles.vy().data()
+    };
+
+    std::vector<char> header(HEADER_SIZE, 0);
+    std::memcpy(header.data(), MAGIC, sizeof(MAGIC));
+    put<std::uint32_t>(header, OFF_VERSION, VERSION);
+    put<std::uint32_t>(header, OFF_HEADER_SIZE, static_cast<std::uint32_t>(HEADER_SIZE));
+    put<std::uint64_t>(header, OFF_COUNT, n);
+    put<double>(header, OFF_TIME_STEP, s.timeStep);
+    put<double>(header, OFF_SAFETY, s.safetyDistance);
+    put<double>(header, OFF_LOG_RES, s.logResolution);
+    put<std::uint64_t>(header, OFF_LOG_INTERVAL, s.logKeyframeInterval);
+    put<std::uint32_t>(header, OFF_LOGGING, s.enableLogging ? 1u : 0u);
+    put<std::uint32_t>(header, OFF_THREADS, s.threadCount);
+    std::memcpy(header.data() + OFF_SPEED_UNIT, s.speedUnit.data(), s.speedUnit.size());
+
+    std::size_t offsets[COLUMNS];
+    std::size_t sizes[COLUMNS];
+    std::size_t end = HEADER_SIZE;
+    for (std::size_t c = 0; c < COLUMNS; c++) {
+        sizes[c] = n * (c == 0 ? sizeof(std::int32_t) : sizeof(double));
+        offsets[c] = alignUp(end);
+        end = offsets[c] + sizes[c];
+        put<std::uint64_t>(header, OFF_COLUMNS + c * sizeof(std::uint64_t), offsets[c]);
+    }
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        error = "cannot create " + path;
+        return false;
+    }
+    out.write(header.data(), static_cast<std::streamsize>(header.size()));
+    std::size_t written = HEADER_SIZE;
+    const char padding[COLUMN_ALIGN] = {};
+    for (std::size_t c = 0; c < COLUMNS; c++) {
+        out.write(padding, static_cast<std::streamsize>(offsets[c] - written));
+        if (sizes[c] > 0) out.write(static_cast<const char*>(data[c]), static_cast<std::streamsize>(sizes[c]));
+        written = offsets[c] + sizes[c];
+    }
+    if (!out) {
+        error = "write failed for " + path;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Maps a scenario file and validates its header and column bounds.
+ *
+ * @param path Path of the file to open.
+ * @param error Receives a description of the failure, if any.
+ * @return true on success, false otherwise.
+ */
+bool ScenarioFile::open(const std::string& path, std::string& error) {
+    count = 0;
+    ids = nullptr;
+    if (!littleEndian()) {
+        error = "scenario files are only supported on little-endian hosts";
+        return false;
+    }
+    if (!file.open(path, error)) return false;
+
+    const unsigned char* data = file.data();
+    const std::size_t size = file.size();
+    if (size < OFF_COLUMNS + COLUMNS * sizeof(std::uint64_t) || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) {
+        error = path + " is not a scenario file";
+        file.close();
+        return false;
+    }
+    std::uint32_t version = get<std::uint32_t>(data, OFF_VERSION);
+    std::uint32_t headerSize = get<std::uint32_t>(data, OFF_HEADER_SIZE);
+    if (version == 0 || version > VERSION || headerSize > size) {
+        error = path + ": unsupported scenario version " + std::to_string(version);
+        file.close();
+        return false;
+    }
+
+    std::uint64_t n = get<std::uint64_t>(data, OFF_COUNT);
+    const void* cols[COLUMNS];
+    for (std::size_t c = 0; c < COLUMNS; c++) {
+        std::uint64_t offset = get<std::uint64_t>(data, OFF_COLUMNS + c * sizeof(std::uint64_t));
+        std::uint64_t elem = c == 0 ? sizeof(std::int32_t) : sizeof(double);
+        if (offset % sizeof(double) != 0 || offset > size || n > (size - offset) / elem) {
+            error = path + ": vehicle table is truncated or corrupt";
+            file.close();
+            return false;
+        }
+        cols[c] = data + offset;
+    }
+
+    char unit[SPEED_UNIT_SIZE + 1] = {};
+    std::memcpy(unit, data + OFF_SPEED_UNIT, SPEED_UNIT_SIZE);
+    settings = Settings{};
+    settings.timeStep = get<double>(data, OFF_TIME_STEP);
+    settings.safetyDistance = get<double>(data, OFF_SAFETY);
+    settings.speedUnit = unit;
+    settings.enableLogging = get<std::uint32_t>(data, OFF_LOGGING) != 0;
+    settings.logKeyframeInterval = static_cast<std::size_t>(get<std::uint64_t>(data, OFF_LOG_INTERVAL));
+    settings.logResolution = get<double>(data, OFF_LOG_RES);
+    settings.threadCount = get<std::uint32_t>(data, OFF_THREADS);
+
+    count = static_cast<std::size_t>(n);
+    ids = static_cast<const std::int32_t*>(cols[0]);
+    for (std::size_t c = 1; c < COLUMNS; c++) {
+        columns[c - 1] = static_cast<const double*>(cols[c]);
+    }
+    return true;
+}
+
+/**
+ * @brief Unmaps the file; the scenario is empty afterwards.
+ */
+void ScenarioFile::close() {
+    file.close();
+    count = 0;
+    ids = nullptr;
+}
+
+/**
+ * @brief Reads one vehicle from the mapped table.
+ *
+ * @param i Index of the vehicle.
+ * @return Vehicle The vehicle's stored state.
+ */
+Vehicle ScenarioFile::vehicle(std::size_t i) const {
+    return Vehicle(ids[i], columns[0][i], columns[1][i], columns[2][i], columns[3][i], columns[4][i]);
+}
+
+/**
+ * @brief Appends all vehicles of the file to a simulation in one bulk copy per column.
+ *
+ * @param sim The simulation to load into.
+ */
+void ScenarioFile::loadInto(Simulation& sim) const {
+    if (count == 0) return;
+    sim.addVehicleColumns(count, ids, columns[0], columns[1], columns[2], columns[3], columns[4],
+                          columns[5], columns[6]);
+}
@@ -0,0 +1,95 @@
+#ifndef SCENARIOFILE_H
+#define SCENARIOFILE_H
+
+#include "Settings.h"
+#include "Vehicle.h"
+#include "VehicleStore.h"
+#include "MappedFile.h"
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+class Simulation;
+
+/**
+ * @brief Versioned binary scenario file: Settings plus a columnar vehicle table.
+ *
+ * Layout (little-endian, version 1):
+ * - a 256-byte header: magic "VSIMSCEN", version, header size, vehicle count,
+ *   the Settings fields and the byte offset of each vehicle column;
+ * - the vehicle columns id (int32), x, y, speed, direction, length, vx, vy
+ *   (double), each starting on a 64-byte boundary.
+ *
+ * Opening a file maps it into memory and validates the header; the columns
+ * are then read in place, so loading a scenario is one bulk copy per column
+ * into the simulation's vehicle store. The cached velocity components are
+ * stored too, so no trigonometry runs at load time.
+ */
+class ScenarioFile {
+public:
+    /** Current format version written by save(). */
+    static const std::uint32_t VERSION = 1;
+
+    /** Number of vehicle columns in the table. */
+    static const std::size_t COLUMNS = 8;
+
+private:
+    MappedFile file;                    /**< The mapped scenario file. */
+    Settings settings{};                /**< Settings decoded from the header. */
+    std::size_t count = 0;              /**< Number of vehicles in the table. */
+    const std::int32_t* ids = nullptr;  /**< Mapped id column. */
+    const double* columns[COLUMNS - 1] = {}; /**< Mapped x, y, speed, direction, length, vx, vy columns. */
+
+public:
+    /**
+     * @brief Writes settings and vehicles as a scenario file.
+     *
+     * @param path Path of the file to create or overwrite.
+     * @param s The settings to store.
+     * @param vehicles The vehicles to store.
+     * @param error Receives a description of the failure, if any.
+     * @return true on success, false otherwise.
+     */
+    static bool save(const std::string& path, const Settings& s, const VehicleStore& vehicles, std::string& error);
+
+    /**
+     * @brief Maps a scenario file and validates its header and column bounds.
+     *
+     * @param path Path of the file to open.
+     * @param error Receives a description of the failure, if any.
+     * @return true on success, false otherwise.
+     */
+    bool open(const std::string& path, std::string& error);
+
+    /**
+     * @brief Unmaps the file; the scenario is empty afterwards.
+     */
+    void close();
+
+    /**
+     * @brief Returns the settings stored in the file.
+     */
+    const Settings& getSettings() const { return settings; }
+
+    /**
+     * @brief Returns the number of vehicles stored in the file.
+     */
+    std::size_t vehicleCount() const { return count; }
+
+    /**
+     * @brief Reads one vehicle from the mapped table.
+     *
+     * @param i Index of the vehicle.
+     * @return Vehicle The vehicle's stored state.
+     */
+    Vehicle vehicle(std::size_t i) const;
+
+    /**
+     * @brief Appends all vehicles of the file to a simulation in one bulk copy per column.
+     *
+     * @param sim The simulation to load into.
+     */
+    void loadInto(Simulation& sim) const;
+};
+
+#endif // SCENARIOFILE_H
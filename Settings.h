@@ -2,12 +2,17 @@
 #define SETTINGS_H
 
 #include <string>
+#include <cstddef>
 
 struct Settings {
     double timeStep;        // seconds
     double safetyDistance;  // meters
     std::string speedUnit;  // "m/s" or "km/h"
     bool enableLogging;
+    std::size_t logKeyframeInterval = 64; // steps between full keyframes in the run log
+    double logResolution = 1e-6;          // quantization step for logged values between keyframes
+    unsigned threadCount = 1;             // threads used within one step (1 = serial, 0 = all hardware threads)
+    std::string logFile;                  // stream run logs to this file instead of memory (empty = in memory)
 };
 
 #endif
@@ -1,31 +1,329 @@
 
+#define _USE_MATH_DEFINES
 #include "Simulation.h"
+#include "ThreadPool.h"
+#include "RunLogWriter.h"
+#include "AsyncOutput.h"
+#include "AsyncRun.h"
+#include "ClosestApproach.h"
+#include "ArrowTrajectory.h"
 #include <iostream>
+#include <cstdarg>
+#include <cstdio>
 #include <cmath>
 #include <thread>
 #include <chrono>
-#include <corecrt_math_defines.h>
+#include <algorithm>
+#include <limits>
+
+namespace {
+
+/** Fleets smaller than this are checked all-pairs; the grid does not pay off. */
+const size_t GRID_MIN_VEHICLES = 64;
+
+/** Fleets smaller than this are stepped serially even when a thread pool exists. */
+const size_t PARALLEL_MIN_VEHICLES = 16384;
+
+/** Work chunks per worker thread, so uneven chunks still balance across threads. */
+const size_t CHUNKS_PER_THREAD = 4;
+
+/** Steps covered by one contact schedule of an event-driven run before it is rebuilt. */
+const long long EVENT_WINDOW_STEPS = 1024;
+
+/**
+ * @brief Appends printf-formatted text to a string.
+ *
+ * %g prints doubles like std::cout's default formatting, so printouts read
+ * the same as when they were streamed.
+ */
+void appendf(std::string& out, const char* format, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, format);
+    const int n = std::vsnprintf(buf, sizeof(buf), format, args);
+    va_end(args);
+    if (n > 0) out.append(buf, std::min(static_cast<size_t>(n), sizeof(buf) - 1));
+}
+
+/**
+ * @brief Calls f(i) for at most limit indices in [0, n), spread evenly (all of them if limit is 0).
+ */
+template <typename F>
+void forEachSampled(size_t n, size_t limit, F&& f) {
+    if (limit == 0 || n <= limit) {
+        for (size_t i = 0; i < n; i++) f(i);
+        return;
+    }
+    for (size_t k = 0; k < limit; k++) f(k * n / limit);
+}
+
+/**
+ * @brief Appends one conflict event per colliding pair, in ascending index order.
+ */
+void appendConflicts(const VehicleStore& vehs, std::vector<std::pair<std::uint32_t, std::uint32_t>>& pairs,
+                     double dt, long long step, double time, std::vector<ConflictEvent>& out) {
+    std::sort(pairs.begin(), pairs.end());
+    const double* xs = vehs.x().data();
+    const double* ys = vehs.y().data();
+    const double* vxs = vehs.vx().data();
+    const double* vys = vehs.vy().data();
+    for (const auto& p : pairs) {
+        Approach a = closestApproach(xs, ys, vxs, vys, p.first, p.second, dt);
+        out.push_back(ConflictEvent{vehs.id()[p.first], vehs.id()[p.second], step, time,
+                                    std::sqrt(a.endSq), time + a.tau, std::sqrt(a.minSq)});
+    }
+}
+
+/**
+ * @brief Appends one conflict event per colliding pair of a tiled run, in ascending index order.
+ */
+void appendTiledConflicts(const VehicleStore& vehs, const TiledPositions& tiles,
+                          std::vector<std::pair<std::uint32_t, std::uint32_t>>& pairs,
+                          double dt, long long step, double time, std::vector<ConflictEvent>& out) {
+    std::sort(pairs.begin(), pairs.end());
+    for (const auto& p : pairs) {
+        Approach a = tiles.approach(p.first, p.second, dt);
+        out.push_back(ConflictEvent{vehs.id()[p.first], vehs.id()[p.second], step, time,
+                                    std::sqrt(a.endSq), time + a.tau, std::sqrt(a.minSq)});
+    }
+}
+
+} // namespace
 
 /**
  * @brief Constructs a new Simulation object.
  * 
  * Initializes the simulation with the given settings, sets the running flag to false,
- * and initializes the nextRunId to 1.
+ * and initializes the nextRunId to 1. If settings.threadCount asks for more than
+ * one thread, a thread pool is started for intra-step parallelism. If
+ * settings.logFile is set, the file is created and run logs are streamed to
+ * it by a background writer; if it cannot be created, logs stay in memory.
  * 
  * @param s The settings to use for this simulation.
  */
 Simulation::Simulation(Settings s)
-    : settings(s), running(false), nextRunId(1) {}
+    : settings(s), running(false), nextRunId(1), outputSink(std::make_shared<ConsoleSink>()) {
+    if (settings.threadCount != 1) {
+        pool = std::make_unique<ThreadPool>(settings.threadCount);
+        if (pool->size() < 2) pool.reset();
+    }
+    if (!settings.logFile.empty()) {
+        logWriter = std::make_shared<RunLogWriter>(settings.logFile);
+        if (!logWriter->good()) {
+            std::cout << "Cannot create log file " << settings.logFile << "; keeping run logs in memory.\n";
+            logWriter.reset();
+        }
+    }
+}
+
+/**
+ * @brief Forks a simulation from a snapshot, to continue its run with other settings.
+ * 
+ * Copying the snapshot's store shares its columns, so no vehicle data is
+ * copied until the fork's first step moves the vehicles. The snapshot's log
+ * carries no encoder state, so the fork's first logged step is a keyframe. A log prefix that
+ * was streamed to the original simulation's file stays there: the fork's log
+ * then starts at the snapshot step.
+ * 
+ * @param s The settings for the continuation.
+ * @param from The state to continue from.
+ */
+Simulation::Simulation(Settings s, const SimulationSnapshot& from)
+    : Simulation(std::move(s)) {
+    vehicles = from.vehicles;
+    roads = from.roads;
+    laneIndex = from.laneIndex;
+    dynamics = from.dynamics;
+    handles = from.handles;
+    resumeRun = std::make_unique<RunRecord>(from.run);
+    resumeElapsed = from.elapsed;
+    resumeSteps = from.steps;
+    if (resumeRun->logs.isStreamed()) resumeRun->logs.clear();
+}
+
+/**
+ * @brief Destroys the simulation, joining its worker threads if any.
+ */
+Simulation::~Simulation() = default;
+
+Simulation::Simulation(Simulation&& other) noexcept = default;
+Simulation& Simulation::operator=(Simulation&& other) noexcept = default;
 
 /**
  * @brief Adds a new vehicle to the simulation.
  * 
- * This method appends a new vehicle to the list of vehicles in the simulation.
+ * This method converts the vehicle into the structure-of-arrays store used
+ * by the simulation, caching its velocity components.
  * 
  * @param v The Vehicle object to be added to the simulation.
+ * @return VehicleHandle A handle that stays valid until the vehicle is removed.
+ */
+VehicleHandle Simulation::addVehicle(const Vehicle& v) {
+    vehicles.add(v);
+    fleetChanges++;
+    return handles.add(v.id);
+}
+
+/**
+ * @brief Adds a vehicle that accelerates and turns at constant rates.
+ * 
+ * @param v The vehicle to add.
+ * @param model Its acceleration and yaw rate.
+ * @return VehicleHandle A handle that stays valid until the vehicle is removed.
+ */
+VehicleHandle Simulation::addVehicle(const Vehicle& v, const ConstantAcceleration::Params& model) {
+    dynamics.add(static_cast<std::uint32_t>(vehicles.size()), model);
+    return addVehicle(v);
+}
+
+/**
+ * @brief Adds a free-space vehicle driven by the Intelligent Driver Model.
+ * 
+ * @param v The vehicle to add.
+ * @param model Its IDM parameters.
+ * @param error Receives a description of the failure, if any.
+ * @return true on success, false if the parameters are invalid.
+ */
+bool Simulation::addVehicle(const Vehicle& v, const IntelligentDriver::Params& model, std::string& error) {
+    if (!IntelligentDriver::validate(model, error)) return false;
+    dynamics.add(static_cast<std::uint32_t>(vehicles.size()), model);
+    addVehicle(v);
+    return true;
+}
+
+/**
+ * @brief Adds count vehicles at once, growing the vehicle store and the handle table only once.
+ * 
+ * @param first Pointer to the first vehicle to add.
+ * @param count Number of vehicles to add.
+ */
+void Simulation::addVehicles(const Vehicle* first, size_t count) {
+    // Grow at least geometrically so repeated batches stay amortized O(1) per vehicle
+    const size_t capacity = std::max(vehicles.size() + count, vehicles.size() * 2);
+    vehicles.reserve(capacity);
+    handles.reserve(capacity);
+    for (size_t i = 0; i < count; i++) {
+        vehicles.add(first[i]);
+        handles.add(first[i].id);
+    }
+    fleetChanges++;
+}
+
+/**
+ * @brief Adds n vehicles given as columns, e.g. straight from a mapped scenario file.
+ * 
+ * Each column is appended with a single bulk copy, and the handle table is
+ * grown once before the vehicles are registered.
+ */
+void Simulation::addVehicleColumns(size_t n, const std::int32_t* idCol, const double* xCol, const double* yCol,
+                                   const double* speedCol, const double* directionCol, const double* lengthCol,
+                                   const double* vxCol, const double* vyCol) {
+    vehicles.append(n, idCol, xCol, yCol, speedCol, directionCol, lengthCol, vxCol, vyCol);
+    handles.reserve(std::max(handles.size() + n, handles.size() * 2));
+    for (size_t i = 0; i < n; i++) {
+        handles.add(idCol[i]);
+    }
+    fleetChanges++;
+}
+
+/**
+ * @brief Removes a vehicle in O(1), before a run or during one from RunOptions::beforeStep.
+ * 
+ * The handle table, lane index and dynamics batches drop the vehicle and
+ * renumber the store's last vehicle first, while its old index is still
+ * valid; then the store moves it into the gap. The incremental collider
+ * indexes pairs by store index, so its state is dropped.
+ * 
+ * @param h The vehicle's handle.
+ * @return true if the vehicle was removed, false if the handle is stale.
+ */
+bool Simulation::removeVehicle(VehicleHandle h) {
+    const std::uint32_t index = handles.indexOf(h);
+    if (index == VehicleHandle::NONE) return false;
+    const std::uint32_t last = static_cast<std::uint32_t>(vehicles.size() - 1);
+    handles.remove(index);
+    laneIndex.remove(index, last);
+    dynamics.remove(index, last);
+    vehicles.swapRemove(index);
+    collider.reset();
+    fleetChanges++;
+    return true;
+}
+
+/**
+ * @brief Returns the current state of a vehicle.
+ * 
+ * @param h The vehicle's handle.
+ * @param out Receives the vehicle.
+ * @return true on success, false if the handle is stale.
+ */
+bool Simulation::getVehicle(VehicleHandle h, Vehicle& out) const {
+    const std::uint32_t index = handles.indexOf(h);
+    if (index == VehicleHandle::NONE) return false;
+    out = vehicles.get(index);
+    return true;
+}
+
+/**
+ * @brief Replaces the road network.
+ * 
+ * Vehicles bound to lanes of the previous network become free-space vehicles.
+ * 
+ * @param network The lanes and their adjacency.
  */
-void Simulation::addVehicle(const Vehicle& v) {
-    vehicles.push_back(v);
+void Simulation::setRoadNetwork(const RoadNetwork& network) {
+    roads = network;
+    laneIndex.reset(roads);
+}
+
+/**
+ * @brief Adds a vehicle bound to a lane of the road network.
+ * 
+ * The vehicle is placed at arc length s on the lane, heading along it, and
+ * added to the vehicle store like any other vehicle.
+ * 
+ * @param id The vehicle ID.
+ * @param laneId The ID of the lane.
+ * @param s The arc length along the lane at which the vehicle starts, in meters.
+ * @param speed The speed in m/s.
+ * @param length The vehicle length in meters.
+ * @param error Receives a description of the failure, if any.
+ * @return true on success, false if the lane does not exist.
+ */
+bool Simulation::addLaneVehicle(int id, int laneId, double s, double speed, double length, std::string& error) {
+    const int lane = roads.find(laneId);
+    if (lane < 0) {
+        error = "unknown lane " + std::to_string(laneId);
+        return false;
+    }
+    std::uint32_t segment = 0;
+    const LanePose p = roads.locate(static_cast<size_t>(lane), s, segment);
+    const size_t index = vehicles.size();
+    addVehicle(Vehicle{id, p.x, p.y, speed, p.direction, length});
+    vehicles.setPose(index, p.x, p.y, p.direction, p.ux, p.uy);
+    laneIndex.add(static_cast<std::uint32_t>(index), static_cast<size_t>(lane), s);
+    return true;
+}
+
+/**
+ * @brief Adds a lane-bound vehicle that follows its leader with the Intelligent Driver Model.
+ * 
+ * @param id The vehicle ID.
+ * @param laneId The ID of the lane.
+ * @param s The arc length along the lane at which the vehicle starts, in meters.
+ * @param speed The initial speed in m/s.
+ * @param length The vehicle length in meters.
+ * @param model Its IDM parameters.
+ * @param error Receives a description of the failure, if any.
+ * @return true on success, false if the lane does not exist or the parameters are invalid.
+ */
+bool Simulation::addLaneVehicle(int id, int laneId, double s, double speed, double length,
+                                const IntelligentDriver::Params& model, std::string& error) {
+    if (!IntelligentDriver::validate(model, error)) return false;
+    const size_t index = vehicles.size();
+    if (!addLaneVehicle(id, laneId, s, speed, length, error)) return false;
+    dynamics.add(static_cast<std::uint32_t>(index), model);
+    return true;
 }
 
 /**
@@ -40,7 +338,8 @@ void Simulation::viewVehicles() const {
         std::cout << "No vehicles available.\n";
         return;
     }
-    for (const auto& v : vehicles) {
+    for (size_t i = 0; i < vehicles.size(); i++) {
+        Vehicle v = vehicles.get(i);
         std::cout << "ID: " << v.id
                   << " Pos(" << v.x << "," << v.y << ")"
                   << " Speed: " << v.speed
@@ -52,63 +351,235 @@ void Simulation::viewVehicles() const {
 /**
  * @brief Starts the simulation.
  * 
- * This method initiates and runs the main simulation loop. It checks for the minimum
- * number of vehicles, initializes the simulation state, and then enters a loop where it:
- * 1. Advances the simulation by one time step
- * 2. Displays the current positions of all vehicles
- * 3. Checks for collisions
- * 4. Pauses for a short time to control the simulation speed
+ * This method runs the interactive, real-time paced simulation used by the
+ * console menu. It checks for the minimum number of vehicles and then delegates
+ * to run() with real-time pacing and live position printing enabled, so each
+ * step is followed by a printout of all vehicles and a sleep of timeStep seconds.
  * 
- * The simulation continues until a collision occurs, the maximum simulation time
- * is reached, or an external stop condition is met.
+ * The simulation continues until a collision occurs or the maximum simulation
+ * time (5 seconds) is reached. All text goes through the output sink, and
+ * start() waits for it to be written before returning to the menu.
  */
 void Simulation::start() {
     if (vehicles.size() < 2) {
         std::cout << "Need at least 2 vehicles to start simulation.\n";
         return;
     }
+
+    RunOptions options;
+    options.realTime = true;
+    options.verbose = true;
+
+    out().write("\n🚗 Simulation started...\n\n");
+    const std::uint64_t droppedBefore = droppedOutput();
+
+    RunResult result = run(options);
+
+    std::string text;
+    appendf(text, "\nSimulation ended. Status: %s\n", result.record.status.c_str());
+    if (droppedOutput() > droppedBefore) {
+        appendf(text, "(%llu printouts dropped while the output fell behind)\n",
+                static_cast<unsigned long long>(droppedOutput() - droppedBefore));
+    }
+    if (RunTelemetry::enabled()) {
+        const RunTelemetry& t = result.record.telemetry;
+        text += "Phase times:";
+        for (size_t p = 0; p < static_cast<size_t>(TelemetryPhase::Count); p++) {
+            const TelemetryPhase phase = static_cast<TelemetryPhase>(p);
+            appendf(text, " %s %gs", RunTelemetry::phaseName(phase), t.phase(phase).seconds);
+        }
+        appendf(text, " (%llu pairs tested, %llu log bytes)\n", static_cast<unsigned long long>(t.pairsTested),
+                static_cast<unsigned long long>(t.logBytes));
+    }
+    out().write(text);
+    flushOutput();
+}
+
+/**
+ * @brief Executes a simulation run according to the given options.
+ * 
+ * Each iteration advances the simulation by one time step and checks the
+ * current vehicle positions for collisions. Console output and real-time pacing
+ * only happen when requested through the options, so the default is a headless
+ * run that executes as fast as possible. With options.eventDriven, the loop
+ * instead jumps between predicted contacts (see runEventDriven()), provided
+ * no vehicle is lane-bound or has a dynamics model. Under the same
+ * conditions, options.tiledCoordinates moves and checks the vehicles as
+ * fixed-point tiled positions (see TiledPositions), which are written back
+ * to the store whenever the run logs, prints, snapshots or ends; fleets
+ * that do not fit the fixed-point range run on doubles.
+ * 
+ * options.beforeStep is called before every step and may add and remove
+ * vehicles. The log starts a new keyframe when the vehicle set changes, so
+ * vehicles entering and leaving are recorded exactly from the step they do.
+ * 
+ * A forked simulation's first run picks up the snapshot's elapsed time, step
+ * count and log, and is given a run ID of its own.
+ * With options.snapshotStep set, the state after that step is returned in
+ * result.snapshot.
+ * 
+ * @param options Limits and pacing for this run.
+ * @return RunResult The run record and timing statistics.
+ */
+RunResult Simulation::run(const RunOptions& options) {
+    RunResult result;
+    RunRecord& run = result.record;
+
+    if (vehicles.size() < 2 && !options.beforeStep) {
+        run.runId = 0;
+        run.status = "Skipped";
+        return result;
+    }
+    if (!(options.maxSimTime > 0) && options.maxSteps <= 0 && !control) {
+        // Nothing but a collision would end the run, and nothing could stop it
+        run.runId = 0;
+        run.status = "Unbounded";
+        return result;
+    }
+
     running = true;
     double elapsed = 0.0;
+    long long steps = 0;
+    if (resumeRun) {
+        run = std::move(*resumeRun);
+        resumeRun.reset();
+        run.telemetry = RunTelemetry();
+        elapsed = resumeElapsed;
+        steps = resumeSteps;
+    }
+    const long long firstStep = steps;
+    incremental = options.incrementalCollision;
+    collider.reset();
 
-    RunRecord run;
     run.runId = nextRunId++;
     run.status = "Running";
+    if (logWriter && settings.enableLogging && run.logs.empty()) {
+        run.logs.streamTo(logWriter, static_cast<std::uint64_t>(run.runId));
+    }
 
-    std::cout << "\n🚗 Simulation started...\n\n";
+    auto wallStart = std::chrono::steady_clock::now();
+    run.telemetry.origin = wallStart;
+    VS_TELEMETRY_ONLY(const std::uint64_t pairsBefore = pairsTested;)
+
+    long long iterations = 0;
+    if (options.eventDriven && !control && !options.beforeStep && settings.timeStep > 0 && laneIndex.boundCount() == 0 && dynamics.empty()) {
+        iterations = runEventDriven(options, run, elapsed, steps, result.snapshot);
+    }
+    tiled = running && options.tiledCoordinates && settings.timeStep > 0 && laneIndex.boundCount() == 0 &&
+            dynamics.empty() && tiles.load(vehicles, settings.timeStep);
+    tilesAhead = false;
+    if (tiled) incremental = false;
 
     while (running) {
+        if (control && !control->proceed()) break;
+        if (options.beforeStep) {
+            // The callback sees the store as of the last step; fleet changes invalidate the tiles
+            syncTiles();
+            const std::uint64_t changesBefore = fleetChanges;
+            options.beforeStep(*this, steps, elapsed);
+            if (fleetChanges != changesBefore) {
+                collider.reset();
+                tiled = tiled && laneIndex.boundCount() == 0 && dynamics.empty() &&
+                        tiles.load(vehicles, settings.timeStep);
+            }
+        }
         step(elapsed, run);
+        steps++;
+        iterations++;
 
-        // Show live positions
-        std::cout << "Time: " << elapsed << "s\n";
-        for (const auto& v : vehicles) {
-            std::cout << "  Vehicle " << v.id 
-                      << " at (" << v.x << ", " << v.y << ")\n";
+        if (options.verbose && options.printEvery > 0 && steps % options.printEvery == 0) {
+            VS_TELEMETRY_SCOPE(run.telemetry, TelemetryPhase::Output);
+            syncTiles();
+            printPositions(elapsed, options.printVehicles);
         }
-        std::cout << "---------------------------------\n" << std::flush;
 
-        if (checkCollision(run.logs.back().positions)) {
-            std::cout << "\n💥 [ALERT] Collision imminent! Stopping simulation.\n";
+        // Check the live vehicle state so detection does not depend on logging
+        bool collided;
+        {
+            VS_TELEMETRY_SCOPE(run.telemetry, TelemetryPhase::Collision);
+            collided = tiled ? checkCollisionTiled(steps, elapsed, run.conflicts)
+                             : checkCollision(vehicles, steps, elapsed, run.conflicts);
+        }
+        if (collided) {
+            if (options.verbose) {
+                VS_TELEMETRY_SCOPE(run.telemetry, TelemetryPhase::Output);
+                printCollisionAlert(run, options.printVehicles);
+            }
             run.status = "Collision";
             running = false;
+        } else if (steps == options.snapshotStep) {
+            syncTiles();
+            result.snapshot = takeSnapshot(run, elapsed, steps);
         }
 
-        // Sleep for timeStep seconds
-        std::this_thread::sleep_for(std::chrono::milliseconds(
-            static_cast<int>(settings.timeStep * 1000)
-        ));
+        if (options.realTime) {
+            VS_TELEMETRY_SCOPE(run.telemetry, TelemetryPhase::Sleep);
+            // Sleep for timeStep seconds
+            std::this_thread::sleep_for(std::chrono::milliseconds(
+                static_cast<int>(settings.timeStep * 1000)
+            ));
+        }
 
-        // TEMP: Stop after 5 seconds for demo so it doesn't run forever
-        if (elapsed >= 5 && run.status == "Running") {
-            std::cout << "\n⏹️  Max simulation time reached. Stopping.\n";
+        if (running && options.maxSimTime > 0 && elapsed >= options.maxSimTime) {
+            if (options.verbose) {
+                out().tryWrite("\n⏹️  Max simulation time reached. Stopping.\n");
+            }
+            running = false;
+        }
+        if (running && options.maxSteps > 0 && steps >= options.maxSteps) {
+            if (options.verbose) {
+                out().tryWrite("\n⏹️  Step budget exhausted. Stopping.\n");
+            }
             running = false;
         }
+        if (control && running && control->due(steps)) {
+            syncTiles();
+            control->publish(steps, elapsed, run.status, vehicles);
+        }
     }
+    running = false;
+
+    syncTiles();
+    auto wallEnd = std::chrono::steady_clock::now();
+    incremental = false;
+    tiled = false;
+    VS_TELEMETRY_ADD(run.telemetry, pairsTested, pairsTested - pairsBefore);
 
     if (run.status == "Running") run.status = "Stopped";
-    pastRuns.push_back(run);
+    run.logs.finish(run.status);
+    if (control) control->publish(steps, elapsed, run.status, vehicles);
+
+    RunStats& stats = result.stats;
+    stats.steps = steps;
+    stats.simTime = elapsed;
+    stats.wallSeconds = std::chrono::duration<double>(wallEnd - wallStart).count();
+    stats.stepsPerSecond = stats.wallSeconds > 0 ? (steps - firstStep) / stats.wallSeconds : 0.0;
+    stats.iterations = iterations;
 
-    std::cout << "\nSimulation ended. Status: " << run.status << "\n";
+    if (options.recordHistory) {
+        // finish() dropped the encoder state, so copying the record shares its log and copies no per-vehicle data
+        runIndex[run.runId] = pastRuns.size();
+        pastRuns.push_back(run);
+    }
+    return result;
+}
+
+/**
+ * @brief Executes a run that other threads can stop, pause, step and observe.
+ * 
+ * The control is only attached for the duration of the call. A stop ends
+ * the run before its next step with status "Stopped".
+ * 
+ * @param options Limits and pacing for this run.
+ * @param ctrl The control; must outlive the call.
+ * @return RunResult The run record and timing statistics.
+ */
+RunResult Simulation::run(const RunOptions& options, RunControl& ctrl) {
+    control = &ctrl;
+    RunResult result = run(options);
+    control = nullptr;
+    if (result.record.status == "Skipped") ctrl.publish(0, 0.0, result.record.status, vehicles);
+    return result;
 }
 
 /**
@@ -133,35 +604,136 @@ void Simulation::viewHistory() const {
 /**
  * @brief Replays a specific simulation run.
  * 
- * This method searches for a past run with the given runId and, if found,
+ * This method looks up the past run with the given runId and, if found,
  * displays a step-by-step replay of that simulation run, showing the positions
- * of all vehicles at each logged time step.
+ * of the vehicles at each logged time step. Decoding and formatting run on
+ * the calling thread while the drain thread writes the previous steps; the
+ * replay waits for room in the queue rather than dropping text, and for all
+ * of it to be written before returning.
  * 
  * @param runId The ID of the run to replay.
+ * @param maxVehicles Most vehicles printed per step, sampled evenly (0 prints all).
  */
-void Simulation::replayRun(int runId) const {
-    for (const auto& r : pastRuns) {
-        if (r.runId == runId) {
-            std::cout << "\n=== Replay of Run " << r.runId << " ===\n";
-            for (const auto& log : r.logs) {
-                std::cout << "Time: " << log.time << "s\n";
-                for (const auto& v : log.positions) {
-                    std::cout << "  Vehicle " << v.id 
-                              << " Pos(" << v.x << ", " << v.y << ")\n";
-                }
-                std::cout << "---------------------------------\n";
-            }
-            return;
+void Simulation::replayRun(int runId, std::size_t maxVehicles) const {
+    const RunRecord* r = findRun(runId);
+    if (!r) {
+        std::cout << "Run ID not found.\n";
+        return;
+    }
+    AsyncOutput& sink = out();
+    outputText.clear();
+    appendf(outputText, "\n=== Replay of Run %d ===\n", r->runId);
+    for (const auto& log : r->logs) {
+        appendf(outputText, "Time: %gs\n", log.time);
+        if (maxVehicles > 0 && log.positions.size() > maxVehicles) {
+            appendf(outputText, "  (%zu of %zu vehicles)\n", maxVehicles, log.positions.size());
         }
+        forEachSampled(log.positions.size(), maxVehicles, [&](size_t i) {
+            const Vehicle& v = log.positions[i];
+            appendf(outputText, "  Vehicle %d Pos(%g, %g)\n", v.id, v.x, v.y);
+        });
+        outputText += "---------------------------------\n";
+        sink.write(outputText);
+        outputText.clear();
     }
-    std::cout << "Run ID not found.\n";
+    flushOutput();
+}
+
+/**
+ * @brief Looks up a past run by ID in constant time.
+ * 
+ * @param runId The ID of the run.
+ * @return const RunRecord* The run, or null if no run with that ID was recorded.
+ */
+const RunRecord* Simulation::findRun(int runId) const {
+    auto it = runIndex.find(runId);
+    return it == runIndex.end() ? nullptr : &pastRuns[it->second];
+}
+
+/**
+ * @brief Returns the vehicle states of a past run at the logged step closest to a time.
+ * 
+ * Finding the step is a binary search over the run's step times; only that
+ * step is decoded.
+ * 
+ * @param runId The ID of the run.
+ * @param time Simulation time in seconds.
+ * @param out Receives the decoded step.
+ * @return true if the run exists and has logged steps, false otherwise.
+ */
+bool Simulation::positionsAt(int runId, double time, LogEntry& out) const {
+    const RunRecord* r = findRun(runId);
+    if (!r || r->logs.empty()) return false;
+    out = r->logs.atTime(time);
+    return true;
+}
+
+/**
+ * @brief Returns the track of one vehicle in a past run.
+ * 
+ * @param runId The ID of the run.
+ * @param vehicleId The ID of the vehicle.
+ * @param from Start of the time window in seconds (inclusive).
+ * @param to End of the time window in seconds (inclusive).
+ * @return The vehicle's states in step order; empty if the run or vehicle is unknown.
+ */
+std::vector<TrajectoryPoint> Simulation::vehicleTrack(int runId, int vehicleId, double from, double to) const {
+    const RunRecord* r = findRun(runId);
+    if (!r) return {};
+    return r->logs.trajectory(vehicleId, from, to);
+}
+
+/**
+ * @brief Writes one past run as an Arrow IPC trajectory file.
+ * 
+ * @param runId The ID of the run.
+ * @param path Path of the file to create or overwrite.
+ * @param error Receives a description of the failure, if any.
+ * @return true on success, false if the run is unknown or the file cannot be written.
+ */
+bool Simulation::exportRun(int runId, const std::string& path, std::string& error) const {
+    const RunRecord* r = findRun(runId);
+    if (!r) {
+        error = "unknown run " + std::to_string(runId);
+        return false;
+    }
+    ArrowTrajectoryWriter writer(path);
+    if (!writer.write(*r) || !writer.close()) {
+        error = writer.error();
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Writes all past runs to one Arrow IPC trajectory file, in run order.
+ * 
+ * Runs share the file's record batches and dictionaries; the run_id column
+ * tells them apart.
+ * 
+ * @param path Path of the file to create or overwrite.
+ * @param error Receives a description of the failure, if any.
+ * @return true on success, false if the file cannot be written.
+ */
+bool Simulation::exportRuns(const std::string& path, std::string& error) const {
+    ArrowTrajectoryWriter writer(path);
+    for (const RunRecord& r : pastRuns) {
+        if (!writer.write(r)) break;
+    }
+    if (!writer.close()) {
+        error = writer.error();
+        return false;
+    }
+    return true;
 }
 
 /**
  * @brief Advances the simulation by one time step.
  * 
- * This method updates the positions of all vehicles based on their current
- * speed and direction. It also logs the new state if logging is enabled.
+ * This method updates the positions of all vehicles based on their cached
+ * velocity components using the vectorized kernel in VehicleStore, split into
+ * chunks across the thread pool for large fleets. It also
+ * appends the new state to the run's compressed log if logging is enabled.
  * 
  * @param elapsed Reference to the total elapsed time of the simulation.
  * @param run Reference to the current run record.
@@ -169,41 +741,550 @@ void Simulation::replayRun(int runId) const {
 void Simulation::step(double& elapsed, RunRecord& run) {
     elapsed += settings.timeStep;
 
-    for (auto& v : vehicles) {
-        double rad = v.direction * M_PI / 180.0;
-        v.x += std::cos(rad) * v.speed * settings.timeStep;
-        v.y += std::sin(rad) * v.speed * settings.timeStep;
+    {
+        VS_TELEMETRY_SCOPE(run.telemetry, TelemetryPhase::Integrate);
+        // Velocities first, then positions: the step's motion is linear, as the collision check assumes
+        if (!dynamics.empty()) dynamics.step(vehicles, laneIndex, settings.timeStep);
+        advance(settings.timeStep);
     }
 
     if (settings.enableLogging) {
-        LogEntry entry;
-        entry.time = elapsed;
-        entry.positions = vehicles;
-        run.logs.push_back(entry);
+        VS_TELEMETRY_SCOPE(run.telemetry, TelemetryPhase::Log);
+        if (run.logs.empty()) {
+            run.logs.configure(settings.logKeyframeInterval, settings.logResolution);
+        }
+        syncTiles();
+        VS_TELEMETRY_ONLY(const std::uint64_t logBefore = run.logs.encodedBytes();)
+        run.logs.record(elapsed, vehicles);
+        VS_TELEMETRY_ADD(run.telemetry, logBytes, run.logs.encodedBytes() - logBefore);
     }
 }
 
 /**
- * @brief Checks for collisions between vehicles.
+ * @brief Moves all vehicles along their velocities for dt seconds.
+ * 
+ * Uses the vectorized kernel in VehicleStore, split into chunks across the
+ * thread pool for large fleets. Lane-bound vehicles are then moved along
+ * their lanes instead, and the lanes' arc-length order is restored.
+ * 
+ * During a run with RunOptions::tiledCoordinates, the tiled positions are
+ * moved by one step instead and the store's positions fall behind until
+ * syncTiles().
+ * 
+ * @param dt The time to advance by, in seconds.
+ */
+void Simulation::advance(double dt) {
+    if (tiled) {
+        if (pool && tiles.size() >= PARALLEL_MIN_VEHICLES) {
+            pool->parallelFor(tiles.size(), pool->size() * CHUNKS_PER_THREAD, [this](size_t, size_t begin, size_t end) {
+                tiles.integrate(begin, end);
+            });
+        } else {
+            tiles.integrate();
+        }
+        tilesAhead = true;
+        return;
+    }
+    if (pool && vehicles.size() >= PARALLEL_MIN_VEHICLES) {
+        vehicles.unsharePositions();
+        pool->parallelFor(vehicles.size(), pool->size() * CHUNKS_PER_THREAD,
+                          [this, dt](size_t, size_t begin, size_t end) {
+            vehicles.integrate(dt, begin, end);
+        });
+    } else {
+        vehicles.integrate(dt);
+    }
+    if (laneIndex.boundCount() > 0) {
+        laneIndex.advance(vehicles, roads, dt);
+    }
+}
+
+/**
+ * @brief Writes the tiled positions to the vehicle store if they moved since the last sync.
+ * 
+ * Called before anything reads the store's positions during a tiled run:
+ * logging, printouts, snapshots and the end of the run.
+ */
+void Simulation::syncTiles() {
+    if (!tilesAhead) return;
+    tiles.store(vehicles);
+    tilesAhead = false;
+}
+
+/**
+ * @brief Executes the loop of an event-driven run.
+ * 
+ * The run still lives on the grid of fixed steps, but only visits the steps
+ * where something can happen: the steps due in the contact schedule, the
+ * sample steps, the step limit, and the end of each schedule window. Between
+ * them all vehicles are moved in a single integration. Every visited step is
+ * checked with the same collision check as a fixed-step run, so a run ends on
+ * the same step and with the same conflicts as with fixed stepping; positions
+ * agree up to rounding, since one long move is not rounded like many short
+ * ones. The clock is advanced by adding timeStep once per skipped step, as in
+ * fixed stepping, so reported times and the maxSimTime limit match exactly.
+ * 
+ * The schedule is rebuilt every EVENT_WINDOW_STEPS steps from the current
+ * positions. The log holds only the sample steps and the final step.
+ * Real-time pacing is not applied. Contacts are predicted along straight
+ * lines, so run() uses fixed stepping while vehicles are bound to lanes.
+ * The snapshot step, if any, is visited like a sample step. A forked run
+ * starts from the snapshot's step and time, so limits and samples stay on
+ * the grid of the original run.
+ * 
+ * @param options Limits and sampling for this run.
+ * @param run The run record being filled.
+ * @param elapsed Receives the simulated time reached.
+ * @param steps Receives the index of the last step reached.
+ * @param snapshot Receives the snapshot asked for by options.snapshotStep.
+ * @return long long The number of loop iterations.
+ */
+long long Simulation::runEventDriven(const RunOptions& options, RunRecord& run, double& elapsed, long long& steps,
+                                     std::shared_ptr<const SimulationSnapshot>& snapshot) {
+    const double dt = settings.timeStep;
+    long long limit = std::numeric_limits<long long>::max() - EVENT_WINDOW_STEPS;
+    if (options.maxSteps > 0) limit = std::min(limit, options.maxSteps);
+    if (options.maxSimTime > 0) {
+        // The step on which fixed stepping stops, found with the same sum
+        double t = elapsed;
+        long long k = steps;
+        while (k < limit && t < options.maxSimTime) {
+            t += dt;
+            k++;
+        }
+        limit = k;
+    }
+    long long sampleEvery = 0;
+    if (options.sampleInterval > 0) {
+        sampleEvery = std::max(1LL, static_cast<long long>(std::llround(options.sampleInterval / dt)));
+    }
+    long long nextSample = sampleEvery > 0 ? (steps / sampleEvery + 1) * sampleEvery : limit;
+    long long windowEnd = steps;
+    long long iterations = 0;
+
+    while (running) {
+        if (steps >= windowEnd) {
+            VS_TELEMETRY_SCOPE(run.telemetry, TelemetryPhase::Collision);
+            windowEnd = std::min(limit, steps + EVENT_WINDOW_STEPS);
+            contacts.build(vehicles, settings.safetyDistance, dt, steps, windowEnd);
+        }
+        long long target = std::min(windowEnd, nextSample);
+        if (!contacts.empty()) target = std::min(target, contacts.nextStep());
+        if (options.snapshotStep > steps) target = std::min(target, options.snapshotStep);
+
+        {
+            VS_TELEMETRY_SCOPE(run.telemetry, TelemetryPhase::Integrate);
+            advance(static_cast<double>(target - steps) * dt);
+        }
+        for (; steps < target; steps++) {
+            elapsed += dt;
+        }
+        iterations++;
+
+        bool collided;
+        {
+            VS_TELEMETRY_SCOPE(run.telemetry, TelemetryPhase::Collision);
+            collided = checkCollision(vehicles, steps, elapsed, run.conflicts);
+            // Pairs due now that are still in contact may first be seen a step later
+            const double now = static_cast<double>(steps) * dt;
+            while (!contacts.empty() && contacts.nextStep() <= steps) {
+                ContactEvent e = contacts.pop();
+                if (!collided && now <= e.exitTime + dt) {
+                    e.step = steps + 1;
+                    contacts.push(e);
+                }
+            }
+        }
+
+        const bool sample = steps == nextSample;
+        if (sample) nextSample += sampleEvery;
+        if (collided) {
+            run.status = "Collision";
+            running = false;
+        } else if (steps >= limit) {
+            running = false;
+        }
+
+        if (settings.enableLogging && (sample || !running)) {
+            VS_TELEMETRY_SCOPE(run.telemetry, TelemetryPhase::Log);
+            if (run.logs.empty()) {
+                run.logs.configure(settings.logKeyframeInterval, settings.logResolution);
+            }
+            VS_TELEMETRY_ONLY(const std::uint64_t logBefore = run.logs.encodedBytes();)
+            run.logs.record(elapsed, vehicles);
+            VS_TELEMETRY_ADD(run.telemetry, logBytes, run.logs.encodedBytes() - logBefore);
+        }
+        if (!collided && steps == options.snapshotStep) {
+            snapshot = takeSnapshot(run, elapsed, steps);
+        }
+        if (options.verbose) {
+            VS_TELEMETRY_SCOPE(run.telemetry, TelemetryPhase::Output);
+            if (collided || (options.printEvery > 0 && steps % options.printEvery == 0)) {
+                printPositions(elapsed, options.printVehicles);
+            }
+            if (collided) printCollisionAlert(run, options.printVehicles);
+        }
+    }
+    return iterations;
+}
+
+/**
+ * @brief Captures the state of the run in progress.
+ * 
+ * The vehicle store and the run log are copied by sharing, so the cost does
+ * not grow with the number of steps recorded so far. Telemetry is left out:
+ * a fork measures only its own steps.
+ * 
+ * @param run The run record being filled.
+ * @param elapsed The simulated time reached.
+ * @param steps The number of steps executed.
+ * @return The snapshot, sharing the vehicle columns and recorded log.
+ */
+std::shared_ptr<const SimulationSnapshot> Simulation::takeSnapshot(const RunRecord& run, double elapsed,
+                                                                   long long steps) const {
+    auto snap = std::make_shared<SimulationSnapshot>();
+    snap->settings = settings;
+    snap->vehicles = vehicles;
+    snap->roads = roads;
+    snap->laneIndex = laneIndex;
+    snap->dynamics = dynamics;
+    snap->handles = handles;
+    snap->elapsed = elapsed;
+    snap->steps = steps;
+    snap->run.runId = run.runId;
+    snap->run.status = run.status;
+    snap->run.logs = run.logs.prefix();
+    snap->run.conflicts = run.conflicts;
+    return snap;
+}
+
+/**
+ * @brief Replaces the destination of run and replay printouts.
  * 
- * This method iterates through all pairs of vehicles and calculates the
- * distance between them. If any pair of vehicles is closer than the sum
- * of their lengths plus the safety distance, a collision is detected.
+ * The current queue is drained into the previous sink and stopped; the next
+ * printout starts a queue to the new one.
  * 
- * @param vehs The vector of vehicles to check for collisions.
+ * @param sink The new sink.
+ */
+void Simulation::setOutputSink(std::shared_ptr<OutputSink> sink) {
+    output.reset();
+    outputSink = std::move(sink);
+}
+
+/**
+ * @brief Blocks until every queued printout has been written to the sink.
+ */
+void Simulation::flushOutput() const {
+    if (output) output->flush();
+}
+
+/**
+ * @brief Returns the number of printouts dropped because the sink fell behind.
+ */
+std::uint64_t Simulation::droppedOutput() const {
+    return output ? output->droppedMessages() : 0;
+}
+
+/**
+ * @brief Returns the queue to the output sink, starting its drain thread on first use.
+ * 
+ * Headless simulations never print, so they never start the thread.
+ */
+AsyncOutput& Simulation::out() const {
+    if (!output) output = std::make_unique<AsyncOutput>(outputSink);
+    return *output;
+}
+
+/**
+ * @brief Queues the current position of the vehicles, without waiting for the sink.
+ * 
+ * The whole step is formatted into one message, so a step is either printed
+ * completely or, if the sink has fallen a full queue behind, dropped.
+ * Fleets larger than maxVehicles are sampled evenly.
+ * 
+ * @param elapsed The simulation time to print.
+ * @param maxVehicles Most vehicles to print, sampled evenly (0 prints all).
+ */
+void Simulation::printPositions(double elapsed, std::size_t maxVehicles) const {
+    const auto& ids = vehicles.id();
+    const auto& xs = vehicles.x();
+    const auto& ys = vehicles.y();
+    outputText.clear();
+    appendf(outputText, "Time: %gs\n", elapsed);
+    if (maxVehicles > 0 && vehicles.size() > maxVehicles) {
+        appendf(outputText, "  (%zu of %zu vehicles)\n", maxVehicles, vehicles.size());
+    }
+    forEachSampled(vehicles.size(), maxVehicles, [&](size_t i) {
+        appendf(outputText, "  Vehicle %d at (%g, %g)\n", ids[i], xs[i], ys[i]);
+    });
+    outputText += "---------------------------------\n";
+    out().tryWrite(outputText);
+}
+
+/**
+ * @brief Queues the collision alert and the conflicts of a run, without waiting for the sink.
+ * 
+ * @param run The run that ended in a collision.
+ * @param maxConflicts Most conflicts to print (0 prints all).
+ */
+void Simulation::printCollisionAlert(const RunRecord& run, std::size_t maxConflicts) const {
+    outputText = "\n💥 [ALERT] Collision imminent! Stopping simulation.\n";
+    const size_t shown = maxConflicts > 0 ? std::min(maxConflicts, run.conflicts.size()) : run.conflicts.size();
+    for (size_t k = 0; k < shown; k++) {
+        const ConflictEvent& c = run.conflicts[k];
+        appendf(outputText, "  Vehicles %d & %d closest %gm at t=%gs\n",
+                c.vehicleA, c.vehicleB, c.closestDistance, c.closestTime);
+    }
+    if (shown < run.conflicts.size()) {
+        appendf(outputText, "  ... and %zu more\n", run.conflicts.size() - shown);
+    }
+    out().tryWrite(outputText);
+}
+
+/**
+ * @brief Checks for collisions between vehicles during the step that just ended.
+ * 
+ * This method bins the vehicles into a uniform grid whose cell size is the
+ * largest possible danger distance (max length + safety distance) plus the
+ * furthest two vehicles can close in on each other within one step, so only
+ * vehicles in the same or adjacent cells need testing. Candidate pairs are
+ * tested with the continuous squared-distance narrow phase, so fast vehicles
+ * cannot tunnel through each other between steps. Small fleets skip the grid
+ * because the all-pairs loop is cheaper for them. With a thread pool, large
+ * fleets are binned and tested in parallel chunks whose hits are merged and
+ * sorted, so the reported conflicts are identical to the serial path.
+ * 
+ * Lane-bound vehicles are only tested against their lane neighbours (see
+ * checkLanePairs()) and against free-space vehicles; when every vehicle is
+ * lane-bound, the grid is skipped altogether.
+ * 
+ * During a run with RunOptions::incrementalCollision, the grid is replaced
+ * by the IncrementalCollider, which keeps its candidate pairs and their
+ * safe-until times from the previous step; it runs on the calling thread.
+ * 
+ * @param vehs The vehicle store to check for collisions.
+ * @param step The index of the step being checked, recorded in the events.
+ * @param time The simulation time at the end of the step.
+ * @param out The list the conflict events are appended to.
+ * @return true if a collision is detected, false otherwise.
+ */
+bool Simulation::checkCollision(const VehicleStore& vehs, long long step, double time,
+                                std::vector<ConflictEvent>& out) {
+    const double dt = settings.timeStep;
+    // Slightly enlarge the cells so rounding in the cell index cannot split
+    // two vehicles that are exactly one danger distance apart.
+    double cellSize = (vehs.maxLength() + settings.safetyDistance + 2 * vehs.maxSpeed() * dt) * 1.000001;
+    const size_t bound = laneIndex.boundCount();
+    if (vehs.size() < GRID_MIN_VEHICLES || !(cellSize > 0) || !std::isfinite(cellSize)) {
+        VS_TELEMETRY_ONLY(pairsTested += vehs.size() * (vehs.size() - 1) / 2 - (bound > 0 ? bound * (bound - 1) / 2 : 0);)
+        return checkCollisionAllPairs(vehs, step, time, out);
+    }
+
+    const double* xs = vehs.x().data();
+    const double* ys = vehs.y().data();
+    const double* vxs = vehs.vx().data();
+    const double* vys = vehs.vy().data();
+    const double* lens = vehs.length().data();
+    const double safety = settings.safetyDistance;
+
+    hits.clear();
+    const bool lanes = bound > 0;
+    if (lanes) {
+        const std::uint64_t tested = checkLanePairs(vehs, hits);
+        VS_TELEMETRY_ONLY(pairsTested += tested;)
+        (void)tested;
+        if (bound == vehs.size()) {
+            appendConflicts(vehs, hits, dt, step, time, out);
+            return !hits.empty();
+        }
+    }
+    if (incremental && dt > 0) {
+        IncrementalCollider::Motion motion = IncrementalCollider::Motion::Linear;
+        if (!dynamics.empty()) {
+            motion = IncrementalCollider::Motion::Bounded;
+        } else if (lanes) {
+            motion = IncrementalCollider::Motion::ConstantSpeed;
+        }
+        const std::uint64_t tested = collider.check(vehs, settings.safetyDistance, dt, time, motion, laneIndex, hits);
+        VS_TELEMETRY_ONLY(pairsTested += tested;)
+        (void)tested;
+    } else if (pool && vehs.size() >= PARALLEL_MIN_VEHICLES) {
+        // Each chunk of grid entries collects its own hits; appendConflicts()
+        // sorts the merged list, so the result matches the serial path.
+        const size_t chunks = pool->size() * CHUNKS_PER_THREAD;
+        grid.build(xs, ys, vehs.size(), cellSize, pool.get(), chunks);
+        chunkHits.resize(chunks);
+        for (auto& local : chunkHits) {
+            local.clear();
+        }
+        VS_TELEMETRY_ONLY(chunkPairs.assign(chunks, 0);)
+        pool->parallelFor(grid.size(), chunks, [&](size_t c, size_t begin, size_t end) {
+            auto& local = chunkHits[c];
+            VS_TELEMETRY_ONLY(std::uint64_t tested = 0;)
+            grid.forEachCandidatePair(begin, end, [&](std::uint32_t i, std::uint32_t j) {
+                if (lanes && laneIndex.isBound(i) && laneIndex.isBound(j)) return false;
+                VS_TELEMETRY_ONLY(tested++;)
+                if (inDanger(xs, ys, vxs, vys, lens, i, j, safety, dt)) {
+                    local.emplace_back(std::min(i, j), std::max(i, j));
+                }
+                return false;
+            });
+            VS_TELEMETRY_ONLY(chunkPairs[c] = tested;)
+        });
+        for (const auto& local : chunkHits) {
+            hits.insert(hits.end(), local.begin(), local.end());
+        }
+        VS_TELEMETRY_ONLY(for (std::uint64_t tested : chunkPairs) pairsTested += tested;)
+    } else {
+        grid.build(xs, ys, vehs.size(), cellSize);
+        grid.forEachCandidatePair([&](std::uint32_t i, std::uint32_t j) {
+            if (lanes && laneIndex.isBound(i) && laneIndex.isBound(j)) return false;
+            VS_TELEMETRY_ONLY(pairsTested++;)
+            if (inDanger(xs, ys, vxs, vys, lens, i, j, safety, dt)) {
+                hits.emplace_back(std::min(i, j), std::max(i, j));
+            }
+            return false;
+        });
+    }
+    appendConflicts(vehs, hits, dt, step, time, out);
+    return !hits.empty();
+}
+
+/**
+ * @brief Checks for collisions during the step that just ended using the tiled positions.
+ * 
+ * The same broad phase as checkCollision() on fixed-point coordinates: the
+ * cells are a whole number of units wide and cell indices come from integer
+ * division, and the narrow phase is TiledPositions::approach(). Decisions
+ * therefore depend only on integer positions and steps and are identical
+ * for every thread count and platform, and for the same scenario moved
+ * anywhere on the map.
+ * 
+ * @param step The index of the step being checked, recorded in the events.
+ * @param time The simulation time at the end of the step.
+ * @param out The list the conflict events are appended to.
  * @return true if a collision is detected, false otherwise.
  */
-bool Simulation::checkCollision(const std::vector<Vehicle>& vehs) {
+bool Simulation::checkCollisionTiled(long long step, double time, std::vector<ConflictEvent>& out) {
+    const double dt = settings.timeStep;
+    const double safety = settings.safetyDistance;
+    const double* lens = vehicles.length().data();
+    const size_t n = tiles.size();
+    auto danger = [&](std::uint32_t i, std::uint32_t j) {
+        return tiles.inDanger(i, j, std::max(lens[i], lens[j]) + safety);
+    };
+
+    hits.clear();
+    // Two vehicles in danger end the step at most reach + twice the largest step apart
+    const double reachUnits = std::ceil((vehicles.maxLength() + safety) * (1 << TiledPositions::UNIT_BITS) * 1.000001);
+    const double cellUnits = reachUnits + 2.0 * static_cast<double>(tiles.maxStep()) + 1;
+    if (n < GRID_MIN_VEHICLES || !(reachUnits > 0) || !(cellUnits < std::ldexp(1.0, 62))) {
+        VS_TELEMETRY_ONLY(pairsTested += n * (n - 1) / 2;)
+        for (std::uint32_t i = 0; i < n; i++) {
+            for (std::uint32_t j = i + 1; j < n; j++) {
+                if (danger(i, j)) hits.emplace_back(i, j);
+            }
+        }
+    } else if (pool && n >= PARALLEL_MIN_VEHICLES) {
+        const size_t chunks = pool->size() * CHUNKS_PER_THREAD;
+        grid.build(tiles.tileX().data(), tiles.tileY().data(), tiles.offsetX().data(), tiles.offsetY().data(),
+                   TiledPositions::TILE_BITS, n, static_cast<std::int64_t>(cellUnits), pool.get(), chunks);
+        chunkHits.resize(chunks);
+        for (auto& local : chunkHits) {
+            local.clear();
+        }
+        VS_TELEMETRY_ONLY(chunkPairs.assign(chunks, 0);)
+        pool->parallelFor(grid.size(), chunks, [&](size_t c, size_t begin, size_t end) {
+            auto& local = chunkHits[c];
+            VS_TELEMETRY_ONLY(std::uint64_t tested = 0;)
+            grid.forEachCandidatePair(begin, end, [&](std::uint32_t i, std::uint32_t j) {
+                VS_TELEMETRY_ONLY(tested++;)
+                if (danger(i, j)) local.emplace_back(std::min(i, j), std::max(i, j));
+                return false;
+            });
+            VS_TELEMETRY_ONLY(chunkPairs[c] = tested;)
+        });
+        for (const auto& local : chunkHits) {
+            hits.insert(hits.end(), local.begin(), local.end());
+        }
+        VS_TELEMETRY_ONLY(for (std::uint64_t tested : chunkPairs) pairsTested += tested;)
+    } else {
+        grid.build(tiles.tileX().data(), tiles.tileY().data(), tiles.offsetX().data(), tiles.offsetY().data(),
+                   TiledPositions::TILE_BITS, n, static_cast<std::int64_t>(cellUnits));
+        grid.forEachCandidatePair([&](std::uint32_t i, std::uint32_t j) {
+            VS_TELEMETRY_ONLY(pairsTested++;)
+            if (danger(i, j)) hits.emplace_back(std::min(i, j), std::max(i, j));
+            return false;
+        });
+    }
+    appendTiledConflicts(vehicles, tiles, hits, dt, step, time, out);
+    return !hits.empty();
+}
+
+/**
+ * @brief Reference O(n^2) collision check over all vehicle pairs.
+ * 
+ * This method iterates through all pairs of vehicles and tests whether their
+ * closest approach during the last step came within the larger of their
+ * lengths plus the safety distance. It is kept as the reference
+ * implementation for the grid path. Pairs of lane-bound vehicles are left to
+ * checkLanePairs(), as in the grid path.
+ * 
+ * @param vehs The vehicle store to check for collisions.
+ * @param step The index of the step being checked, recorded in the events.
+ * @param time The simulation time at the end of the step.
+ * @param out The list the conflict events are appended to.
+ * @return true if a collision is detected, false otherwise.
+ */
+bool Simulation::checkCollisionAllPairs(const VehicleStore& vehs, long long step, double time,
+                                        std::vector<ConflictEvent>& out) const {
+    const double* xs = vehs.x().data();
+    const double* ys = vehs.y().data();
+    const double* vxs = vehs.vx().data();
+    const double* vys = vehs.vy().data();
+    const double* lens = vehs.length().data();
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> pairs;
+    const bool lanes = laneIndex.boundCount() > 0;
+    if (lanes) checkLanePairs(vehs, pairs);
     for (size_t i = 0; i < vehs.size(); i++) {
         for (size_t j = i + 1; j < vehs.size(); j++) {
-            double dx = vehs[i].x - vehs[j].x;
-            double dy = vehs[i].y - vehs[j].y;
-            double dist = std::sqrt(dx * dx + dy * dy);
-            double minDist = std::max(vehs[i].length, vehs[j].length) + settings.safetyDistance;
-            if (dist <= minDist) {
-                return true;
+            if (lanes && laneIndex.isBound(i) && laneIndex.isBound(j)) continue;
+            if (inDanger(xs, ys, vxs, vys, lens, i, j, settings.safetyDistance, settings.timeStep)) {
+                pairs.emplace_back(static_cast<std::uint32_t>(i), static_cast<std::uint32_t>(j));
             }
         }
     }
-    return false;
-}
\ No newline at end of file
+    appendConflicts(vehs, pairs, settings.timeStep, step, time, out);
+    return !pairs.empty();
+}
+
+/**
+ * @brief Tests the leader/follower and adjacent-lane pairs of the lane-bound vehicles.
+ * 
+ * Uses the same narrow phase as free-space vehicles, along the vehicles'
+ * current headings. Vehicles in the same lane or in adjacent lanes cannot
+ * come close without first being neighbours in the lanes' arc-length order,
+ * so this finds their conflicts in O(n) without a grid.
+ * 
+ * @param vehs The vehicle store to check; its lane-bound vehicles are those of laneIndex.
+ * @param out The list the colliding index pairs are appended to.
+ * @return std::uint64_t The number of pairs tested.
+ */
+std::uint64_t Simulation::checkLanePairs(const VehicleStore& vehs,
+                                         std::vector<std::pair<std::uint32_t, std::uint32_t>>& out) const {
+    const double* xs = vehs.x().data();
+    const double* ys = vehs.y().data();
+    const double* vxs = vehs.vx().data();
+    const double* vys = vehs.vy().data();
+    const double* lens = vehs.length().data();
+    const double safety = settings.safetyDistance;
+    const double dt = settings.timeStep;
+    std::uint64_t tested = 0;
+    laneIndex.forEachNeighborPair([&](std::uint32_t i, std::uint32_t j) {
+        tested++;
+        if (inDanger(xs, ys, vxs, vys, lens, i, j, safety, dt)) {
+            out.emplace_back(std::min(i, j), std::max(i, j));
+        }
+    });
+    return tested;
+}
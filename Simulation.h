@@ -2,19 +2,51 @@
 #define SIMULATION_H
 
 #include "Vehicle.h"
+#include "VehicleStore.h"
+#include "SpatialGrid.h"
+#include "ContactSchedule.h"
+#include "IncrementalCollider.h"
+#include "TiledPositions.h"
+#include "RoadNetwork.h"
+#include "LaneIndex.h"
+#include "VehiclePool.h"
+#include "Dynamics.h"
+#include "RunLog.h"
 #include "Settings.h"
+#include "Telemetry.h"
+#include "OutputSink.h"
 #include <vector>
 #include <string>
+#include <utility>
+#include <cstdint>
+#include <memory>
+#include <limits>
+#include <unordered_map>
+#include <functional>
+
+class ThreadPool;
+class RunLogWriter;
+class AsyncOutput;
+class RunControl;
+class Simulation;
 
 /**
- * @brief Represents a single log entry in the simulation.
+ * @brief A pair of vehicles found in collision danger during a step.
  *
- * This struct stores the state of all vehicles at a specific point in time
- * during the simulation.
+ * Detection is continuous: each vehicle is assumed to move along its velocity
+ * for the whole step, and the closest approach of the pair within the step is
+ * computed analytically. A pair is reported when that closest distance is
+ * within max(length) + safetyDistance, even if the vehicles have already
+ * passed each other by the end of the step.
  */
-struct LogEntry {
-    double time; /**< The simulation time at which this log entry was created. */
-    std::vector<Vehicle> positions; /**< The positions and states of all vehicles at this time. */
+struct ConflictEvent {
+    int vehicleA;           /**< ID of the first vehicle (the one added earlier). */
+    int vehicleB;           /**< ID of the second vehicle. */
+    long long step;         /**< 1-based index of the step in which the conflict was found. */
+    double time;            /**< Simulation time at the end of that step, in seconds. */
+    double distance;        /**< Distance between the vehicles at the end of the step, in meters. */
+    double closestTime;     /**< Simulation time of closest approach within the step, in seconds. */
+    double closestDistance; /**< Distance at closest approach, in meters. */
 };
 
 /**
@@ -27,7 +59,76 @@ struct LogEntry {
 struct RunRecord {
     int runId; /**< Unique identifier for this simulation run. */
     std::string status; /**< The final status of the simulation (e.g., "Running", "Collision", "Stopped"). */
-    std::vector<LogEntry> logs; /**< A chronological log of vehicle positions throughout the simulation. */
+    RunLog logs; /**< A chronological, compressed log of vehicle positions throughout the simulation. */
+    std::vector<ConflictEvent> conflicts; /**< All colliding pairs found in the step that ended the run. */
+    RunTelemetry telemetry; /**< Per-phase timers and counters; all zero unless built with VEHICLESIM_TELEMETRY. */
+};
+
+/**
+ * @brief Options controlling how a simulation run is executed.
+ *
+ * The defaults describe a headless batch run: steps are executed back-to-back
+ * with no sleeping and no console output. The interactive menu opts into the
+ * real-time paced mode through start().
+ */
+struct RunOptions {
+    double maxSimTime = 5.0;  /**< Simulated seconds after which the run stops (<= 0 disables the limit; set it or maxSteps). */
+    long long maxSteps = 0;   /**< Maximum number of steps to execute (0 disables the limit). */
+    bool realTime = false;    /**< Sleep timeStep seconds after every step to pace the run at wall-clock speed. */
+    bool verbose = false;     /**< Print vehicle positions and alerts to the output sink after every step. */
+    long long printEvery = 1; /**< Verbose runs: print positions only every this many steps (alerts are always printed). */
+    std::size_t printVehicles = 50; /**< Verbose runs: most vehicles printed per step, sampled evenly from larger fleets (0 prints all). */
+    bool recordHistory = true; /**< Append the finished run to the simulation history. */
+    bool eventDriven = false; /**< Jump from one predicted contact to the next instead of checking every step (free-space, constant-velocity fleets only). */
+    double sampleInterval = 0.0; /**< Event-driven runs: log the state every this many seconds (0 logs only the final state). */
+    bool incrementalCollision = false; /**< Check collisions with the IncrementalCollider, which carries its pair list and per-pair safe times across steps. */
+    long long snapshotStep = 0; /**< Capture a SimulationSnapshot after this step if the run gets there without a collision (0 captures none). */
+    bool tiledCoordinates = false; /**< Integrate and check positions as fixed-point tile + offset (free-space, constant-velocity fleets only); takes precedence over incrementalCollision. */
+    std::function<void(Simulation&, long long, double)> beforeStep; /**< Called before every step with the steps executed and the time reached; may add and remove vehicles. Runs use fixed stepping while it is set. */
+};
+
+/**
+ * @brief Timing statistics gathered while executing a run.
+ */
+struct RunStats {
+    long long steps = 0;        /**< Number of steps executed, including the snapshot's steps for a forked run. */
+    double simTime = 0.0;       /**< Simulated time reached when the run ended, in seconds. */
+    double wallSeconds = 0.0;   /**< Wall-clock duration of the run loop, in seconds. */
+    double stepsPerSecond = 0.0; /**< Step throughput of this call (steps executed by it / wallSeconds). */
+    long long iterations = 0;   /**< Loop iterations: equal to steps, fewer for event-driven runs. */
+};
+
+/**
+ * @brief The state of a simulation part-way through a run, from which any number of forks can continue.
+ *
+ * Taking a snapshot copies no vehicle data: the vehicle store shares its
+ * columns and the handle pool its tables copy-on-write, and the run log
+ * shares its recorded steps, leaving its encoder state behind
+ * (RunLog::prefix()). Each fork only duplicates what it changes, typically
+ * the position columns and the log segment it keeps recording into, and the
+ * handle tables once it adds or removes a vehicle. The lane index and
+ * dynamics batches are plain copies; they hold per-vehicle entries only for
+ * lane-bound and modelled vehicles.
+ */
+struct SimulationSnapshot {
+    Settings settings;         /**< Settings of the simulation the snapshot was taken from. */
+    VehicleStore vehicles;     /**< Vehicle states at the end of the snapshot step. */
+    RoadNetwork roads;         /**< Lane layer in effect. */
+    LaneIndex laneIndex;       /**< Lane membership and order of the lane-bound vehicles. */
+    VehicleDynamics dynamics;  /**< Dynamics models of the vehicles. */
+    VehiclePool handles;       /**< Handles of the vehicles, so a fork resolves the same handles. */
+    double elapsed = 0.0;      /**< Simulation time at the end of the snapshot step, in seconds. */
+    long long steps = 0;       /**< Number of steps executed up to the snapshot. */
+    RunRecord run;             /**< The run so far: its log prefix and status "Running". */
+};
+
+/**
+ * @brief The outcome of Simulation::run(): the run record plus timing statistics.
+ */
+struct RunResult {
+    RunRecord record; /**< The completed run record. */
+    RunStats stats;   /**< Timing statistics for the run. */
+    std::shared_ptr<const SimulationSnapshot> snapshot; /**< State after RunOptions::snapshotStep, or null if none was taken. */
 };
 
 /**
@@ -39,10 +140,36 @@ struct RunRecord {
 class Simulation {
 private:
     Settings settings; /**< Configuration settings for the simulation. */
-    std::vector<Vehicle> vehicles; /**< List of vehicles in the current simulation. */
+    VehicleStore vehicles; /**< Structure-of-arrays storage of the vehicles in the current simulation. */
     std::vector<RunRecord> pastRuns; /**< History of past simulation runs. */
+    std::unordered_map<int, std::size_t> runIndex; /**< Position in pastRuns of each recorded run ID. */
     bool running; /**< Flag indicating whether the simulation is currently running. */
     int nextRunId; /**< The ID to be assigned to the next simulation run. */
+    SpatialGrid grid; /**< Broad-phase grid reused by checkCollision() between steps. */
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> hits; /**< Scratch list of colliding index pairs. */
+    std::unique_ptr<ThreadPool> pool; /**< Workers for intra-step parallelism; null when threadCount is 1. */
+    std::vector<std::vector<std::pair<std::uint32_t, std::uint32_t>>> chunkHits; /**< Per-chunk colliding pairs of a parallel check. */
+    std::shared_ptr<RunLogWriter> logWriter; /**< Background writer for settings.logFile; null when logs stay in memory. */
+    std::uint64_t pairsTested = 0; /**< Candidate pairs checked so far; only counted with VEHICLESIM_TELEMETRY. */
+    std::vector<std::uint64_t> chunkPairs; /**< Per-chunk candidate pair counts of a parallel check. */
+    ContactSchedule contacts; /**< Predicted pair contacts of an event-driven run. */
+    IncrementalCollider collider; /**< Cross-step collision state of a run with RunOptions::incrementalCollision. */
+    bool incremental = false; /**< True while a run uses collider instead of the grid. */
+    TiledPositions tiles; /**< Fixed-point positions of a run with RunOptions::tiledCoordinates. */
+    bool tiled = false;      /**< True while a run moves and checks tiles instead of the store's positions. */
+    bool tilesAhead = false; /**< True when tiles have moved since they were last written to the store. */
+    RunControl* control = nullptr; /**< Control of the run in progress, or null when nothing outside the run can steer it. */
+    RoadNetwork roads; /**< Optional lane layer; empty for free-space simulations. */
+    LaneIndex laneIndex; /**< Lane membership and arc-length order of the lane-bound vehicles. */
+    VehicleDynamics dynamics; /**< Vehicles with a dynamics model, batched by model; the rest keep a constant velocity. */
+    VehiclePool handles; /**< Handle and ID lookup of the vehicles, kept in step with the store's order. */
+    std::uint64_t fleetChanges = 0; /**< Incremented whenever a vehicle is added or removed. */
+    std::unique_ptr<RunRecord> resumeRun; /**< Run progress the next run() continues from; null unless forked from a snapshot. */
+    double resumeElapsed = 0.0; /**< Simulation time at which resumeRun continues. */
+    long long resumeSteps = 0;  /**< Number of steps resumeRun has already executed. */
+    std::shared_ptr<OutputSink> outputSink; /**< Destination of run and replay printouts; std::cout unless replaced. */
+    mutable std::unique_ptr<AsyncOutput> output; /**< Queue to the sink's drain thread; started by the first printout. */
+    mutable std::string outputText; /**< Scratch buffer each printout is formatted into. */
 
 public:
     /**
@@ -52,12 +179,200 @@ public:
      */
     Simulation(Settings s);
 
+    /**
+     * @brief Forks a simulation from a snapshot, to continue its run with other settings.
+     * 
+     * The new simulation takes the snapshot's vehicles, lanes and dynamics, and
+     * its next run() continues the snapshot's run instead of starting at time 0.
+     * The snapshot is left unchanged, so it can be forked any number of times.
+     * 
+     * @param s The settings for the continuation. A log prefix kept in memory
+     *          keeps its keyframe interval and resolution and is not moved to s.logFile.
+     * @param from The state to continue from.
+     */
+    Simulation(Settings s, const SimulationSnapshot& from);
+
+    /**
+     * @brief Destroys the simulation, joining its worker threads if any.
+     */
+    ~Simulation();
+
+    Simulation(Simulation&& other) noexcept;            /**< @brief Moves a simulation, including its thread pool. */
+    Simulation& operator=(Simulation&& other) noexcept; /**< @brief Move-assigns a simulation, including its thread pool. */
+
     /**
      * @brief Adds a new vehicle to the simulation.
      * 
+     * Vehicles can also be added during a run, from RunOptions::beforeStep.
+     * 
+     * @param v The vehicle to add.
+     * @return VehicleHandle A handle that stays valid until the vehicle is removed.
+     */
+    VehicleHandle addVehicle(const Vehicle& v);
+
+    /**
+     * @brief Adds a vehicle that accelerates and turns at constant rates.
+     * 
      * @param v The vehicle to add.
+     * @param model Its acceleration and yaw rate.
+     * @return VehicleHandle A handle that stays valid until the vehicle is removed.
+     */
+    VehicleHandle addVehicle(const Vehicle& v, const ConstantAcceleration::Params& model);
+
+    /**
+     * @brief Adds a free-space vehicle driven by the Intelligent Driver Model.
+     * 
+     * Without a lane it has no leader, so it only approaches its desired speed.
+     * 
+     * @param v The vehicle to add.
+     * @param model Its IDM parameters.
+     * @param error Receives a description of the failure, if any.
+     * @return true on success, false if the parameters are invalid.
+     */
+    bool addVehicle(const Vehicle& v, const IntelligentDriver::Params& model, std::string& error);
+
+    /**
+     * @brief Adds count vehicles at once, growing the vehicle store only once.
+     * 
+     * @param first Pointer to the first vehicle to add.
+     * @param count Number of vehicles to add.
+     */
+    void addVehicles(const Vehicle* first, size_t count);
+
+    /**
+     * @brief Adds all vehicles of a vector at once.
+     * 
+     * @param vs The vehicles to add.
+     */
+    void addVehicles(const std::vector<Vehicle>& vs) { addVehicles(vs.data(), vs.size()); }
+
+    /**
+     * @brief Adds n vehicles given as columns, e.g. straight from a mapped scenario file.
+     * 
+     * See VehicleStore::append() for the meaning of the columns; vxCol and vyCol
+     * may be null.
+     */
+    void addVehicleColumns(size_t n, const std::int32_t* idCol, const double* xCol, const double* yCol,
+                           const double* speedCol, const double* directionCol, const double* lengthCol,
+                           const double* vxCol = nullptr, const double* vyCol = nullptr);
+
+    /**
+     * @brief Removes a vehicle in O(1), before a run or during one from RunOptions::beforeStep.
+     * 
+     * The last vehicle of the store takes the removed one's place, so the
+     * store stays dense and the order of the remaining vehicles changes.
+     * Handles of the other vehicles stay valid; the removed vehicle's handle
+     * becomes stale. Removing a lane-bound vehicle also costs a shift of the
+     * vehicles ahead of it in its lane.
+     * 
+     * @param h The vehicle's handle.
+     * @return true if the vehicle was removed, false if the handle is stale.
+     */
+    bool removeVehicle(VehicleHandle h);
+
+    /**
+     * @brief Finds a vehicle by ID in constant time.
+     * 
+     * @param id The vehicle ID; if several vehicles share it, the one added last.
+     * @return VehicleHandle The vehicle's handle, or the null handle if no vehicle has the ID.
+     */
+    VehicleHandle findVehicle(int id) const { return handles.find(id); }
+
+    /**
+     * @brief Returns the current state of a vehicle.
+     * 
+     * @param h The vehicle's handle.
+     * @param out Receives the vehicle.
+     * @return true on success, false if the handle is stale.
      */
-    void addVehicle(const Vehicle& v);
+    bool getVehicle(VehicleHandle h, Vehicle& out) const;
+
+    /**
+     * @brief Returns the store index of a vehicle, or VehicleHandle::NONE if the handle is stale.
+     */
+    std::uint32_t indexOf(VehicleHandle h) const { return handles.indexOf(h); }
+
+    /**
+     * @brief Replaces the road network.
+     * 
+     * Vehicles bound to lanes of the previous network become free-space vehicles.
+     * 
+     * @param network The lanes and their adjacency.
+     */
+    void setRoadNetwork(const RoadNetwork& network);
+
+    /**
+     * @brief Adds a vehicle bound to a lane of the road network.
+     * 
+     * The vehicle follows the lane's polyline at its speed; its collisions are
+     * only checked against its leader, its follower, the nearest vehicles in
+     * the adjacent lanes and free-space vehicles.
+     * 
+     * @param id The vehicle ID.
+     * @param laneId The ID of the lane.
+     * @param s The arc length along the lane at which the vehicle starts, in meters.
+     * @param speed The speed in m/s.
+     * @param length The vehicle length in meters.
+     * @param error Receives a description of the failure, if any.
+     * @return true on success, false if the lane does not exist.
+     */
+    bool addLaneVehicle(int id, int laneId, double s, double speed, double length, std::string& error);
+
+    /**
+     * @brief Adds a lane-bound vehicle that follows its leader with the Intelligent Driver Model.
+     * 
+     * @param id The vehicle ID.
+     * @param laneId The ID of the lane.
+     * @param s The arc length along the lane at which the vehicle starts, in meters.
+     * @param speed The initial speed in m/s.
+     * @param length The vehicle length in meters.
+     * @param model Its IDM parameters.
+     * @param error Receives a description of the failure, if any.
+     * @return true on success, false if the lane does not exist or the parameters are invalid.
+     */
+    bool addLaneVehicle(int id, int laneId, double s, double speed, double length,
+                        const IntelligentDriver::Params& model, std::string& error);
+
+    /**
+     * @brief Getter for the road network.
+     */
+    const RoadNetwork& getRoadNetwork() const { return roads; }
+
+    /**
+     * @brief Getter for the lane index of the lane-bound vehicles.
+     */
+    const LaneIndex& getLaneIndex() const { return laneIndex; }
+
+    /**
+     * @brief Replaces the destination of run and replay printouts.
+     * 
+     * Text already queued for the previous sink is written to it first.
+     * 
+     * @param sink The new sink, e.g. a FileSink, NullSink or RingBufferSink.
+     */
+    void setOutputSink(std::shared_ptr<OutputSink> sink);
+
+    /**
+     * @brief Blocks until every queued printout has been written to the sink.
+     */
+    void flushOutput() const;
+
+    /**
+     * @brief Returns the number of printouts dropped because the sink fell behind.
+     */
+    std::uint64_t droppedOutput() const;
+
+    /**
+     * @brief Getter for the incremental collision state of the last run that used it.
+     */
+    const IncrementalCollider& getIncrementalCollider() const { return collider; }
+
+    /**
+     * @brief Getter for the simulation settings.
+     * 
+     * @return const Settings& The settings this simulation was created with.
+     */
+    const Settings& getSettings() const { return settings; }
 
     /**
      * @brief Displays information about all vehicles currently in the simulation.
@@ -73,6 +388,41 @@ public:
      */
     void start();
 
+    /**
+     * @brief Executes a simulation run according to the given options.
+     *
+     * Unlike start(), this method is headless by default: it runs steps
+     * back-to-back without sleeping or writing to the console, and stops on
+     * collision, when options.maxSimTime is reached or when options.maxSteps
+     * steps have been executed. It works regardless of settings.enableLogging.
+     *
+     * A simulation forked from a snapshot continues the snapshot's run on its
+     * first call: the limits still count from the start of that run, and the
+     * record holds the snapshot's log prefix followed by the new steps.
+     *
+     * @param options Limits and pacing for this run.
+     * @return RunResult The run record and timing statistics. If fewer than two
+     *         vehicles are present and options.beforeStep is not set, the record
+     *         has runId 0 and status "Skipped". If neither options.maxSimTime
+     *         nor options.maxSteps limits the run, nothing is executed and the
+     *         record has runId 0 and status "Unbounded".
+     */
+    RunResult run(const RunOptions& options = RunOptions());
+
+    /**
+     * @brief Executes a run that other threads can stop, pause, step and observe.
+     *
+     * Works like run(options), except that the control is checked before
+     * every step and a frame is published to it after every due step and at
+     * the end. The run uses fixed stepping even with options.eventDriven.
+     * Since the control can stop it, the run may be unbounded.
+     *
+     * @param options Limits and pacing for this run.
+     * @param ctrl The control; must outlive the call.
+     * @return RunResult The run record and timing statistics.
+     */
+    RunResult run(const RunOptions& options, RunControl& ctrl);
+
     /**
      * @brief Displays the history of past simulation runs.
      */
@@ -82,8 +432,60 @@ public:
      * @brief Replays a specific simulation run.
      * 
      * @param runId The ID of the run to replay.
+     * @param maxVehicles Most vehicles printed per step, sampled evenly (0 prints all).
      */
-    void replayRun(int runId) const;
+    void replayRun(int runId, std::size_t maxVehicles = 50) const;
+
+    /**
+     * @brief Looks up a past run by ID in constant time.
+     * 
+     * @param runId The ID of the run.
+     * @return const RunRecord* The run, or null if no run with that ID was recorded.
+     *         The pointer is invalidated by the next recorded run.
+     */
+    const RunRecord* findRun(int runId) const;
+
+    /**
+     * @brief Returns the vehicle states of a past run at the logged step closest to a time.
+     * 
+     * @param runId The ID of the run.
+     * @param time Simulation time in seconds.
+     * @param out Receives the decoded step.
+     * @return true if the run exists and has logged steps, false otherwise.
+     */
+    bool positionsAt(int runId, double time, LogEntry& out) const;
+
+    /**
+     * @brief Returns the track of one vehicle in a past run.
+     * 
+     * @param runId The ID of the run.
+     * @param vehicleId The ID of the vehicle.
+     * @param from Start of the time window in seconds (inclusive).
+     * @param to End of the time window in seconds (inclusive).
+     * @return The vehicle's states in step order; empty if the run or vehicle is unknown.
+     */
+    std::vector<TrajectoryPoint> vehicleTrack(int runId, int vehicleId,
+                                              double from = -std::numeric_limits<double>::infinity(),
+                                              double to = std::numeric_limits<double>::infinity()) const;
+
+    /**
+     * @brief Writes one past run as an Arrow IPC trajectory file (see ArrowTrajectoryWriter).
+     * 
+     * @param runId The ID of the run.
+     * @param path Path of the file to create or overwrite.
+     * @param error Receives a description of the failure, if any.
+     * @return true on success, false if the run is unknown or the file cannot be written.
+     */
+    bool exportRun(int runId, const std::string& path, std::string& error) const;
+
+    /**
+     * @brief Writes all past runs to one Arrow IPC trajectory file, in run order.
+     * 
+     * @param path Path of the file to create or overwrite.
+     * @param error Receives a description of the failure, if any.
+     * @return true on success, false if the file cannot be written.
+     */
+    bool exportRuns(const std::string& path, std::string& error) const;
 
     /**
      * @brief Public wrapper for the step method, used for testing.
@@ -94,11 +496,44 @@ public:
     void publicStep(double& elapsed, RunRecord& run) { step(elapsed, run); }
 
     /**
-     * @brief Getter for the vehicles vector, used for testing.
+     * @brief Getter for the current vehicles, used for testing.
+     * 
+     * @return std::vector<Vehicle> A copy of the vehicles, converted from the internal store.
+     */
+    std::vector<Vehicle> getVehicles() const { return vehicles.toVehicles(); }
+
+    /**
+     * @brief Getter for the internal structure-of-arrays vehicle store.
+     * 
+     * @return const VehicleStore& A constant reference to the vehicle store.
+     */
+    const VehicleStore& getVehicleStore() const { return vehicles; }
+
+    /**
+     * @brief Public wrapper for the grid-accelerated collision check, used for testing.
+     * 
+     * Checks the time step that ends at the current vehicle positions.
      * 
-     * @return const std::vector<Vehicle>& A constant reference to the vehicles vector.
+     * @return std::vector<ConflictEvent> All pairs in collision danger, reported as step 0.
      */
-    const std::vector<Vehicle>& getVehicles() const { return vehicles; }
+    std::vector<ConflictEvent> publicCheckCollision() {
+        std::vector<ConflictEvent> out;
+        checkCollision(vehicles, 0, 0.0, out);
+        return out;
+    }
+
+    /**
+     * @brief Public wrapper for the all-pairs reference collision check, used for testing.
+     * 
+     * Checks the time step that ends at the current vehicle positions.
+     * 
+     * @return std::vector<ConflictEvent> All pairs in collision danger, reported as step 0.
+     */
+    std::vector<ConflictEvent> publicCheckCollisionAllPairs() const {
+        std::vector<ConflictEvent> out;
+        checkCollisionAllPairs(vehicles, 0, 0.0, out);
+        return out;
+    }
 
 private:
     /**
@@ -110,12 +545,108 @@ private:
     void step(double& elapsed, RunRecord& run);
 
     /**
-     * @brief Checks for collisions between vehicles.
+     * @brief Moves all vehicles along their velocities for dt seconds.
+     * 
+     * @param dt The time to advance by, in seconds.
+     */
+    void advance(double dt);
+
+    /**
+     * @brief Writes the tiled positions to the vehicle store if they moved since the last sync.
+     */
+    void syncTiles();
+
+    /**
+     * @brief Executes the loop of an event-driven run.
+     * 
+     * @param options Limits and sampling for this run.
+     * @param run The run record being filled.
+     * @param elapsed Receives the simulated time reached.
+     * @param steps Receives the index of the last step reached.
+     * @param snapshot Receives the snapshot asked for by options.snapshotStep.
+     * @return long long The number of loop iterations.
+     */
+    long long runEventDriven(const RunOptions& options, RunRecord& run, double& elapsed, long long& steps,
+                             std::shared_ptr<const SimulationSnapshot>& snapshot);
+
+    /**
+     * @brief Captures the state of the run in progress.
+     * 
+     * @param run The run record being filled.
+     * @param elapsed The simulated time reached.
+     * @param steps The number of steps executed.
+     * @return The snapshot, sharing the vehicle columns and recorded log.
+     */
+    std::shared_ptr<const SimulationSnapshot> takeSnapshot(const RunRecord& run, double elapsed, long long steps) const;
+
+    /**
+     * @brief Returns the queue to the output sink, starting its drain thread on first use.
+     */
+    AsyncOutput& out() const;
+
+    /**
+     * @brief Queues the current position of the vehicles, without waiting for the sink.
      * 
-     * @param vehs The vector of vehicles to check for collisions.
+     * @param elapsed The simulation time to print.
+     * @param maxVehicles Most vehicles to print, sampled evenly (0 prints all).
+     */
+    void printPositions(double elapsed, std::size_t maxVehicles) const;
+
+    /**
+     * @brief Queues the collision alert and the conflicts of a run, without waiting for the sink.
+     * 
+     * @param run The run that ended in a collision.
+     * @param maxConflicts Most conflicts to print (0 prints all).
+     */
+    void printCollisionAlert(const RunRecord& run, std::size_t maxConflicts) const;
+
+    /**
+     * @brief Checks for collisions between vehicles during the step that just ended.
+     * 
+     * Uses the uniform-grid broad phase for larger fleets and falls back to the
+     * all-pairs check for small fleets or degenerate cell sizes. Every pair in
+     * danger is appended to out, ordered by the vehicles' store indices.
+     * 
+     * @param vehs The vehicle store to check for collisions.
+     * @param step The index of the step being checked, recorded in the events.
+     * @param time The simulation time at the end of the step.
+     * @param out The list the conflict events are appended to.
      * @return true if a collision is detected, false otherwise.
      */
-    bool checkCollision(const std::vector<Vehicle>& vehs);
+    bool checkCollision(const VehicleStore& vehs, long long step, double time,
+                        std::vector<ConflictEvent>& out);
+
+    /**
+     * @brief Checks for collisions during the step that just ended using the tiled positions.
+     * 
+     * @param step The index of the step being checked, recorded in the events.
+     * @param time The simulation time at the end of the step.
+     * @param out The list the conflict events are appended to.
+     * @return true if a collision is detected, false otherwise.
+     */
+    bool checkCollisionTiled(long long step, double time, std::vector<ConflictEvent>& out);
+
+    /**
+     * @brief Reference O(n^2) collision check over all vehicle pairs.
+     * 
+     * @param vehs The vehicle store to check for collisions.
+     * @param step The index of the step being checked, recorded in the events.
+     * @param time The simulation time at the end of the step.
+     * @param out The list the conflict events are appended to.
+     * @return true if a collision is detected, false otherwise.
+     */
+    bool checkCollisionAllPairs(const VehicleStore& vehs, long long step, double time,
+                                std::vector<ConflictEvent>& out) const;
+
+    /**
+     * @brief Tests the leader/follower and adjacent-lane pairs of the lane-bound vehicles.
+     * 
+     * @param vehs The vehicle store to check; its lane-bound vehicles are those of laneIndex.
+     * @param out The list the colliding index pairs are appended to.
+     * @return std::uint64_t The number of pairs tested.
+     */
+    std::uint64_t checkLanePairs(const VehicleStore& vehs,
+                                 std::vector<std::pair<std::uint32_t, std::uint32_t>>& out) const;
 };
 
 #endif // SIMULATION_H
\ No newline at end of file
@@ -0,0 +1,140 @@
+#include "SpatialGrid.h"
+#include "ThreadPool.h"
+#include <cmath>
+
+namespace {
+
+/**
+ * @brief Converts a coordinate to a cell index, clamping non-finite and huge values.
+ *
+ * Clamping can only merge far-away cells, which adds candidates but never
+ * separates two vehicles that are within one cell of each other.
+ */
+std::int64_t cellIndex(double v, double inv) {
+    const double limit = 1099511627776.0; // 2^40 cells in each direction
+    double c = std::floor(v * inv);
+    if (!(c >= -limit)) c = -limit;
+    if (!(c <= limit)) c = limit;
+    return static_cast<std::int64_t>(c);
+}
+
+} // namespace
+
+/**
+ * @brief Bins n vehicle positions into cells of the given size.
+ *
+ * Cell coordinates and buckets are computed per vehicle first (in parallel
+ * when a pool is given), then a counting sort over hash buckets counts the
+ * vehicles per bucket and scatters vehicle indices and their cell coordinates
+ * into bucket order.
+ *
+ * @param xs X-coordinates of the vehicles.
+ * @param ys Y-coordinates of the vehicles.
+ * @param n Number of vehicles.
+ * @param size Cell edge length in meters; must be positive and finite.
+ * @param pool Optional thread pool used to compute the cell coordinates in parallel.
+ * @param chunks Number of chunks to split the work into when a pool is given.
+ */
+void SpatialGrid::build(const double* xs, const double* ys, std::size_t n, double size,
+                        ThreadPool* pool, std::size_t chunks) {
+    cellSize = size;
+    const double inv = 1.0 / size;
+    prepare(n);
+
+    auto computeCells = [&](std::size_t, std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            rawCellX[i] = cellIndex(xs[i], inv);
+            rawCellY[i] = cellIndex(ys[i], inv);
+            bucketOf[i] = static_cast<std::uint32_t>(bucket(rawCellX[i], rawCellY[i]));
+        }
+    };
+    if (pool && chunks > 1) {
+        pool->parallelFor(n, chunks, computeCells);
+    } else {
+        computeCells(0, 0, n);
+    }
+    sortIntoBuckets(n);
+}
+
+/**
+ * @brief Bins n fixed-point positions, given as tile plus offset, into cells of the given size.
+ *
+ * @param tileX Tile X coordinates.
+ * @param tileY Tile Y coordinates.
+ * @param offX X offsets within the tiles, in units.
+ * @param offY Y offsets within the tiles, in units.
+ * @param tileBits log2 of the tile edge length in units.
+ * @param n Number of vehicles.
+ * @param units Cell edge length in units; must be positive.
+ * @param pool Optional thread pool used to compute the cell coordinates in parallel.
+ * @param chunks Number of chunks to split the work into when a pool is given.
+ */
+void SpatialGrid::build(const std::int32_t* tileX, const std::int32_t* tileY, const std::int32_t* offX,
+                        const std::int32_t* offY, int tileBits, std::size_t n, std::int64_t units,
+                        ThreadPool* pool, std::size_t chunks) {
+    cellSize = 0.0;
+    prepare(n);
+
+    auto floorDiv = [units](std::int64_t v) {
+        const std::int64_t q = v / units;
+        return q * units > v ? q - 1 : q;
+    };
+    auto computeCells = [&](std::size_t, std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            rawCellX[i] = floorDiv(static_cast<std::int64_t>(tileX[i]) * (std::int64_t(1) << tileBits) + offX[i]);
+            rawCellY[i] = floorDiv(static_cast<std::int64_t>(tileY[i]) * (std::int64_t(1) << tileBits) + offY[i]);
+            bucketOf[i] = static_cast<std::uint32_t>(bucket(rawCellX[i], rawCellY[i]));
+        }
+    };
+    if (pool && chunks > 1) {
+        pool->parallelFor(n, chunks, computeCells);
+    } else {
+        computeCells(0, 0, n);
+    }
+    sortIntoBuckets(n);
+}
+
+/**
+ * @brief Sizes the buffers for n vehicles.
+ *
+ * The bucket count is the next power of two at or above 2n, so buckets hold
+ * about one cell on average.
+ */
+void SpatialGrid::prepare(std::size_t n) {
+    std::size_t buckets = 1;
+    while (buckets < 2 * n) buckets <<= 1;
+    bucketMask = buckets - 1;
+
+    bucketStart.assign(buckets + 1, 0);
+    bucketOf.resize(n);
+    rawCellX.resize(n);
+    rawCellY.resize(n);
+    order.resize(n);
+    cellX.resize(n);
+    cellY.resize(n);
+}
+
+/**
+ * @brief Counting sort of the vehicles by bucket, once their cells and buckets are computed.
+ */
+void SpatialGrid::sortIntoBuckets(std::size_t n) {
+    const std::size_t buckets = bucketMask + 1;
+    for (std::size_t i = 0; i < n; i++) {
+        bucketStart[bucketOf[i] + 1]++;
+    }
+    for (std::size_t b = 0; b < buckets; b++) {
+        bucketStart[b + 1] += bucketStart[b];
+    }
+
+    // Scatter using bucketStart[b] as the insertion cursor, then shift back.
+    for (std::size_t i = 0; i < n; i++) {
+        std::uint32_t slot = bucketStart[bucketOf[i]]++;
+        order[slot] = static_cast<std::uint32_t>(i);
+        cellX[slot] = rawCellX[i];
+        cellY[slot] = rawCellY[i];
+    }
+    for (std::size_t b = buckets; b > 0; b--) {
+        bucketStart[b] = bucketStart[b - 1];
+    }
+    bucketStart[0] = 0;
+}
@@ -0,0 +1,142 @@
+#ifndef SPATIALGRID_H
+#define SPATIALGRID_H
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+class ThreadPool;
+
+/**
+ * @brief Uniform-grid broad phase for vehicle collision checks.
+ *
+ * Vehicles are binned into square cells of a fixed size and bucketed by a hash
+ * of their cell coordinates with a counting sort, so building the grid is O(n)
+ * and needs no per-cell allocation. Any two vehicles closer than the cell size
+ * lie in the same or in adjacent cells, so only those pairs are reported as
+ * candidates for the narrow phase.
+ *
+ * The grid is rebuilt every step; its buffers are reused between builds so a
+ * steady-state simulation does not allocate.
+ */
+class SpatialGrid {
+private:
+    double cellSize = 0.0;              /**< Edge length of a grid cell in meters. */
+    std::size_t bucketMask = 0;         /**< Number of hash buckets minus one (bucket count is a power of two). */
+    std::vector<std::uint32_t> bucketStart; /**< Offset of each bucket's first entry in the sorted arrays (size buckets + 1). */
+    std::vector<std::uint32_t> order;   /**< Vehicle indices sorted by bucket. */
+    std::vector<std::int64_t> cellX;    /**< Cell X coordinate of each sorted entry. */
+    std::vector<std::int64_t> cellY;    /**< Cell Y coordinate of each sorted entry. */
+    std::vector<std::uint32_t> bucketOf; /**< Scratch: bucket of each vehicle, in input order. */
+    std::vector<std::int64_t> rawCellX; /**< Scratch: cell X coordinate of each vehicle, in input order. */
+    std::vector<std::int64_t> rawCellY; /**< Scratch: cell Y coordinate of each vehicle, in input order. */
+
+    /**
+     * @brief Maps a cell coordinate pair to its hash bucket.
+     */
+    std::size_t bucket(std::int64_t cx, std::int64_t cy) const {
+        std::uint64_t h = static_cast<std::uint64_t>(cx) * 0x9E3779B97F4A7C15ull
+                        ^ static_cast<std::uint64_t>(cy) * 0xC2B2AE3D27D4EB4Full;
+        return static_cast<std::size_t>(h ^ (h >> 29)) & bucketMask;
+    }
+
+    void prepare(std::size_t n);
+    void sortIntoBuckets(std::size_t n);
+
+public:
+    /**
+     * @brief Bins n vehicle positions into cells of the given size.
+     *
+     * @param xs X-coordinates of the vehicles.
+     * @param ys Y-coordinates of the vehicles.
+     * @param n Number of vehicles.
+     * @param size Cell edge length in meters; must be positive and finite.
+     * @param pool Optional thread pool used to compute the cell coordinates in parallel.
+     * @param chunks Number of chunks to split the work into when a pool is given.
+     */
+    void build(const double* xs, const double* ys, std::size_t n, double size,
+               ThreadPool* pool = nullptr, std::size_t chunks = 1);
+
+    /**
+     * @brief Bins n fixed-point positions, given as tile plus offset, into cells of the given size.
+     *
+     * A position is tile * 2^tileBits + offset units. Cell coordinates are
+     * computed with integer division only, so the binning is the same on
+     * every platform.
+     *
+     * @param tileX Tile X coordinates.
+     * @param tileY Tile Y coordinates.
+     * @param offX X offsets within the tiles, in units.
+     * @param offY Y offsets within the tiles, in units.
+     * @param tileBits log2 of the tile edge length in units.
+     * @param n Number of vehicles.
+     * @param units Cell edge length in units; must be positive.
+     * @param pool Optional thread pool used to compute the cell coordinates in parallel.
+     * @param chunks Number of chunks to split the work into when a pool is given.
+     */
+    void build(const std::int32_t* tileX, const std::int32_t* tileY, const std::int32_t* offX,
+               const std::int32_t* offY, int tileBits, std::size_t n, std::int64_t units,
+               ThreadPool* pool = nullptr, std::size_t chunks = 1);
+
+    /**
+     * @brief Returns the number of binned vehicles (entries in bucket order).
+     */
+    std::size_t size() const { return order.size(); }
+
+    /**
+     * @brief Returns the cell size used by the last build() from doubles.
+     */
+    double getCellSize() const { return cellSize; }
+
+    /**
+     * @brief Invokes f(i, j) for every pair of vehicles in the same or adjacent cells.
+     *
+     * Each candidate pair is reported exactly once. Iteration stops early when
+     * f returns true.
+     *
+     * @param f Callable taking two vehicle indices and returning bool.
+     * @return true if iteration was stopped by f, false otherwise.
+     */
+    template <typename F>
+    bool forEachCandidatePair(F&& f) const {
+        return forEachCandidatePair(0, order.size(), f);
+    }
+
+    /**
+     * @brief Invokes f(i, j) for the candidate pairs whose first entry lies in [begin, end).
+     *
+     * Entries are numbered in bucket order (0 to size()). Splitting [0, size())
+     * into disjoint ranges partitions the candidate pairs, so ranges can be
+     * processed on different threads.
+     *
+     * @param begin First entry of the range.
+     * @param end One past the last entry of the range.
+     * @param f Callable taking two vehicle indices and returning bool.
+     * @return true if iteration was stopped by f, false otherwise.
+     */
+    template <typename F>
+    bool forEachCandidatePair(std::size_t begin, std::size_t end, F&& f) const {
+        // Half neighbourhood: the own cell plus four neighbours, so each pair of
+        // adjacent cells is visited from one side only.
+        static const int offsets[4][2] = { {1, -1}, {1, 0}, {1, 1}, {0, 1} };
+        for (std::size_t p = begin; p < end; p++) {
+            const std::int64_t cx = cellX[p];
+            const std::int64_t cy = cellY[p];
+            const std::size_t own = bucket(cx, cy);
+            for (std::size_t q = p + 1; q < bucketStart[own + 1]; q++) {
+                if (cellX[q] == cx && cellY[q] == cy && f(order[p], order[q])) return true;
+            }
+            for (const auto& d : offsets) {
+                const std::int64_t nx = cx + d[0];
+                const std::int64_t ny = cy + d[1];
+                const std::size_t b = bucket(nx, ny);
+                for (std::size_t q = bucketStart[b]; q < bucketStart[b + 1]; q++) {
+                    if (cellX[q] == nx && cellY[q] == ny && f(order[p], order[q])) return true;
+                }
+            }
+        }
+        return false;
+    }
+};
+
+#endif // SPATIALGRID_H
@@ -0,0 +1,127 @@
+#include "Telemetry.h"
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+
+#if VEHICLESIM_COUNT_ALLOCATIONS
+
+namespace {
+thread_local std::uint64_t allocationCount = 0;
+thread_local std::uint64_t allocationBytes = 0;
+
+void* countedAlloc(std::size_t size) {
+    allocationCount++;
+    allocationBytes += size;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+} // namespace
+
+// Counting replacements of the global allocation functions. The library's
+// nothrow forms call these; over-aligned allocations are not counted.
+void* operator new(std::size_t size) { return countedAlloc(size); }
+void* operator new[](std::size_t size) { return countedAlloc(size); }
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+std::uint64_t RunTelemetry::threadAllocations() { return allocationCount; }
+std::uint64_t RunTelemetry::threadAllocatedBytes() { return allocationBytes; }
+
+#else
+
+std::uint64_t RunTelemetry::threadAllocations() { return 0; }
+std::uint64_t RunTelemetry::threadAllocatedBytes() { return 0; }
+
+#endif
+
+/**
+ * @brief Returns the lower-case name of a phase, as used in exports.
+ */
+const char* RunTelemetry::phaseName(TelemetryPhase p) {
+    switch (p) {
+    case TelemetryPhase::Integrate: return "integrate";
+    case TelemetryPhase::Collision: return "collision";
+    case TelemetryPhase::Log: return "log";
+    case TelemetryPhase::Output: return "output";
+    case TelemetryPhase::Sleep: return "sleep";
+    default: return "unknown";
+    }
+}
+
+/**
+ * @brief Serializes the aggregated figures as a JSON object.
+ */
+std::string RunTelemetry::toJson() const {
+    std::ostringstream out;
+    out << "{\"enabled\": " << (enabled() ? "true" : "false") << ", \"phases\": {";
+    for (std::size_t p = 0; p < static_cast<std::size_t>(TelemetryPhase::Count); p++) {
+        const PhaseStats& s = phases[p];
+        out << (p ? ", " : "") << "\"" << phaseName(static_cast<TelemetryPhase>(p)) << "\": {"
+            << "\"seconds\": " << s.seconds << ", \"calls\": " << s.calls
+            << ", \"allocations\": " << s.allocations << ", \"allocatedBytes\": " << s.allocatedBytes << "}";
+    }
+    out << "}, \"pairsTested\": " << pairsTested << ", \"logBytes\": " << logBytes
+        << ", \"traceEvents\": " << trace.size() << ", \"droppedEvents\": " << droppedEvents << "}";
+    return out.str();
+}
+
+/**
+ * @brief Writes the trace in Chrome trace-event format (chrome://tracing, Perfetto).
+ *
+ * Each phase occurrence becomes a complete ("X") event; the aggregated
+ * figures are attached as metadata.
+ *
+ * @param path Path of the JSON file to create.
+ * @param runId Run ID, used as the trace's thread ID.
+ * @param error Receives a description of the failure, if any.
+ * @return true on success, false otherwise.
+ */
+bool RunTelemetry::writeChromeTrace(const std::string& path, int runId, std::string& error) const {
+    std::ofstream out(path);
+    if (!out) {
+        error = "cannot create " + path;
+        return false;
+    }
+    out << "{\"traceEvents\": [\n";
+    out << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << runId
+        << ", \"args\": {\"name\": \"Run " << runId << "\"}}";
+    for (const TraceEvent& e : trace) {
+        out << ",\n{\"name\": \"" << phaseName(e.phase) << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << runId
+            << ", \"ts\": " << e.start << ", \"dur\": " << e.duration << "}";
+    }
+    out << "\n], \"displayTimeUnit\": \"ms\", \"otherData\": " << toJson() << "}\n";
+    if (!out) {
+        error = "write failed for " + path;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Starts timing a phase occurrence.
+ */
+ScopedPhase::ScopedPhase(RunTelemetry& t, TelemetryPhase p)
+    : telemetry(t), phase(p), start(std::chrono::steady_clock::now()),
+      allocations(RunTelemetry::threadAllocations()), bytes(RunTelemetry::threadAllocatedBytes()) {}
+
+/**
+ * @brief Adds the occurrence to the phase figures and, while there is room, to the trace.
+ */
+ScopedPhase::~ScopedPhase() {
+    const auto end = std::chrono::steady_clock::now();
+    PhaseStats& s = telemetry.phases[static_cast<std::size_t>(phase)];
+    const double seconds = std::chrono::duration<double>(end - start).count();
+    s.seconds += seconds;
+    s.calls++;
+    s.allocations += RunTelemetry::threadAllocations() - allocations;
+    s.allocatedBytes += RunTelemetry::threadAllocatedBytes() - bytes;
+    if (telemetry.trace.size() < RunTelemetry::TRACE_LIMIT) {
+        const double startUs = std::chrono::duration<double, std::micro>(start - telemetry.origin).count();
+        telemetry.trace.push_back(TraceEvent{phase, startUs, seconds * 1e6});
+    } else {
+        telemetry.droppedEvents++;
+    }
+}
@@ -0,0 +1,166 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Compile-time switch for run telemetry. Set by the VEHICLESIM_TELEMETRY
+ * CMake option; when 0, the VS_TELEMETRY_* macros expand to nothing, so the
+ * hot paths carry no timers or counters.
+ */
+#ifndef VEHICLESIM_TELEMETRY
+#define VEHICLESIM_TELEMETRY 0
+#endif
+
+/**
+ * Compile-time switch for allocation counting. Set by the
+ * VEHICLESIM_COUNT_ALLOCATIONS CMake option; when 1, Telemetry.cpp replaces
+ * the global operator new and delete of the whole program with counting
+ * versions. Off by default, since a library should not take over the
+ * allocator of the programs linking it.
+ */
+#ifndef VEHICLESIM_COUNT_ALLOCATIONS
+#define VEHICLESIM_COUNT_ALLOCATIONS 0
+#endif
+
+/**
+ * @brief The phases of a simulation step that telemetry times separately.
+ */
+enum class TelemetryPhase {
+    Integrate, /**< Advancing vehicle positions. */
+    Collision, /**< Broad- and narrow-phase collision check. */
+    Log,       /**< Recording the step into the run log. */
+    Output,    /**< Console printing of positions and alerts. */
+    Sleep,     /**< Real-time pacing. */
+    Count      /**< Number of phases. */
+};
+
+/**
+ * @brief Aggregated figures of one phase over a run.
+ */
+struct PhaseStats {
+    double seconds = 0.0;          /**< Wall time spent in the phase. */
+    long long calls = 0;           /**< Number of times the phase ran. */
+    std::uint64_t allocations = 0; /**< Heap allocations made by the simulation thread inside the phase. */
+    std::uint64_t allocatedBytes = 0; /**< Bytes of those allocations. */
+};
+
+/**
+ * @brief One timed phase occurrence, as exported to a Chrome trace.
+ */
+struct TraceEvent {
+    TelemetryPhase phase; /**< The phase that ran. */
+    double start;         /**< Start time in microseconds since the start of the run. */
+    double duration;      /**< Duration in microseconds. */
+};
+
+/**
+ * @brief Per-run telemetry: phase timers, counters and a bounded trace.
+ *
+ * Attached to every RunRecord. It stays all zero when telemetry is compiled
+ * out. Allocation figures come from a counting global operator new that is
+ * only compiled in with VEHICLESIM_COUNT_ALLOCATIONS, and are zero
+ * otherwise; they cover the thread that runs the simulation loop, not pool
+ * workers.
+ */
+struct RunTelemetry {
+    /** Trace events kept per run; later phase occurrences are only aggregated. */
+    static const std::size_t TRACE_LIMIT = 65536;
+
+    PhaseStats phases[static_cast<std::size_t>(TelemetryPhase::Count)]; /**< Figures per phase. */
+    std::uint64_t pairsTested = 0;    /**< Candidate pairs given to the narrow phase. */
+    std::uint64_t logBytes = 0;       /**< Encoded bytes appended to the run log. */
+    std::vector<TraceEvent> trace;    /**< First TRACE_LIMIT phase occurrences, in order. */
+    std::uint64_t droppedEvents = 0;  /**< Phase occurrences beyond TRACE_LIMIT. */
+    std::chrono::steady_clock::time_point origin; /**< Start of the run; trace times are relative to it. */
+
+    /**
+     * @brief Returns the figures of one phase.
+     */
+    const PhaseStats& phase(TelemetryPhase p) const { return phases[static_cast<std::size_t>(p)]; }
+
+    /**
+     * @brief Returns the lower-case name of a phase, as used in exports.
+     */
+    static const char* phaseName(TelemetryPhase p);
+
+    /**
+     * @brief Returns true if telemetry was compiled in.
+     */
+    static bool enabled() { return VEHICLESIM_TELEMETRY != 0; }
+
+    /**
+     * @brief Returns true if the counting operator new was compiled in.
+     */
+    static bool countsAllocations() { return VEHICLESIM_COUNT_ALLOCATIONS != 0; }
+
+    /**
+     * @brief Returns the number of heap allocations made so far by the calling thread.
+     *
+     * Always 0 when allocation counting is compiled out.
+     */
+    static std::uint64_t threadAllocations();
+
+    /**
+     * @brief Returns the number of bytes allocated so far by the calling thread.
+     *
+     * Always 0 when allocation counting is compiled out.
+     */
+    static std::uint64_t threadAllocatedBytes();
+
+    /**
+     * @brief Serializes the aggregated figures as a JSON object.
+     */
+    std::string toJson() const;
+
+    /**
+     * @brief Writes the trace in Chrome trace-event format (chrome://tracing, Perfetto).
+     *
+     * @param path Path of the JSON file to create.
+     * @param runId Run ID, used as the trace's thread ID.
+     * @param error Receives a description of the failure, if any.
+     * @return true on success, false otherwise.
+     */
+    bool writeChromeTrace(const std::string& path, int runId, std::string& error) const;
+};
+
+/**
+ * @brief Times one phase occurrence from construction to destruction.
+ */
+class ScopedPhase {
+private:
+    RunTelemetry& telemetry;      /**< Telemetry receiving the measurement. */
+    TelemetryPhase phase;         /**< The phase being timed. */
+    std::chrono::steady_clock::time_point start; /**< Construction time. */
+    std::uint64_t allocations;    /**< Thread allocation count at construction. */
+    std::uint64_t bytes;          /**< Thread allocated bytes at construction. */
+
+public:
+    ScopedPhase(RunTelemetry& t, TelemetryPhase p);
+    ~ScopedPhase();
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+};
+
+#define VS_TELEMETRY_CONCAT2(a, b) a##b
+#define VS_TELEMETRY_CONCAT(a, b) VS_TELEMETRY_CONCAT2(a, b)
+
+#if VEHICLESIM_TELEMETRY
+/** Times the rest of the enclosing scope as one occurrence of a phase. */
+#define VS_TELEMETRY_SCOPE(telemetry, phase) \
+    ScopedPhase VS_TELEMETRY_CONCAT(vsTelemetryScope, __LINE__)((telemetry), (phase))
+/** Adds n to a RunTelemetry counter. */
+#define VS_TELEMETRY_ADD(telemetry, counter, n) ((telemetry).counter += (n))
+/** Expands its arguments only when telemetry is compiled in. */
+#define VS_TELEMETRY_ONLY(...) __VA_ARGS__
+#else
+#define VS_TELEMETRY_SCOPE(telemetry, phase) ((void)0)
+#define VS_TELEMETRY_ADD(telemetry, counter, n) ((void)0)
+#define VS_TELEMETRY_ONLY(...)
+#endif
+
+#endif // TELEMETRY_H
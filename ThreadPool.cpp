@@ -0,0 +1,170 @@
+#include "ThreadPool.h"
+
+namespace {
+
+/** Index of the pool worker running on this thread, or -1 outside any pool. */
+thread_local long currentWorker = -1;
+
+/** The pool that owns the current worker thread. */
+thread_local const void* currentPool = nullptr;
+
+} // namespace
+
+/**
+ * @brief Starts the worker threads.
+ *
+ * @param threadCount Number of workers; 0 uses std::thread::hardware_concurrency().
+ */
+ThreadPool::ThreadPool(std::size_t threadCount)
+    : pending(0), nextQueue(0), stopping(false) {
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+        if (threadCount == 0) threadCount = 1;
+    }
+    for (std::size_t i = 0; i < threadCount; i++) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (std::size_t i = 0; i < threadCount; i++) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+/**
+ * @brief Waits for the queued tasks to finish and joins the workers.
+ */
+ThreadPool::~ThreadPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+    for (auto& t : threads) {
+        t.join();
+    }
+}
+
+/**
+ * @brief Queues a task for execution on the pool.
+ *
+ * Tasks submitted by one of this pool's workers are pushed onto that worker's
+ * own deque (keeping related work on the same core); other submissions are
+ * distributed round-robin.
+ *
+ * @param task The task to run.
+ */
+void ThreadPool::submit(std::function<void()> task) {
+    std::size_t target;
+    if (currentPool == this && currentWorker >= 0) {
+        target = static_cast<std::size_t>(currentWorker);
+    } else {
+        target = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+    }
+    pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    {
+        // Taking the sleep mutex orders this wake-up after a worker's final
+        // empty-queue check, so the notification cannot be lost.
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    workAvailable.notify_one();
+}
+
+/**
+ * @brief Runs one task, preferring the back of the own deque and stealing otherwise.
+ *
+ * @param self Index of the calling worker, or queues.size() for a non-worker thread.
+ * @return true if a task was run.
+ */
+bool ThreadPool::tryRun(std::size_t self) {
+    std::function<void()> task;
+    const std::size_t n = queues.size();
+    if (self < n) {
+        std::lock_guard<std::mutex> lock(queues[self]->mutex);
+        if (!queues[self]->tasks.empty()) {
+            task = std::move(queues[self]->tasks.back());
+            queues[self]->tasks.pop_back();
+        }
+    }
+    for (std::size_t k = 1; !task && k <= n; k++) {
+        Queue& victim = *queues[(self + k) % n];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+        }
+    }
+    if (!task) return false;
+
+    task();
+    if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        allDone.notify_all();
+    }
+    return true;
+}
+
+/**
+ * @brief Main loop of a worker: run or steal tasks, sleep when there are none.
+ *
+ * @param self Index of this worker.
+ */
+void ThreadPool::workerLoop(std::size_t self) {
+    currentWorker = static_cast<long>(self);
+    currentPool = this;
+    while (true) {
+        if (tryRun(self)) continue;
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        if (stopping) return;
+        // Re-check under the lock: submit() takes it before notifying.
+        bool empty = true;
+        for (const auto& q : queues) {
+            std::lock_guard<std::mutex> qlock(q->mutex);
+            if (!q->tasks.empty()) {
+                empty = false;
+                break;
+            }
+        }
+        if (empty) workAvailable.wait(lock);
+    }
+}
+
+/**
+ * @brief Blocks until every submitted task has completed.
+ *
+ * The calling thread runs queued tasks itself while it waits. Must not
+ * be called from a task running on this pool.
+ */
+void ThreadPool::wait() {
+    const std::size_t self = queues.size();
+    while (pending.load(std::memory_order_acquire) > 0) {
+        if (tryRun(self)) continue;
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        allDone.wait(lock, [this] {
+            return pending.load(std::memory_order_acquire) == 0;
+        });
+    }
+}
+
+/**
+ * @brief Splits [0, count) into chunks, runs fn on each chunk in parallel and waits.
+ *
+ * @param count Number of items.
+ * @param chunks Number of chunks to split the items into (clamped to [1, count]).
+ * @param fn Callable invoked as fn(chunk, begin, end).
+ */
+void ThreadPool::parallelFor(std::size_t count, std::size_t chunks,
+                             const std::function<void(std::size_t, std::size_t, std::size_t)>& fn) {
+    if (count == 0) return;
+    if (chunks == 0) chunks = 1;
+    if (chunks > count) chunks = count;
+    for (std::size_t c = 0; c < chunks; c++) {
+        std::size_t begin = count * c / chunks;
+        std::size_t end = count * (c + 1) / chunks;
+        submit([&fn, c, begin, end] { fn(c, begin, end); });
+    }
+    wait();
+}
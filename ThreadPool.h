@@ -0,0 +1,95 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed-size work-stealing thread pool.
+ *
+ * Every worker owns a task deque. A worker takes tasks from the back of its
+ * own deque and, when that is empty, steals from the front of the other
+ * workers' deques, so uneven task costs are balanced without a central queue.
+ * Tasks submitted from outside the pool are spread round-robin across the
+ * worker deques; tasks submitted from a worker go to its own deque.
+ */
+class ThreadPool {
+private:
+    /**
+     * @brief A worker's task deque and the mutex guarding it.
+     */
+    struct Queue {
+        std::mutex mutex;                          /**< Guards tasks. */
+        std::deque<std::function<void()>> tasks;   /**< Pending tasks; owner uses the back, thieves the front. */
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues; /**< One deque per worker. */
+    std::vector<std::thread> threads;           /**< The worker threads. */
+    std::mutex sleepMutex;                      /**< Guards sleeping and waking of workers and waiters. */
+    std::condition_variable workAvailable;      /**< Signalled when tasks are submitted or the pool stops. */
+    std::condition_variable allDone;            /**< Signalled when the last pending task completes. */
+    std::atomic<std::size_t> pending;           /**< Tasks submitted but not yet completed. */
+    std::atomic<std::size_t> nextQueue;         /**< Round-robin cursor for external submissions. */
+    bool stopping;                              /**< Set (under sleepMutex) when the pool shuts down. */
+
+    bool tryRun(std::size_t self);
+    void workerLoop(std::size_t self);
+
+public:
+    /**
+     * @brief Starts the worker threads.
+     *
+     * @param threadCount Number of workers; 0 uses std::thread::hardware_concurrency().
+     */
+    explicit ThreadPool(std::size_t threadCount = 0);
+
+    /**
+     * @brief Waits for the queued tasks to finish and joins the workers.
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Returns the number of worker threads.
+     */
+    std::size_t size() const { return threads.size(); }
+
+    /**
+     * @brief Queues a task for execution on the pool.
+     *
+     * @param task The task to run.
+     */
+    void submit(std::function<void()> task);
+
+    /**
+     * @brief Blocks until every submitted task has completed.
+     *
+     * The calling thread runs queued tasks itself while it waits. Must not
+     * be called from a task running on this pool.
+     */
+    void wait();
+
+    /**
+     * @brief Splits [0, count) into chunks, runs fn on each chunk in parallel and waits.
+     *
+     * Chunk boundaries depend only on count and chunks, never on scheduling, so
+     * callers can reduce per-chunk results in chunk order deterministically.
+     *
+     * @param count Number of items.
+     * @param chunks Number of chunks to split the items into (clamped to [1, count]).
+     * @param fn Callable invoked as fn(chunk, begin, end).
+     */
+    void parallelFor(std::size_t count, std::size_t chunks,
+                     const std::function<void(std::size_t, std::size_t, std::size_t)>& fn);
+};
+
+#endif // THREADPOOL_H
@@ -0,0 +1,133 @@
+#ifndef TILEDPOSITIONS_H
+#define TILEDPOSITIONS_H
+
+#include "VehicleStore.h"
+#include "ClosestApproach.h"
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Fixed-point vehicle positions split into an integer tile and a 32-bit offset within it.
+ *
+ * A coordinate is held as tile * 2^TILE_BITS + offset in units of
+ * 2^-UNIT_BITS meters (about 1 micrometer), so tiles are 1024 m wide and
+ * positions keep the same resolution anywhere on a map up to 2^41 m across.
+ * Every step moves each vehicle by a whole number of units, its velocity
+ * times dt rounded once when the positions are loaded. The per-step kernel
+ * adds those steps to the offsets with 32-bit integer SIMD and only touches
+ * a tile when a vehicle leaves it, so it streams 8 bytes per coordinate
+ * instead of the 16 of a double position and velocity.
+ *
+ * Integer addition is exact, so positions do not depend on the instruction
+ * set, the chunking across threads or how far the fleet is from the
+ * origin. The narrow phase works on exact integer differences, which makes
+ * collision decisions bit-reproducible as well.
+ */
+class TiledPositions {
+public:
+    static constexpr int UNIT_BITS = 20; /**< log2 of the units per meter. */
+    static constexpr int TILE_BITS = 30; /**< log2 of the tile edge length in units. */
+
+private:
+    std::vector<std::int32_t> tileXs; /**< Tile X coordinates; touched only when a vehicle changes tile. */
+    std::vector<std::int32_t> tileYs; /**< Tile Y coordinates. */
+    std::vector<std::int32_t> offXs;  /**< X offsets within the tiles, in [0, 2^TILE_BITS) units. */
+    std::vector<std::int32_t> offYs;  /**< Y offsets within the tiles. */
+    std::vector<std::int32_t> stepXs; /**< X displacement per step, in units. */
+    std::vector<std::int32_t> stepYs; /**< Y displacement per step, in units. */
+    std::int64_t maxStepUnits = 0;    /**< Upper bound on the distance any vehicle moves in one step, in units. */
+
+    void rebase(std::size_t i);
+
+public:
+    /**
+     * @brief Converts the positions and velocities of a store for steps of dt seconds.
+     *
+     * @param vehs The vehicles to convert.
+     * @param dt Length of a step in seconds; must be positive.
+     * @return true on success; false, leaving the positions empty, if a
+     *         coordinate is not finite or off the map, or a vehicle moves
+     *         2^(TILE_BITS - 1) units or more in a step.
+     */
+    bool load(const VehicleStore& vehs, double dt);
+
+    /**
+     * @brief Forgets all positions.
+     */
+    void clear();
+
+    /**
+     * @brief Advances every vehicle by one step.
+     */
+    void integrate() { integrate(0, size()); }
+
+    /**
+     * @brief Advances the vehicles with indices in [begin, end) by one step.
+     *
+     * Disjoint ranges may be advanced on different threads.
+     *
+     * @param begin Index of the first vehicle to advance.
+     * @param end One past the index of the last vehicle to advance.
+     */
+    void integrate(std::size_t begin, std::size_t end);
+
+    /**
+     * @brief Writes the positions back to the store's x and y columns, in meters.
+     *
+     * @param vehs The store the positions were loaded from.
+     */
+    void store(VehicleStore& vehs) const;
+
+    /**
+     * @brief Returns the closest approach of vehicles i and j during the step that just ended.
+     *
+     * Both vehicles are moved back along their per-step displacements, as in
+     * closestApproach(). Separations are exact integer differences, so the
+     * result only depends on the two vehicles' relative positions.
+     *
+     * @param i Index of the first vehicle.
+     * @param j Index of the second vehicle.
+     * @param dt Length of the step in seconds, to express tau in seconds.
+     * @return Approach Offset in seconds and squared distances in square meters.
+     */
+    Approach approach(std::size_t i, std::size_t j, double dt) const;
+
+    /**
+     * @brief Returns true if vehicles i and j came within minDist meters of each other during the step.
+     */
+    bool inDanger(std::size_t i, std::size_t j, double minDist) const {
+        return minDist >= 0 && approach(i, j, 1.0).minSq <= minDist * minDist;
+    }
+
+    /**
+     * @brief Returns the absolute X coordinate of vehicle i in units.
+     */
+    std::int64_t absX(std::size_t i) const {
+        return static_cast<std::int64_t>(tileXs[i]) * (std::int64_t(1) << TILE_BITS) + offXs[i];
+    }
+
+    /**
+     * @brief Returns the absolute Y coordinate of vehicle i in units.
+     */
+    std::int64_t absY(std::size_t i) const {
+        return static_cast<std::int64_t>(tileYs[i]) * (std::int64_t(1) << TILE_BITS) + offYs[i];
+    }
+
+    /**
+     * @brief Returns the number of vehicles.
+     */
+    std::size_t size() const { return offXs.size(); }
+
+    /**
+     * @brief Returns an upper bound on the distance any vehicle moves in one step, in units.
+     */
+    std::int64_t maxStep() const { return maxStepUnits; }
+
+    const std::vector<std::int32_t>& tileX() const { return tileXs; }   /**< @brief Tile X column. */
+    const std::vector<std::int32_t>& tileY() const { return tileYs; }   /**< @brief Tile Y column. */
+    const std::vector<std::int32_t>& offsetX() const { return offXs; }  /**< @brief X offset column. */
+    const std::vector<std::int32_t>& offsetY() const { return offYs; }  /**< @brief Y offset column. */
+};
+
+#endif // TILEDPOSITIONS_H
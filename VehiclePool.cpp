@@ -0,0 +1,102 @@
+#include "VehiclePool.h"
+#include <algorithm>
+
+/**
+ * @brief Issues a handle for a vehicle appended at the end of the store.
+ *
+ * Reuses the most recently freed slot, if any.
+ *
+ * @param id The vehicle's ID.
+ * @return VehicleHandle The new vehicle's handle.
+ */
+VehicleHandle VehiclePool::add(int id) {
+    Tables& t = writable();
+    std::vector<Slot>& slots = t.slots;
+    std::vector<std::uint32_t>& slotOf = t.slotOf;
+    std::uint32_t& freeHead = t.freeHead;
+    const std::uint32_t index = static_cast<std::uint32_t>(slotOf.size());
+    std::uint32_t slot = freeHead;
+    if (slot != VehicleHandle::NONE) {
+        freeHead = slots[slot].index;
+        slots[slot].index = index;
+        slots[slot].id = id;
+    } else {
+        slot = static_cast<std::uint32_t>(slots.size());
+        slots.push_back(Slot{index, 0, id});
+    }
+    slotOf.push_back(slot);
+    t.byId[id] = slot;
+    return VehicleHandle{slot, slots[slot].generation};
+}
+
+/**
+ * @brief Makes room for n vehicles in total, so bulk loads grow the table and the ID map only once.
+ *
+ * Free slots are reused before new ones are made, so the table needs n
+ * slots at most.
+ *
+ * @param n Number of vehicles the pool should hold without reallocating or rehashing.
+ */
+void VehiclePool::reserve(std::size_t n) {
+    Tables& t = writable();
+    t.slots.reserve(std::max(t.slots.size(), n));
+    t.slotOf.reserve(n);
+    t.byId.reserve(n);
+}
+
+/**
+ * @brief Frees the handle of the vehicle at a store index, which the caller removes by swap-and-pop.
+ *
+ * @param index Store index of the removed vehicle.
+ */
+void VehiclePool::remove(std::size_t index) {
+    Tables& t = writable();
+    std::vector<Slot>& slots = t.slots;
+    std::vector<std::uint32_t>& slotOf = t.slotOf;
+    std::unordered_map<int, std::uint32_t>& byId = t.byId;
+    std::uint32_t& freeHead = t.freeHead;
+    const std::uint32_t slot = slotOf[index];
+    Slot& s = slots[slot];
+    auto named = byId.find(s.id);
+    if (named != byId.end() && named->second == slot) byId.erase(named);
+    s.generation++;
+    s.index = freeHead;
+    freeHead = slot;
+
+    const std::uint32_t moved = slotOf.back();
+    slotOf.pop_back();
+    if (index < slotOf.size()) {
+        slotOf[index] = moved;
+        slots[moved].index = static_cast<std::uint32_t>(index);
+    }
+}
+
+/**
+ * @brief Removes all vehicles; outstanding handles become stale.
+ *
+ * Generations are kept, so handles issued before stay stale after their
+ * slots are reused.
+ */
+void VehiclePool::clear() {
+    Tables& t = writable();
+    std::vector<Slot>& slots = t.slots;
+    std::vector<std::uint32_t>& slotOf = t.slotOf;
+    std::uint32_t& freeHead = t.freeHead;
+    for (std::uint32_t index = 0; index < slotOf.size(); index++) {
+        const std::uint32_t slot = slotOf[index];
+        slots[slot].generation++;
+        slots[slot].index = freeHead;
+        freeHead = slot;
+    }
+    slotOf.clear();
+    t.byId.clear();
+}
+
+/**
+ * @brief Returns the handle of a vehicle by ID, or the null handle if none has it.
+ */
+VehicleHandle VehiclePool::find(int id) const {
+    auto it = tables->byId.find(id);
+    if (it == tables->byId.end()) return VehicleHandle();
+    return VehicleHandle{it->second, tables->slots[it->second].generation};
+}
@@ -0,0 +1,149 @@
+#ifndef VEHICLEPOOL_H
+#define VEHICLEPOOL_H
+
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Stable reference to a vehicle of a simulation.
+ *
+ * Store indices change when vehicles are removed; a handle does not. A
+ * handle outlives its vehicle: once the vehicle is removed, the handle's
+ * generation no longer matches its slot and lookups fail, even after the
+ * slot was reused for another vehicle.
+ */
+struct VehicleHandle {
+    static constexpr std::uint32_t NONE = 0xFFFFFFFFu; /**< Slot of a handle that refers to no vehicle. */
+
+    std::uint32_t slot = NONE;     /**< Slot in the handle table. */
+    std::uint32_t generation = 0;  /**< Generation of the slot when the handle was issued. */
+
+    /**
+     * @brief Returns true unless the handle is the null handle; says nothing about whether the vehicle still exists.
+     */
+    bool valid() const { return slot != NONE; }
+
+    bool operator==(const VehicleHandle& o) const { return slot == o.slot && generation == o.generation; } /**< @brief Same slot and generation. */
+    bool operator!=(const VehicleHandle& o) const { return !(*this == o); } /**< @brief Different slot or generation. */
+};
+
+/**
+ * @brief Generational handle table over the dense vehicle arrays of a store.
+ *
+ * Every vehicle owns a slot that records its store index; the store index
+ * records the slot back. Slots of removed vehicles go on a free list and are
+ * reused with their generation incremented. Insertion appends the vehicle
+ * at the end of the store, and removal moves the last vehicle into the
+ * removed one's place (swap-and-pop), so both are O(1) and the store stays
+ * dense. The pool only keeps the mapping: the caller moves the vehicle data.
+ *
+ * An ID-to-slot hash map finds vehicles by Vehicle::id in O(1). If several
+ * vehicles share an ID, the one added last is found, and none once it is
+ * removed.
+ *
+ * The tables are copy-on-write like the columns of a VehicleStore: copying a
+ * pool is O(1), and a copy clones them only when it first adds or removes a
+ * vehicle.
+ */
+class VehiclePool {
+private:
+    /**
+     * @brief One entry of the handle table.
+     */
+    struct Slot {
+        std::uint32_t index;      /**< Store index of the vehicle, or the next free slot while free. */
+        std::uint32_t generation; /**< Incremented each time the slot is freed. */
+        int id;                   /**< ID of the vehicle, to update the ID map on removal. */
+    };
+
+    /**
+     * @brief The mapping, shared between copies of a pool until one of them changes it.
+     */
+    struct Tables {
+        std::vector<Slot> slots;                     /**< The handle table. */
+        std::vector<std::uint32_t> slotOf;           /**< Slot of each store index. */
+        std::uint32_t freeHead = VehicleHandle::NONE; /**< First free slot, or NONE. */
+        std::unordered_map<int, std::uint32_t> byId;  /**< Slot of the last vehicle added with each ID. */
+    };
+
+    std::shared_ptr<Tables> tables = std::make_shared<Tables>(); /**< The mapping, possibly shared. */
+
+    /** @brief Write access; copies the tables first if another pool shares them. */
+    Tables& writable() {
+        if (tables.use_count() > 1) {
+            tables = std::make_shared<Tables>(*tables);
+        } else {
+            // Pairs with the release in another copy's reference drop, so its reads are done
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *tables;
+    }
+
+public:
+    /**
+     * @brief Issues a handle for a vehicle appended at the end of the store.
+     *
+     * @param id The vehicle's ID.
+     * @return VehicleHandle The new vehicle's handle.
+     */
+    VehicleHandle add(int id);
+
+    /**
+     * @brief Makes room for n vehicles in total, so bulk loads grow the table and the ID map only once.
+     *
+     * @param n Number of vehicles the pool should hold without reallocating or rehashing.
+     */
+    void reserve(std::size_t n);
+
+    /**
+     * @brief Frees the handle of the vehicle at a store index, which the caller removes by swap-and-pop.
+     *
+     * Afterwards the vehicle that was last in the store is recorded at index.
+     *
+     * @param index Store index of the removed vehicle.
+     */
+    void remove(std::size_t index);
+
+    /**
+     * @brief Removes all vehicles; outstanding handles become stale.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the store index of a handle's vehicle, or VehicleHandle::NONE if it was removed.
+     */
+    std::uint32_t indexOf(VehicleHandle h) const {
+        if (h.slot >= tables->slots.size()) return VehicleHandle::NONE;
+        const Slot& s = tables->slots[h.slot];
+        return s.generation == h.generation ? s.index : VehicleHandle::NONE;
+    }
+
+    /**
+     * @brief Returns the handle of the vehicle at a store index.
+     */
+    VehicleHandle handleAt(std::size_t index) const {
+        const std::uint32_t slot = tables->slotOf[index];
+        return VehicleHandle{slot, tables->slots[slot].generation};
+    }
+
+    /**
+     * @brief Returns the handle of a vehicle by ID, or the null handle if none has it.
+     */
+    VehicleHandle find(int id) const;
+
+    /**
+     * @brief Returns the number of vehicles.
+     */
+    std::size_t size() const { return tables->slotOf.size(); }
+
+    /**
+     * @brief Returns true if both pools use the same tables.
+     */
+    bool shares(const VehiclePool& other) const { return tables == other.tables; }
+};
+
+#endif // VEHICLEPOOL_H
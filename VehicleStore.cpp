@@ -0,0 +1,328 @@
+#define _USE_MATH_DEFINES
+#include "VehicleStore.h"
+#include <cmath>
+
+#if defined(__AVX__)
+#define VEHICLESTORE_AVX 1
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VEHICLESTORE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+/**
+ * @brief Reserves capacity for at least n vehicles in every column.
+ *
+ * @param n The number of vehicles to reserve space for.
+ */
+void VehicleStore::reserve(std::size_t n) {
+    ids.edit().reserve(n);
+    xs.edit().reserve(n);
+    ys.edit().reserve(n);
+    vxs.edit().reserve(n);
+    vys.edit().reserve(n);
+    lengths.edit().reserve(n);
+    speeds.edit().reserve(n);
+    directions.edit().reserve(n);
+}
+
+/**
+ * @brief Appends a vehicle, caching its velocity components.
+ *
+ * The heading is converted to a unit vector once here, so the per-step
+ * integrator only needs a multiply-add per coordinate.
+ *
+ * @param v The vehicle to add.
+ */
+void VehicleStore::add(const Vehicle& v) {
+    double rad = v.direction * M_PI / 180.0;
+    ids.edit().push_back(v.id);
+    xs.edit().push_back(v.x);
+    ys.edit().push_back(v.y);
+    vxs.edit().push_back(std::cos(rad) * v.speed);
+    vys.edit().push_back(std::sin(rad) * v.speed);
+    lengths.edit().push_back(v.length);
+    speeds.edit().push_back(v.speed);
+    directions.edit().push_back(v.direction);
+    if (v.length > maxLen) maxLen = v.length;
+    if (std::fabs(v.speed) > maxSpd) maxSpd = std::fabs(v.speed);
+}
+
+/**
+ * @brief Appends n vehicles given as columns, growing every column once.
+ *
+ * Columns are copied with a single range insert each. When the velocity
+ * components are supplied (e.g. from a scenario file written by this class)
+ * no trigonometry is needed at all.
+ *
+ * @param n Number of vehicles to append.
+ * @param idCol Vehicle identifiers.
+ * @param xCol X-coordinates.
+ * @param yCol Y-coordinates.
+ * @param speedCol Speeds in m/s.
+ * @param directionCol Directions in degrees.
+ * @param lengthCol Lengths in meters.
+ * @param vxCol Precomputed X velocity components, or null to derive them.
+ * @param vyCol Precomputed Y velocity components, or null to derive them.
+ */
+void VehicleStore::append(std::size_t n, const std::int32_t* idCol, const double* xCol, const double* yCol,
+                          const double* speedCol, const double* directionCol, const double* lengthCol,
+                          const double* vxCol, const double* vyCol) {
+    const std::size_t first = size();
+    std::vector<double>& sp = speeds.edit();
+    std::vector<double>& dir = directions.edit();
+    std::vector<double>& len = lengths.edit();
+    std::vector<double>& vx = vxs.edit();
+    std::vector<double>& vy = vys.edit();
+    std::vector<int>& id = ids.edit();
+    std::vector<double>& x = xs.edit();
+    std::vector<double>& y = ys.edit();
+    id.insert(id.end(), idCol, idCol + n);
+    x.insert(x.end(), xCol, xCol + n);
+    y.insert(y.end(), yCol, yCol + n);
+    sp.insert(sp.end(), speedCol, speedCol + n);
+    dir.insert(dir.end(), directionCol, directionCol + n);
+    len.insert(len.end(), lengthCol, lengthCol + n);
+    if (vxCol && vyCol) {
+        vx.insert(vx.end(), vxCol, vxCol + n);
+        vy.insert(vy.end(), vyCol, vyCol + n);
+    } else {
+        vx.resize(first + n);
+        vy.resize(first + n);
+        for (std::size_t i = first; i < first + n; i++) {
+            double rad = dir[i] * M_PI / 180.0;
+            vx[i] = std::cos(rad) * sp[i];
+            vy[i] = std::sin(rad) * sp[i];
+        }
+    }
+    for (std::size_t i = first; i < first + n; i++) {
+        if (len[i] > maxLen) maxLen = len[i];
+        if (std::fabs(sp[i]) > maxSpd) maxSpd = std::fabs(sp[i]);
+    }
+}
+
+/**
+ * @brief Removes all vehicles.
+ *
+ * Columns shared with a copy of the store are released rather than cleared,
+ * so the copy keeps its vehicles.
+ */
+void VehicleStore::clear() {
+    ids = Column<int>();
+    xs = Column<double>();
+    ys = Column<double>();
+    vxs = Column<double>();
+    vys = Column<double>();
+    lengths = Column<double>();
+    speeds = Column<double>();
+    directions = Column<double>();
+    maxLen = 0.0;
+    maxSpd = 0.0;
+}
+
+namespace {
+
+/**
+ * @brief Moves the last value of a column to index i and drops the last slot.
+ */
+template <typename T>
+void swapPop(std::vector<T>& column, std::size_t i) {
+    column[i] = column.back();
+    column.pop_back();
+}
+
+} // namespace
+
+/**
+ * @brief Removes the vehicle at index i by moving the last vehicle into its place.
+ *
+ * @param i Index of the vehicle to remove.
+ */
+void VehicleStore::swapRemove(std::size_t i) {
+    swapPop(ids.edit(), i);
+    swapPop(xs.edit(), i);
+    swapPop(ys.edit(), i);
+    swapPop(vxs.edit(), i);
+    swapPop(vys.edit(), i);
+    swapPop(lengths.edit(), i);
+    swapPop(speeds.edit(), i);
+    swapPop(directions.edit(), i);
+}
+
+/**
+ * @brief Converts the vehicle at index i back into a Vehicle.
+ *
+ * @param i Index of the vehicle in the store.
+ * @return Vehicle A copy of the vehicle's current state.
+ */
+Vehicle VehicleStore::get(std::size_t i) const {
+    return Vehicle(ids.get()[i], xs.get()[i], ys.get()[i], speeds.get()[i], directions.get()[i], lengths.get()[i]);
+}
+
+/**
+ * @brief Converts all stored vehicles into an array of Vehicle structs.
+ *
+ * @param out The vector to fill; its previous contents are replaced.
+ */
+void VehicleStore::toVehicles(std::vector<Vehicle>& out) const {
+    out.clear();
+    out.reserve(size());
+    for (std::size_t i = 0; i < size(); i++) {
+        out.push_back(get(i));
+    }
+}
+
+/**
+ * @brief Converts all stored vehicles into an array of Vehicle structs.
+ *
+ * @return std::vector<Vehicle> The vehicles in store order.
+ */
+std::vector<Vehicle> VehicleStore::toVehicles() const {
+    std::vector<Vehicle> out;
+    toVehicles(out);
+    return out;
+}
+
+/**
+ * @brief Changes the speed and direction of a vehicle and refreshes its cached velocity.
+ *
+ * @param i Index of the vehicle in the store.
+ * @param speed The new speed in m/s.
+ * @param direction The new direction in degrees.
+ */
+void VehicleStore::setVelocity(std::size_t i, double speed, double direction) {
+    double rad = direction * M_PI / 180.0;
+    speeds.edit()[i] = speed;
+    directions.edit()[i] = direction;
+    vxs.edit()[i] = std::cos(rad) * speed;
+    vys.edit()[i] = std::sin(rad) * speed;
+    if (std::fabs(speed) > maxSpd) maxSpd = std::fabs(speed);
+}
+
+/**
+ * @brief Changes the speed of a vehicle, keeping its direction.
+ *
+ * @param i Index of the vehicle in the store.
+ * @param speed The new speed in m/s.
+ */
+void VehicleStore::setSpeed(std::size_t i, double speed) {
+    if (speeds.get()[i] == 0) {
+        setVelocity(i, speed, directions.get()[i]);
+        return;
+    }
+    const double scale = speed / speeds.get()[i];
+    speeds.edit()[i] = speed;
+    vxs.edit()[i] *= scale;
+    vys.edit()[i] *= scale;
+    if (std::fabs(speed) > maxSpd) maxSpd = std::fabs(speed);
+}
+
+/**
+ * @brief Moves a vehicle to a new position and heading, keeping its speed.
+ *
+ * @param i Index of the vehicle in the store.
+ * @param x The new X-coordinate.
+ * @param y The new Y-coordinate.
+ * @param direction The new direction in degrees.
+ * @param ux X component of the unit vector along direction.
+ * @param uy Y component of the unit vector along direction.
+ */
+void VehicleStore::setPose(std::size_t i, double x, double y, double direction, double ux, double uy) {
+    xs.edit()[i] = x;
+    ys.edit()[i] = y;
+    directions.edit()[i] = direction;
+    vxs.edit()[i] = ux * speeds.get()[i];
+    vys.edit()[i] = uy * speeds.get()[i];
+}
+
+/**
+ * @brief Moves a vehicle to a new position, keeping its velocity.
+ *
+ * @param i Index of the vehicle in the store.
+ * @param x The new X-coordinate.
+ * @param y The new Y-coordinate.
+ */
+void VehicleStore::setPosition(std::size_t i, double x, double y) {
+    xs.edit()[i] = x;
+    ys.edit()[i] = y;
+}
+
+/**
+ * @brief Advances every vehicle along its cached velocity by dt seconds.
+ *
+ * @param dt The time step in seconds.
+ */
+void VehicleStore::integrate(double dt) {
+    unsharePositions();
+    integrate(dt, 0, size());
+}
+
+/**
+ * @brief Advances the vehicles with indices in [begin, end) by dt seconds.
+ *
+ * The loop is split into an AVX body (4 vehicles per iteration), an SSE2 body
+ * (2 vehicles per iteration) and a scalar tail. Multiplication and addition are
+ * issued as separate instructions in every path, so each vehicle's result is
+ * bit-identical whichever path processes it.
+ *
+ * @param dt The time step in seconds.
+ * @param begin Index of the first vehicle to advance.
+ * @param end One past the index of the last vehicle to advance.
+ */
+void VehicleStore::integrate(double dt, std::size_t begin, std::size_t end) {
+    const std::size_t n = end - begin;
+    double* px = xs.edit().data() + begin;
+    double* py = ys.edit().data() + begin;
+    const double* pvx = vxs.get().data() + begin;
+    const double* pvy = vys.get().data() + begin;
+    std::size_t i = 0;
+
+#ifdef VEHICLESTORE_AVX
+    const __m256d dt4 = _mm256_set1_pd(dt);
+    for (; i + 4 <= n; i += 4) {
+        __m256d x4 = _mm256_add_pd(_mm256_loadu_pd(px + i), _mm256_mul_pd(_mm256_loadu_pd(pvx + i), dt4));
+        __m256d y4 = _mm256_add_pd(_mm256_loadu_pd(py + i), _mm256_mul_pd(_mm256_loadu_pd(pvy + i), dt4));
+        _mm256_storeu_pd(px + i, x4);
+        _mm256_storeu_pd(py + i, y4);
+    }
+#endif
+
+#ifdef VEHICLESTORE_SSE2
+    const __m128d dt2 = _mm_set1_pd(dt);
+    for (; i + 2 <= n; i += 2) {
+        __m128d x2 = _mm_add_pd(_mm_loadu_pd(px + i), _mm_mul_pd(_mm_loadu_pd(pvx + i), dt2));
+        __m128d y2 = _mm_add_pd(_mm_loadu_pd(py + i), _mm_mul_pd(_mm_loadu_pd(pvy + i), dt2));
+        _mm_storeu_pd(px + i, x2);
+        _mm_storeu_pd(py + i, y2);
+    }
+#endif
+
+    for (; i < n; i++) {
+        px[i] += pvx[i] * dt;
+        py[i] += pvy[i] * dt;
+    }
+}
+
+/**
+ * @brief Gives the store its own copy of the position columns if a copy of the store shares them.
+ *
+ * integrate(dt, begin, end) writes the positions from several threads; they
+ * must not find the columns shared, or each would copy them.
+ */
+void VehicleStore::unsharePositions() {
+    xs.edit();
+    ys.edit();
+}
+
+/**
+ * @brief Returns how many of the eight columns still share storage with another store.
+ *
+ * @param other A copy of this store, or a store it was copied from.
+ * @return int The number of shared columns, from 0 to 8.
+ */
+int VehicleStore::sharedColumns(const VehicleStore& other) const {
+    return ids.shares(other.ids) + xs.shares(other.xs) + ys.shares(other.ys) +
+           vxs.shares(other.vxs) + vys.shares(other.vys) + lengths.shares(other.lengths) +
+           speeds.shares(other.speeds) + directions.shares(other.directions);
+}
@@ -0,0 +1,256 @@
+#ifndef VEHICLESTORE_H
+#define VEHICLESTORE_H
+
+#include "Vehicle.h"
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Structure-of-arrays storage for the vehicles of a simulation.
+ *
+ * Each vehicle property lives in its own contiguous array so the per-step
+ * kinematics kernel can stream through positions and velocities with SIMD
+ * loads. The velocity components (vx, vy) are derived from speed and direction
+ * once, when a vehicle is added or its velocity changes, instead of calling
+ * cos/sin on every step.
+ *
+ * Vehicle remains the public add/view type: vehicles are converted into the
+ * columns by add() and back again by get() / toVehicles().
+ *
+ * Columns are copy-on-write: copying a store copies no vehicle data, and a
+ * column is duplicated only when one of the copies first writes to it. A
+ * snapshot of a constant-velocity fleet therefore only ever duplicates the
+ * positions; identifiers, lengths and velocities stay shared by every copy.
+ */
+class VehicleStore {
+private:
+    /**
+     * @brief A column shared between copies of a store until one of them writes to it.
+     */
+    template <typename T>
+    class Column {
+    private:
+        std::shared_ptr<std::vector<T>> data = std::make_shared<std::vector<T>>(); /**< The values, possibly shared. */
+
+    public:
+        /** @brief Read access; never copies. */
+        const std::vector<T>& get() const { return *data; }
+
+        /**
+         * @brief Write access; copies the values first if another store shares them.
+         *
+         * use_count() is a relaxed load, so seeing 1 does not order this
+         * thread's writes after the reads of a copy another thread (say, a
+         * poller of a RunControl frame) has just dropped. The acquire fence
+         * pairs with the release in that copy's reference drop.
+         */
+        std::vector<T>& edit() {
+            if (data.use_count() > 1) {
+                data = std::make_shared<std::vector<T>>(*data);
+            } else {
+                std::atomic_thread_fence(std::memory_order_acquire);
+            }
+            return *data;
+        }
+
+        /** @brief Returns true if both columns use the same storage. */
+        bool shares(const Column& other) const { return data == other.data; }
+    };
+
+    Column<int> ids;          /**< Vehicle identifiers. */
+    Column<double> xs;        /**< X-coordinates in meters. */
+    Column<double> ys;        /**< Y-coordinates in meters. */
+    Column<double> vxs;       /**< Cached X velocity components in m/s. */
+    Column<double> vys;       /**< Cached Y velocity components in m/s. */
+    Column<double> lengths;   /**< Vehicle lengths in meters. */
+    Column<double> speeds;    /**< Speeds in m/s, kept for conversion back to Vehicle. */
+    Column<double> directions; /**< Directions in degrees, kept for conversion back to Vehicle. */
+    double maxLen = 0.0;           /**< Largest vehicle length in the store. */
+    double maxSpd = 0.0;           /**< Upper bound on the speed of any vehicle in the store. */
+
+public:
+    /**
+     * @brief Reserves capacity for at least n vehicles in every column.
+     *
+     * @param n The number of vehicles to reserve space for.
+     */
+    void reserve(std::size_t n);
+
+    /**
+     * @brief Appends a vehicle, caching its velocity components.
+     *
+     * @param v The vehicle to add.
+     */
+    void add(const Vehicle& v);
+
+    /**
+     * @brief Appends n vehicles given as columns, growing every column once.
+     *
+     * @param n Number of vehicles to append.
+     * @param idCol Vehicle identifiers.
+     * @param xCol X-coordinates.
+     * @param yCol Y-coordinates.
+     * @param speedCol Speeds in m/s.
+     * @param directionCol Directions in degrees.
+     * @param lengthCol Lengths in meters.
+     * @param vxCol Precomputed X velocity components, or null to derive them.
+     * @param vyCol Precomputed Y velocity components, or null to derive them.
+     */
+    void append(std::size_t n, const std::int32_t* idCol, const double* xCol, const double* yCol,
+                const double* speedCol, const double* directionCol, const double* lengthCol,
+                const double* vxCol = nullptr, const double* vyCol = nullptr);
+
+    /**
+     * @brief Removes all vehicles.
+     */
+    void clear();
+
+    /**
+     * @brief Removes the vehicle at index i by moving the last vehicle into its place.
+     *
+     * O(1) and keeps the columns dense; only the last vehicle changes index.
+     * The length and speed bounds are kept, since they stay valid upper bounds.
+     *
+     * @param i Index of the vehicle to remove.
+     */
+    void swapRemove(std::size_t i);
+
+    /**
+     * @brief Returns the number of stored vehicles.
+     */
+    std::size_t size() const { return ids.get().size(); }
+
+    /**
+     * @brief Returns true if no vehicles are stored.
+     */
+    bool empty() const { return ids.get().empty(); }
+
+    /**
+     * @brief Converts the vehicle at index i back into a Vehicle.
+     *
+     * @param i Index of the vehicle in the store.
+     * @return Vehicle A copy of the vehicle's current state.
+     */
+    Vehicle get(std::size_t i) const;
+
+    /**
+     * @brief Converts all stored vehicles into an array of Vehicle structs.
+     *
+     * @param out The vector to fill; its previous contents are replaced.
+     */
+    void toVehicles(std::vector<Vehicle>& out) const;
+
+    /**
+     * @brief Converts all stored vehicles into an array of Vehicle structs.
+     *
+     * @return std::vector<Vehicle> The vehicles in store order.
+     */
+    std::vector<Vehicle> toVehicles() const;
+
+    /**
+     * @brief Changes the speed and direction of a vehicle and refreshes its cached velocity.
+     *
+     * @param i Index of the vehicle in the store.
+     * @param speed The new speed in m/s.
+     * @param direction The new direction in degrees.
+     */
+    void setVelocity(std::size_t i, double speed, double direction);
+
+    /**
+     * @brief Changes the speed of a vehicle, keeping its direction.
+     *
+     * Rescales the cached velocity instead of recomputing it, so no
+     * trigonometry runs unless the vehicle was standing still.
+     *
+     * @param i Index of the vehicle in the store.
+     * @param speed The new speed in m/s.
+     */
+    void setSpeed(std::size_t i, double speed);
+
+    /**
+     * @brief Moves a vehicle to a new position and heading, keeping its speed.
+     *
+     * The heading is given both in degrees and as a unit vector, so the
+     * cached velocity is refreshed without trigonometry.
+     *
+     * @param i Index of the vehicle in the store.
+     * @param x The new X-coordinate.
+     * @param y The new Y-coordinate.
+     * @param direction The new direction in degrees.
+     * @param ux X component of the unit vector along direction.
+     * @param uy Y component of the unit vector along direction.
+     */
+    void setPose(std::size_t i, double x, double y, double direction, double ux, double uy);
+
+    /**
+     * @brief Moves a vehicle to a new position, keeping its velocity.
+     *
+     * @param i Index of the vehicle in the store.
+     * @param x The new X-coordinate.
+     * @param y The new Y-coordinate.
+     */
+    void setPosition(std::size_t i, double x, double y);
+
+    /**
+     * @brief Advances every vehicle along its cached velocity by dt seconds.
+     *
+     * Uses AVX when the translation unit is compiled with AVX enabled, SSE2 on
+     * x86-64, and a scalar loop otherwise. All paths compute x += vx * dt with
+     * the same rounding, so results do not depend on the instruction set.
+     *
+     * @param dt The time step in seconds.
+     */
+    void integrate(double dt);
+
+    /**
+     * @brief Advances the vehicles with indices in [begin, end) by dt seconds.
+     *
+     * Produces exactly the same values as integrate(dt) for those vehicles, so
+     * the store can be integrated in independent chunks on several threads;
+     * call unsharePositions() before starting the threads.
+     *
+     * @param dt The time step in seconds.
+     * @param begin Index of the first vehicle to advance.
+     * @param end One past the index of the last vehicle to advance.
+     */
+    void integrate(double dt, std::size_t begin, std::size_t end);
+
+    /**
+     * @brief Gives the store its own copy of the position columns if a copy of the store shares them.
+     */
+    void unsharePositions();
+
+    /**
+     * @brief Returns how many of the eight columns still share storage with another store.
+     *
+     * @param other A copy of this store, or a store it was copied from.
+     */
+    int sharedColumns(const VehicleStore& other) const;
+
+    /**
+     * @brief Returns the largest vehicle length in the store, or 0 if empty.
+     */
+    double maxLength() const { return maxLen; }
+
+    /**
+     * @brief Returns an upper bound on the speed of any stored vehicle, or 0 if empty.
+     *
+     * The bound only grows until clear(), so it stays valid after setVelocity()
+     * slows a vehicle down.
+     */
+    double maxSpeed() const { return maxSpd; }
+
+    const std::vector<int>& id() const { return ids.get(); }             /**< @brief Identifier column. */
+    const std::vector<double>& x() const { return xs.get(); }            /**< @brief X-coordinate column. */
+    const std::vector<double>& y() const { return ys.get(); }            /**< @brief Y-coordinate column. */
+    const std::vector<double>& vx() const { return vxs.get(); }          /**< @brief Cached X velocity column. */
+    const std::vector<double>& vy() const { return vys.get(); }          /**< @brief Cached Y velocity column. */
+    const std::vector<double>& length() const { return lengths.get(); }  /**< @brief Length column. */
+    const std::vector<double>& speed() const { return speeds.get(); }    /**< @brief Speed column. */
+    const std::vector<double>& direction() const { return directions.get(); } /**< @brief Direction column. */
+};
+
+#endif // VEHICLESTORE_H
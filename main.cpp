@@ -1,7 +1,10 @@
 
 #include <iostream>
 #include <limits>
+#include <string>
 #include "Simulation.h"
+#include "ScenarioFile.h"
+#include "CsvImporter.h"
 
 /**
  * @brief The main entry point of the Vehicle Simulation program.
@@ -13,6 +16,7 @@
  * - Start the simulation
  * - View history of past simulation runs
  * - Replay a specific simulation run
+ * - Load or save a binary scenario file, or import vehicles from CSV
  *
  * The program runs in a loop until the user chooses to exit.
  *
@@ -32,6 +36,10 @@ int main() {
         std::cout << "3. Start Simulation\n";
         std::cout << "4. View History\n";
         std::cout << "5. Replay Run\n";
+        std::cout << "6. Load Scenario File\n";
+        std::cout << "7. Save Scenario File\n";
+        std::cout << "8. Import Vehicles from CSV\n";
+        std::cout << "9. Export Runs (Arrow)\n";
         std::cout << "0. Exit\n";
         std::cout << "Choice: ";
         std::cin >> choice;
@@ -68,6 +76,48 @@ int main() {
             std::cout << "Run ID: "; std::cin >> id;
             sim.replayRun(id);
         }
+        else if (choice == 6) {
+            // Replace the simulation with a scenario file's settings and vehicles
+            std::string path, error;
+            std::cout << "Scenario file: "; std::cin >> path;
+            ScenarioFile file;
+            if (file.open(path, error)) {
+                s = file.getSettings();
+                sim = Simulation(s);
+                file.loadInto(sim);
+                std::cout << "Loaded " << file.vehicleCount() << " vehicles.\n";
+            } else {
+                std::cout << "Load failed: " << error << "\n";
+            }
+        }
+        else if (choice == 7) {
+            // Save the current settings and vehicles
+            std::string path, error;
+            std::cout << "Scenario file: "; std::cin >> path;
+            if (ScenarioFile::save(path, s, sim.getVehicleStore(), error))
+                std::cout << "Scenario saved.\n";
+            else
+                std::cout << "Save failed: " << error << "\n";
+        }
+        else if (choice == 8) {
+            // Append vehicles from a CSV file
+            std::string path, error;
+            size_t imported = 0;
+            std::cout << "CSV file: "; std::cin >> path;
+            if (CsvImporter::importVehicles(path, sim, error, &imported))
+                std::cout << "Imported " << imported << " vehicles.\n";
+            else
+                std::cout << "Import stopped after " << imported << " vehicles: " << error << "\n";
+        }
+        else if (choice == 9) {
+            // Write every past run as a columnar Arrow file
+            std::string path, error;
+            std::cout << "Arrow file: "; std::cin >> path;
+            if (sim.exportRuns(path, error))
+                std::cout << "Runs exported.\n";
+            else
+                std::cout << "Export failed: " << error << "\n";
+        }
     } while (choice != 0);
 
     std::cout << "Exiting program...\n";